@@ -0,0 +1,163 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_frames) : capacity_(num_frames), frames_(num_frames) {}
+
+auto ARCReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // REPLACE(p): evict from T1 if it is over its target, from T2 otherwise.
+  const bool from_t1 = !t1_evictable_.empty() && (t1_size_ > target_t1_size_ || t2_evictable_.empty());
+  auto &evictable = from_t1 ? t1_evictable_ : t2_evictable_;
+  if (evictable.empty()) {
+    return false;
+  }
+  *frame_id = evictable.begin()->second;
+  evictable.erase(evictable.begin());
+
+  auto &frame = frames_[*frame_id];
+  if (from_t1) {
+    t1_size_--;
+  } else {
+    t2_size_--;
+  }
+  if (frame.page_id_ != INVALID_PAGE_ID) {
+    (from_t1 ? b1_ : b2_).PushFront(frame.page_id_);
+  }
+  frame = FrameInfo{};
+  TrimGhosts();
+  return true;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size(), "invalid frame id");
+  auto &frame = frames_[frame_id];
+  if (frame.list_ == List::NONE) {
+    LoadLocked(frame_id, INVALID_PAGE_ID);
+    return;
+  }
+  // Case I: a hit moves the page to the MRU end of T2.
+  if (frame.evictable_) {
+    EvictableFrames(frame.list_).erase({frame.last_access_, frame_id});
+  }
+  if (frame.list_ == List::T1) {
+    t1_size_--;
+    t2_size_++;
+    frame.list_ = List::T2;
+  }
+  frame.last_access_ = ++current_timestamp_;
+  if (frame.evictable_) {
+    t2_evictable_.emplace(frame.last_access_, frame_id);
+  }
+}
+
+void ARCReplacer::RecordLoad(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size(), "invalid frame id");
+  BUSTUB_ASSERT(frames_[frame_id].list_ == List::NONE, "a page can only be loaded into a frame that is not in use");
+  LoadLocked(frame_id, page_id);
+}
+
+void ARCReplacer::LoadLocked(frame_id_t frame_id, page_id_t page_id) {
+  auto &frame = frames_[frame_id];
+  if (page_id != INVALID_PAGE_ID && b1_.Contains(page_id)) {
+    // Case II: a miss in B1 means T1 should have been larger.
+    const size_t delta = std::max<size_t>(1, b2_.Size() / b1_.Size());
+    target_t1_size_ = std::min(capacity_, target_t1_size_ + delta);
+    b1_.Erase(page_id);
+    frame.list_ = List::T2;
+  } else if (page_id != INVALID_PAGE_ID && b2_.Contains(page_id)) {
+    // Case III: a miss in B2 means T2 should have been larger.
+    const size_t delta = std::max<size_t>(1, b1_.Size() / b2_.Size());
+    target_t1_size_ -= std::min(target_t1_size_, delta);
+    b2_.Erase(page_id);
+    frame.list_ = List::T2;
+  } else {
+    // Case IV: a page not seen recently enters T1.
+    frame.list_ = List::T1;
+  }
+  if (frame.list_ == List::T1) {
+    t1_size_++;
+  } else {
+    t2_size_++;
+  }
+  frame.last_access_ = ++current_timestamp_;
+  frame.evictable_ = false;
+  frame.page_id_ = page_id;
+  TrimGhosts();
+}
+
+void ARCReplacer::TrimGhosts() {
+  while (t1_size_ + b1_.Size() > capacity_ && b1_.Size() > 0) {
+    b1_.PopBack();
+  }
+  while (t1_size_ + t2_size_ + b1_.Size() + b2_.Size() > 2 * capacity_ && b2_.Size() > 0) {
+    b2_.PopBack();
+  }
+}
+
+void ARCReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size(), "invalid frame id");
+  auto &frame = frames_[frame_id];
+  if (frame.list_ == List::NONE || frame.evictable_ == set_evictable) {
+    return;
+  }
+  frame.evictable_ = set_evictable;
+  if (set_evictable) {
+    EvictableFrames(frame.list_).emplace(frame.last_access_, frame_id);
+  } else {
+    EvictableFrames(frame.list_).erase({frame.last_access_, frame_id});
+  }
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.list_ == List::NONE) {
+    return;
+  }
+  BUSTUB_ASSERT(frame.evictable_, "cannot remove a non-evictable frame");
+  EvictableFrames(frame.list_).erase({frame.last_access_, frame_id});
+  if (frame.list_ == List::T1) {
+    t1_size_--;
+  } else {
+    t2_size_--;
+  }
+  frame = FrameInfo{};
+}
+
+void ARCReplacer::Resize(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = num_frames; i < frames_.size(); i++) {
+    BUSTUB_ASSERT(frames_[i].list_ == List::NONE, "cannot shrink the replacer past a frame it tracks");
+  }
+  frames_.resize(num_frames);
+  capacity_ = num_frames;
+  target_t1_size_ = std::min(target_t1_size_, capacity_);
+  TrimGhosts();
+}
+
+auto ARCReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return t1_evictable_.size() + t2_evictable_.size();
+}
+
+}  // namespace bustub
@@ -0,0 +1,38 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.cpp
+//
+// Identification: src/buffer/buffer_access_strategy.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_access_strategy.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+auto BufferAccessStrategy::Advance(const BufferPoolManager *bpm, size_t pool_size) -> frame_id_t {
+  auto &ring = rings_[bpm];
+  if (ring.frames_.empty()) {
+    // Like PostgreSQL, never let a ring take more than an eighth of the pool.
+    ring.frames_.assign(std::max<size_t>(1, std::min(ring_size_, pool_size / 8)), EMPTY_SLOT);
+    ring.current_ = ring.frames_.size() - 1;
+  }
+  ring.current_ = (ring.current_ + 1) % ring.frames_.size();
+  return ring.frames_[ring.current_];
+}
+
+void BufferAccessStrategy::SetCurrent(const BufferPoolManager *bpm, frame_id_t frame_id) {
+  auto it = rings_.find(bpm);
+  BUSTUB_ASSERT(it != rings_.end(), "Advance() must be called on a ring before SetCurrent()");
+  it->second.frames_[it->second.current_] = frame_id;
+}
+
+}  // namespace bustub
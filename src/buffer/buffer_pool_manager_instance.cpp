@@ -12,84 +12,189 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
 #include "common/exception.h"
+#include "common/logger.h"
 #include "common/macros.h"
+#include "storage/page/header_page.h"
 
 namespace bustub {
 
+namespace {
+auto ElapsedNanoseconds(std::chrono::steady_clock::time_point start) -> uint64_t {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+}  // namespace
+
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, replacer_type) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(static_cast<page_id_t>(instance_index)),
+      page_size_(disk_manager->GetPageSize()),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 0.");
   // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
+  chunks_.emplace_back(0, std::make_unique<FrameChunk>(pool_size_, buffer_pool_huge_pages, page_size_));
+  for (size_t i = 0; i < pool_size_; ++i) {
+    frames_.push_back(&chunks_.front().second->GetPages()[i]);
+  }
   page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
-  replacer_ = new LRUKReplacer(pool_size, replacer_k);
+  replacer_ = MakeReplacer(replacer_type, pool_size, replacer_k).release();
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
   }
+
+  LoadFreePageBitmap();
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  StopPageCleaner();
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    prefetcher_running_ = false;
+  }
+  prefetch_cv_.notify_one();
+  if (prefetcher_.joinable()) {
+    prefetcher_.join();
+  }
   delete page_table_;
   delete replacer_;
 }
 
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
-  std::scoped_lock<std::mutex> lock(latch_);
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * { return NewPageWithStrategy(page_id, nullptr); }
+
+auto BufferPoolManagerInstance::NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) -> Page * {
+  return NewPageInTablespace(page_id, DEFAULT_TABLESPACE, strategy);
+}
+
+auto BufferPoolManagerInstance::NewPageInTablespace(page_id_t *page_id, tablespace_id_t tablespace_id,
+                                                    BufferAccessStrategy *strategy) -> Page * {
+  auto lock = AcquireLatch();
   frame_id_t frame_id;
-  if (!GetFrame(&frame_id)) {
+  page_id_t writeback_page_id;
+  if (!GetFrame(&frame_id, &writeback_page_id, strategy)) {
     return nullptr;
   }
 
-  *page_id = AllocatePage();
+  *page_id = tablespace_id == DEFAULT_TABLESPACE ? AllocatePage() : AllocateTablespacePage(tablespace_id);
+  try {
+    return InstallNewPage(*page_id, frame_id, writeback_page_id, lock);
+  } catch (const Exception &) {
+    // The write-back of the evicted page failed, and the new page was never created.
+    if (tablespace_id == DEFAULT_TABLESPACE) {
+      DeallocatePage(*page_id);
+    }
+    throw;
+  }
+}
+
+auto BufferPoolManagerInstance::NewPageAt(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  ValidatePageId(page_id);
+  auto lock = AcquireLatch();
+  frame_id_t frame_id;
+  WaitForWriteBack(page_id, lock);
+  // Read-ahead may have loaded the reserved page, which is all zeros on disk, before it was created.
+  if (page_table_->Find(page_id, frame_id)) {
+    PinFrame(frame_id);
+    if (WaitForFrame(frame_id, page_id, lock)) {
+      auto *page = GetPage(frame_id);
+      page->ResetMemory();
+      BufferPoolCounters::Add(counters_.Local().new_pages_);
+      return page;
+    }
+    UnpinFrame(frame_id);
+  }
+  page_id_t writeback_page_id;
+  if (!GetFrame(&frame_id, &writeback_page_id, strategy)) {
+    return nullptr;
+  }
+  return InstallNewPage(page_id, frame_id, writeback_page_id, lock);
+}
+
+auto BufferPoolManagerInstance::InstallNewPage(page_id_t page_id, frame_id_t frame_id, page_id_t writeback_page_id,
+                                               std::unique_lock<std::mutex> &lock) -> Page * {
   auto *page = GetPage(frame_id);
+  BufferPoolCounters::Add(counters_.Local().new_pages_);
 
   // recor the info
   replacer_->SetEvictable(frame_id, false);
-  pages_set_.insert(*page_id);
-  page_table_->Insert(*page_id, frame_id);
-  page->page_id_ = *page_id;
+  pages_set_.insert(page_id);
+  page_table_->Insert(page_id, frame_id);
+  page->page_id_ = page_id;
   page->pin_count_++;
-  page->ResetMemory();
   page->is_dirty_ = false;
-  replacer_->RecordAccess(frame_id);
+  replacer_->RecordLoad(frame_id, page_id);
 
+  FillFrame(frame_id, writeback_page_id, false, lock);
   return page;
 }
 
 auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
-  std::scoped_lock<std::mutex> lock(latch_);
+  return FetchPageWithStrategy(page_id, nullptr);
+}
+
+auto BufferPoolManagerInstance::FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  auto lock = AcquireLatch();
   frame_id_t frame_id;
-  if (!page_table_->Find(page_id, frame_id)) {
-    if (!GetFrame(&frame_id)) {
-      return nullptr;
+  // The page may have just been evicted and still be on its way to disk; reading it now would return stale data.
+  WaitForWriteBack(page_id, lock);
+  while (page_table_->Find(page_id, frame_id)) {
+    PinFrame(frame_id);
+    if (WaitForFrame(frame_id, page_id, lock)) {
+      BufferPoolCounters::Add(counters_.Local().fetch_hits_);
+      return GetPage(frame_id);
     }
+    // The read of the page was given up; try again.
+    UnpinFrame(frame_id);
+    WaitForWriteBack(page_id, lock);
+  }
+  BufferPoolCounters::Add(counters_.Local().fetch_misses_);
 
-    auto *page = GetPage(frame_id);
-
-    // recor the info
-    pages_set_.insert(page_id);
-    page_table_->Insert(page_id, frame_id);
-    page->page_id_ = page_id;
-    page->pin_count_++;
-    page->is_dirty_ = false;
-    page->ResetMemory();
-    replacer_->SetEvictable(frame_id, false);
-    replacer_->RecordAccess(frame_id);
-    disk_manager_->ReadPage(page_id, page->data_);
-    return page;
+  page_id_t writeback_page_id;
+  if (!GetFrame(&frame_id, &writeback_page_id, strategy)) {
+    return nullptr;
   }
+  auto *page = GetPage(frame_id);
+
+  // Register the page before dropping the latch, so that concurrent fetchers of the same page wait on this frame
+  // instead of reading it a second time.
+  pages_set_.insert(page_id);
+  page_table_->Insert(page_id, frame_id);
+  page->page_id_ = page_id;
+  page->pin_count_++;
+  page->is_dirty_ = false;
   replacer_->SetEvictable(frame_id, false);
-  GetPage(frame_id)->pin_count_++;
-  replacer_->RecordAccess(frame_id);
-  return GetPage(frame_id);
+  replacer_->RecordLoad(frame_id, page_id);
+
+  FillFrame(frame_id, writeback_page_id, true, lock);
+  return page;
 }
 
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
+  auto lock = AcquireLatch();
   frame_id_t frame_id;
   if (!page_table_->Find(page_id, frame_id)) {
     return false;
@@ -98,49 +203,223 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
   if (page->GetPinCount() == 0) {
     return false;
   }
-  // need lock
-  page->pin_count_--;
   if (is_dirty) {
     page->is_dirty_ = is_dirty;
   }
-  if (page->GetPinCount() == 0) {
-    replacer_->SetEvictable(frame_id, true);
-  }
+  UnpinFrame(frame_id);
   return true;
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
-  frame_id_t frame_id;
-  if (!page_table_->Find(page_id, frame_id)) {
+  auto lock = AcquireLatch();
+  if (!WriteBackPage(page_id, lock)) {
     return false;
   }
-  auto *page = GetPage(frame_id);
-  disk_manager_->WritePage(page_id, page->data_);
-  page->is_dirty_ = false;
+  lock.unlock();
+  disk_manager_->SyncRange(page_id, 1);
   return true;
 }
 
-void BufferPoolManagerInstance::FlushAllPgsImp() {
-  std::scoped_lock<std::mutex> lock(latch_);
+auto BufferPoolManagerInstance::FlushAllPgsImp() -> FlushStats {
+  std::vector<char> copies;
+  auto pages = PinPagesToFlush(&copies);
+  uint64_t write_ns = 0;
+  FlushStats stats;
+  try {
+    stats = WriteSortedPages(disk_manager_, &pages, &write_ns);
+  } catch (const Exception &) {
+    AbortFlush(pages);
+    throw;
+  }
+  FinishFlush(pages, write_ns);
+  // One durability barrier for the whole batch.
+  disk_manager_->Sync();
+  return stats;
+}
+
+auto BufferPoolManagerInstance::GetDirtyPages() -> std::vector<page_id_t> {
+  auto lock = AcquireLatch();
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < pool_size_; i++) {
+    auto *page = GetPage(static_cast<frame_id_t>(i));
+    if (page->GetPageId() != INVALID_PAGE_ID && (page->IsDirty() || page->GetPinCount() > 0)) {
+      page_ids.push_back(page->GetPageId());
+    }
+  }
+  // An evicted page whose write-back is still in flight has left the frames, but is not on disk yet either.
+  for (const auto &[page_id, frame_id] : writeback_frames_) {
+    page_ids.push_back(page_id);
+  }
+  return page_ids;
+}
+
+auto BufferPoolManagerInstance::FlushPages(const std::vector<page_id_t> &page_ids) -> FlushStats {
+  std::vector<Page *> pinned;
+  {
+    auto lock = AcquireLatch();
+    std::vector<std::pair<page_id_t, frame_id_t>> frames;
+    for (auto page_id : page_ids) {
+      // The write of an evicted page has to land before the Sync() below to be covered by it.
+      WaitForWriteBack(page_id, lock);
+      frame_id_t frame_id;
+      if (page_table_->Find(page_id, frame_id) &&
+          (GetPage(frame_id)->IsDirty() || GetPage(frame_id)->GetPinCount() > 0)) {
+        replacer_->SetEvictable(frame_id, false);
+        GetPage(frame_id)->pin_count_++;
+        frames.emplace_back(page_id, frame_id);
+      }
+    }
+    for (auto [page_id, frame_id] : frames) {
+      if (!WaitForFrame(frame_id, page_id, lock)) {
+        UnpinFrame(frame_id);
+        continue;
+      }
+      GetPage(frame_id)->is_dirty_ = false;
+      pinned.push_back(GetPage(frame_id));
+    }
+  }
+  std::vector<char> copies;
+  auto pages = CopyPinnedPages(pinned, &copies);
+  SyncFreePageBitmap();
+  FlushLogForPages(pages);
+  uint64_t write_ns = 0;
+  FlushStats stats;
+  try {
+    stats = WriteSortedPages(disk_manager_, &pages, &write_ns);
+  } catch (const Exception &) {
+    AbortFlush(pages);
+    throw;
+  }
+  // The pages stay pinned until their copies are written, so that no one reads an older version from disk.
+  FinishFlush(pages, write_ns);
+  disk_manager_->Sync();
+  return stats;
+}
+
+auto BufferPoolManagerInstance::PinPagesToFlush(std::vector<char> *copies)
+    -> std::vector<std::pair<page_id_t, const char *>> {
+  auto lock = AcquireLatch();
+  // Pin the pages, as in WriteBackPage(), so that all of them can be written as one batch with the latch released.
+  // Besides the dirty pages, that includes every pinned page: a clean one may be in the middle of a write by the page
+  // cleaner, which the caller's Sync() has to cover, so it is written again.
+  std::vector<std::pair<page_id_t, frame_id_t>> frames;
   for (auto page_id : pages_set_) {
     frame_id_t frame_id;
-    if (!page_table_->Find(page_id, frame_id)) {
+    if (page_table_->Find(page_id, frame_id) &&
+        (GetPage(frame_id)->IsDirty() || GetPage(frame_id)->GetPinCount() > 0)) {
+      replacer_->SetEvictable(frame_id, false);
+      GetPage(frame_id)->pin_count_++;
+      frames.emplace_back(page_id, frame_id);
+    }
+  }
+  std::vector<Page *> pinned;
+  for (auto [page_id, frame_id] : frames) {
+    if (!WaitForFrame(frame_id, page_id, lock)) {
+      UnpinFrame(frame_id);
       continue;
     }
-    auto *page = GetPage(frame_id);
-    disk_manager_->WritePage(page_id, page->data_);
-    page->is_dirty_ = false;
+    // A change made after this point marks the page dirty again when it is unpinned, whether or not the copy has it.
+    GetPage(frame_id)->is_dirty_ = false;
+    pinned.push_back(GetPage(frame_id));
+  }
+  lock.unlock();
+  auto pages = CopyPinnedPages(pinned, copies);
+  SyncFreePageBitmap();
+  FlushLogForPages(pages);
+  return pages;
+}
+
+auto BufferPoolManagerInstance::CopyPinnedPages(const std::vector<Page *> &pinned, std::vector<char> *copies)
+    -> std::vector<std::pair<page_id_t, const char *>> {
+  // One latch at a time: a writer may hold the write latch of one page while it waits for the latch of another.
+  copies->resize(pinned.size() * page_size_);
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (size_t i = 0; i < pinned.size(); i++) {
+    char *copy = copies->data() + i * page_size_;
+    pinned[i]->RLatch();
+    memcpy(copy, pinned[i]->GetData(), page_size_);
+    pinned[i]->RUnlatch();
+    pages.emplace_back(pinned[i]->GetPageId(), copy);
+  }
+  return pages;
+}
+
+void BufferPoolManagerInstance::FinishFlush(const std::vector<std::pair<page_id_t, const char *>> &pages,
+                                            uint64_t write_ns) {
+  auto lock = AcquireLatch();
+  for (const auto &[page_id, data] : pages) {
+    // Pinned pages cannot be evicted or deleted, so the page is still in the frame it was pinned in.
+    frame_id_t frame_id;
+    const bool resident = page_table_->Find(page_id, frame_id);
+    BUSTUB_ASSERT(resident, "a pinned page left the buffer pool");
+    UnpinFrame(frame_id);
+  }
+  lock.unlock();
+  auto &counters = counters_.Local();
+  BufferPoolCounters::Add(counters.flushes_, pages.size());
+  BufferPoolCounters::Add(counters.disk_writes_, pages.size());
+  BufferPoolCounters::Add(counters.disk_write_ns_, write_ns);
+
+  // Persist the exact high-water mark, so that a restart after a flush does not skip any page ids.
+  {
+    std::scoped_lock<std::mutex> allocator_lock(allocator_latch_);
+    auto &first_bitmap_page = *free_page_bitmap_.front();
+    const uint32_t high_water_mark = PageIdToSlot(next_page_id_);
+    if (first_bitmap_page.GetHighWaterMark() != high_water_mark) {
+      first_bitmap_page.SetHighWaterMark(high_water_mark);
+      free_page_bitmap_dirty_.front() = true;
+    }
+  }
+  WriteFreePageBitmap();
+}
+
+void BufferPoolManagerInstance::AbortFlush(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  auto lock = AcquireLatch();
+  for (const auto &[page_id, data] : pages) {
+    frame_id_t frame_id;
+    const bool resident = page_table_->Find(page_id, frame_id);
+    BUSTUB_ASSERT(resident, "a pinned page left the buffer pool");
+    // The page may or may not have reached the disk; it has to be written again.
+    GetPage(frame_id)->is_dirty_ = true;
+    UnpinFrame(frame_id);
+  }
+}
+
+auto BufferPoolManagerInstance::WriteSortedPages(DiskManager *disk_manager,
+                                                 std::vector<std::pair<page_id_t, const char *>> *pages,
+                                                 uint64_t *write_ns) -> FlushStats {
+  *write_ns = 0;
+  FlushStats stats;
+  if (pages->empty()) {
+    return stats;
+  }
+  std::sort(pages->begin(), pages->end());
+  stats.pages_written_ = pages->size();
+  // A run of adjacent pages ends where the next page id is not the following one, or lies in another tablespace.
+  for (size_t i = 0; i < pages->size(); i++) {
+    const page_id_t page_id = (*pages)[i].first;
+    const page_id_t prev_page_id = i == 0 ? INVALID_PAGE_ID : (*pages)[i - 1].first;
+    if (i == 0 || page_id != prev_page_id + 1 || TablespaceOf(page_id) != TablespaceOf(prev_page_id)) {
+      stats.runs_++;
+    }
   }
+  const auto start = std::chrono::steady_clock::now();
+  disk_manager->WritePages(*pages);
+  *write_ns = ElapsedNanoseconds(start);
+  return stats;
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
+  auto lock = AcquireLatch();
   frame_id_t frame_id;
+  // Let an in-flight write-back of this page finish, so that it cannot land on disk after the page is deallocated.
+  WaitForWriteBack(page_id, lock);
   if (!page_table_->Find(page_id, frame_id)) {
+    DeallocatePage(page_id);
     return true;
   }
   auto *page = GetPage(frame_id);
+  // A frame with I/O in flight is always pinned by the thread doing the I/O.
   if (page->GetPinCount() > 0) {
     return false;
   }
@@ -158,29 +437,755 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   return true;
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
+  std::scoped_lock<std::mutex> allocator_lock(allocator_latch_);
+  // Reuse the lowest deallocated page id first, so that the database file stays compact.
+  for (size_t n = 0; n < free_page_bitmap_.size(); n++) {
+    auto &bitmap_page = *free_page_bitmap_[n];
+    const uint32_t slot = bitmap_page.FindFirstFree();
+    if (slot != FreePageBitmapPage::SLOTS_PER_PAGE) {
+      bitmap_page.SetFree(slot, false);
+      free_page_bitmap_dirty_[n] = true;
+      free_page_bitmap_changed_ = true;
+      return SlotToPageId(static_cast<uint32_t>(n) * FreePageBitmapPage::SLOTS_PER_PAGE + slot);
+    }
+  }
+
+  const page_id_t next_page_id = next_page_id_;
+  BUSTUB_ASSERT(next_page_id < BLOCKS_PER_TABLESPACE, "the default tablespace is full");
+  next_page_id_ += static_cast<page_id_t>(num_instances_);
+  ValidatePageId(next_page_id);
+  // The persisted high-water mark is moved ahead in batches, so that only one in PAGE_ALLOCATION_BATCH new pages
+  // costs a write. A crash skips the rest of the batch, but never hands out a page id twice.
+  auto &first_bitmap_page = *free_page_bitmap_.front();
+  if (PageIdToSlot(next_page_id) >= first_bitmap_page.GetHighWaterMark()) {
+    first_bitmap_page.SetHighWaterMark(PageIdToSlot(next_page_id) + PAGE_ALLOCATION_BATCH);
+    free_page_bitmap_dirty_.front() = true;
+    free_page_bitmap_changed_ = true;
+  }
+  return next_page_id;
+}
+
+auto BufferPoolManagerInstance::AllocateTablespacePage(tablespace_id_t tablespace_id) -> page_id_t {
+  std::scoped_lock<std::mutex> allocator_lock(allocator_latch_);
+  auto &next_block = NextTablespaceBlock(tablespace_id);
+  BUSTUB_ASSERT(next_block < BLOCKS_PER_TABLESPACE, "the tablespace is full");
+  const page_id_t page_id = MakePageId(tablespace_id, next_block);
+  next_block += static_cast<page_id_t>(num_instances_);
+  ValidatePageId(page_id);
+  return page_id;
+}
+
+auto BufferPoolManagerInstance::NextTablespaceBlock(tablespace_id_t tablespace_id) -> page_id_t & {
+  auto it = next_blocks_.find(tablespace_id);
+  if (it == next_blocks_.end()) {
+    it = next_blocks_.emplace(tablespace_id, RoundUpToInstance(disk_manager_->GetNumBlocks(tablespace_id))).first;
+  }
+  return it->second;
+}
+
+auto BufferPoolManagerInstance::AllocateExtent(tablespace_id_t tablespace_id, size_t num_pages) -> page_id_t {
+  if (num_instances_ != 1) {
+    return INVALID_PAGE_ID;
+  }
+  // A stand-alone instance owns every page id, so nothing can take the run between the two calls but another
+  // extent, and then the reservation is simply tried again further on.
+  page_id_t first_page_id;
+  do {
+    first_page_id = NextUnallocatedPageId(tablespace_id);
+    if (static_cast<size_t>(BlockOf(first_page_id)) + num_pages > BLOCKS_PER_TABLESPACE) {
+      return INVALID_PAGE_ID;
+    }
+  } while (!ReserveExtent(first_page_id, num_pages));
+  disk_manager_->PreallocatePages(first_page_id, num_pages);
+  return first_page_id;
+}
+
+auto BufferPoolManagerInstance::NextUnallocatedPageId(tablespace_id_t tablespace_id) -> page_id_t {
+  std::scoped_lock<std::mutex> allocator_lock(allocator_latch_);
+  if (tablespace_id == DEFAULT_TABLESPACE) {
+    return next_page_id_;
+  }
+  return MakePageId(tablespace_id, NextTablespaceBlock(tablespace_id));
+}
+
+auto BufferPoolManagerInstance::ReserveExtent(page_id_t first_page_id, size_t num_pages) -> bool {
+  const tablespace_id_t tablespace_id = TablespaceOf(first_page_id);
+  const page_id_t first_block = RoundUpToInstance(BlockOf(first_page_id));
+  const page_id_t end_block = RoundUpToInstance(BlockOf(first_page_id) + static_cast<page_id_t>(num_pages));
+  std::scoped_lock<std::mutex> allocator_lock(allocator_latch_);
+  if (tablespace_id != DEFAULT_TABLESPACE) {
+    auto &next_block = NextTablespaceBlock(tablespace_id);
+    if (next_block > first_block) {
+      return false;
+    }
+    next_block = end_block;
+    return true;
+  }
+  if (next_page_id_ > first_block) {
+    return false;
+  }
+  for (page_id_t page_id = next_page_id_; page_id < first_block; page_id += static_cast<page_id_t>(num_instances_)) {
+    MarkPageFree(page_id);
+  }
+  next_page_id_ = end_block;
+  // Like in AllocatePage(), the persisted high-water mark has to stay ahead of every id handed out.
+  auto &first_bitmap_page = *free_page_bitmap_.front();
+  if (PageIdToSlot(end_block) > first_bitmap_page.GetHighWaterMark()) {
+    first_bitmap_page.SetHighWaterMark(PageIdToSlot(end_block) + PAGE_ALLOCATION_BATCH);
+    free_page_bitmap_dirty_.front() = true;
+    free_page_bitmap_changed_ = true;
+  }
+  return true;
+}
+
+auto BufferPoolManagerInstance::IsAllocated(page_id_t page_id) -> bool {
+  if (page_id < 0 || BlockOf(page_id) % num_instances_ != instance_index_) {
+    return false;
+  }
+  const tablespace_id_t tablespace_id = TablespaceOf(page_id);
+  if (tablespace_id == DEFAULT_TABLESPACE) {
+    return page_id < next_page_id_;
+  }
+  std::scoped_lock<std::mutex> allocator_lock(allocator_latch_);
+  return BlockOf(page_id) < NextTablespaceBlock(tablespace_id);
+}
+
+void BufferPoolManagerInstance::DeallocatePage(page_id_t page_id) {
+  // Only the default tablespace reuses pages; the others give their space back when they are dropped.
+  if (TablespaceOf(page_id) != DEFAULT_TABLESPACE || !IsAllocated(page_id)) {
+    return;
+  }
+  std::scoped_lock<std::mutex> allocator_lock(allocator_latch_);
+  MarkPageFree(page_id);
+}
+
+void BufferPoolManagerInstance::MarkPageFree(page_id_t page_id) {
+  const uint32_t slot = PageIdToSlot(page_id);
+  const size_t n = slot / FreePageBitmapPage::SLOTS_PER_PAGE;
+  while (free_page_bitmap_.size() <= n) {
+    free_page_bitmap_.push_back(std::make_unique<FreePageBitmapPage>());
+    free_page_bitmap_.back()->Init();
+    free_page_bitmap_dirty_.push_back(true);
+  }
+  if (free_page_bitmap_[n]->SetFree(slot % FreePageBitmapPage::SLOTS_PER_PAGE, true)) {
+    free_page_bitmap_dirty_[n] = true;
+    free_page_bitmap_changed_ = true;
+  }
+}
+
+void BufferPoolManagerInstance::LoadFreePageBitmap() {
+  while (true) {
+    auto bitmap_page = std::make_unique<FreePageBitmapPage>();
+    const auto fsm_page_no = static_cast<uint32_t>(free_page_bitmap_.size()) * num_instances_ + instance_index_;
+    if (!disk_manager_->ReadFreeSpaceMapPage(fsm_page_no, reinterpret_cast<char *>(bitmap_page.get()))) {
+      break;
+    }
+    free_page_bitmap_.push_back(std::move(bitmap_page));
+    free_page_bitmap_dirty_.push_back(false);
+  }
+  if (free_page_bitmap_.empty()) {
+    free_page_bitmap_.push_back(std::make_unique<FreePageBitmapPage>());
+    free_page_bitmap_.back()->Init();
+    free_page_bitmap_dirty_.push_back(true);
+    // Without a free space map, e.g. a database of an older version, every page in the file counts as allocated.
+    const auto num_pages = static_cast<uint32_t>(disk_manager_->GetNumPages());
+    if (num_pages > instance_index_) {
+      free_page_bitmap_.back()->SetHighWaterMark((num_pages - instance_index_ + num_instances_ - 1) / num_instances_);
+    }
+  }
+  next_page_id_ = SlotToPageId(free_page_bitmap_.front()->GetHighWaterMark());
+}
+
+void BufferPoolManagerInstance::WriteFreePageBitmap() {
+  std::scoped_lock<std::mutex> io_lock(free_page_bitmap_io_latch_);
+  // Copy the changed pages, so that the allocator is not blocked while they are written.
+  std::vector<std::pair<uint32_t, FreePageBitmapPage>> dirty_pages;
+  {
+    std::scoped_lock<std::mutex> allocator_lock(allocator_latch_);
+    free_page_bitmap_changed_ = false;
+    for (size_t n = 0; n < free_page_bitmap_.size(); n++) {
+      if (free_page_bitmap_dirty_[n]) {
+        dirty_pages.emplace_back(static_cast<uint32_t>(n) * num_instances_ + instance_index_, *free_page_bitmap_[n]);
+        free_page_bitmap_dirty_[n] = false;
+      }
+    }
+  }
+  for (const auto &[fsm_page_no, bitmap_page] : dirty_pages) {
+    disk_manager_->WriteFreeSpaceMapPage(fsm_page_no, reinterpret_cast<const char *>(&bitmap_page));
+  }
+}
+
+void BufferPoolManagerInstance::SyncFreePageBitmap() {
+  if (free_page_bitmap_changed_) {
+    WriteFreePageBitmap();
+  }
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  // allocated pages mod back to this BPI
+  BUSTUB_ASSERT(BlockOf(page_id) % num_instances_ == instance_index_,
+                "page id does not belong to this buffer pool instance");
+}
+
+auto BufferPoolManagerInstance::GetFrame(frame_id_t *frame_id, page_id_t *writeback_page_id,
+                                         BufferAccessStrategy *strategy) -> bool {
+  *writeback_page_id = INVALID_PAGE_ID;
+  if (strategy != nullptr) {
+    // Recycle the frame in the next ring slot if it still holds a page nobody is using. A frame that went back to the
+    // free list or is pinned by someone else is left alone, and the slot gets a new frame from the pool below.
+    const frame_id_t ring_frame_id = strategy->Advance(this, pool_size_);
+    // The ring may still hold frames that a shrink of the pool has withdrawn since.
+    if (ring_frame_id != BufferAccessStrategy::EMPTY_SLOT && static_cast<size_t>(ring_frame_id) < pool_size_) {
+      auto *page = GetPage(ring_frame_id);
+      if (page->GetPageId() != INVALID_PAGE_ID && page->GetPinCount() == 0 &&
+          page->io_state_ == PageIOState::READY) {
+        replacer_->Remove(ring_frame_id);
+        EvictFrame(ring_frame_id, writeback_page_id);
+        *frame_id = ring_frame_id;
+        return true;
+      }
+    }
+  }
 
-auto BufferPoolManagerInstance::GetFrame(frame_id_t *frame_id) -> bool {
   if (!free_list_.empty()) {
     *frame_id = free_list_.back();
     free_list_.pop_back();
-    return true;
-  }
-  if (!replacer_->Evict(frame_id)) {
+  } else if (replacer_->Evict(frame_id)) {
+    EvictFrame(*frame_id, writeback_page_id);
+  } else {
     return false;
   }
-  auto *page = GetPage(*frame_id);
+  if (strategy != nullptr) {
+    strategy->SetCurrent(this, *frame_id);
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::EvictFrame(frame_id_t frame_id, page_id_t *writeback_page_id) {
+  auto *page = GetPage(frame_id);
+  BUSTUB_ASSERT(page->io_state_ == PageIOState::READY, "an evictable frame cannot have I/O in flight");
   if (page->IsDirty()) {
-    disk_manager_->WritePage(page->GetPageId(), page->data_);
+    BufferPoolCounters::Add(counters_.Local().dirty_evictions_);
+    // The cleaner has fallen behind; let it catch up before the next eviction.
+    page_cleaner_cv_.notify_one();
+    *writeback_page_id = page->GetPageId();
+    writeback_frames_.emplace(page->GetPageId(), frame_id);
+    page->io_state_ = PageIOState::WRITING;
     page->is_dirty_ = false;
+  } else {
+    BufferPoolCounters::Add(counters_.Local().clean_evictions_);
   }
-  page->ResetMemory();
   page_table_->Remove(page->GetPageId());
   pages_set_.erase(page->GetPageId());
   page->pin_count_ = 0;
   page->page_id_ = INVALID_PAGE_ID;
+}
+
+void BufferPoolManagerInstance::FillFrame(frame_id_t frame_id, page_id_t writeback_page_id, bool read_from_disk,
+                                          std::unique_lock<std::mutex> &lock) {
+  FillFrames({{frame_id, writeback_page_id}}, read_from_disk, lock);
+}
+
+void BufferPoolManagerInstance::FillFrames(const std::vector<std::pair<frame_id_t, page_id_t>> &frames,
+                                           bool read_from_disk, std::unique_lock<std::mutex> &lock) {
+  // Only the thread filling the frames touches their data until they are READY: the frames are pinned, and every
+  // other user of the new pages waits in WaitForFrame().
+  std::vector<std::pair<page_id_t, const char *>> writebacks;
+  for (auto [frame_id, writeback_page_id] : frames) {
+    if (writeback_page_id != INVALID_PAGE_ID) {
+      writebacks.emplace_back(writeback_page_id, GetPage(frame_id)->data_);
+    } else {
+      // nobody may use the new page while the latch is released for the write-backs of the other frames
+      GetPage(frame_id)->io_state_ = PageIOState::READING;
+    }
+  }
+  std::exception_ptr write_error;
+  if (!writebacks.empty()) {
+    lock.unlock();
+    try {
+      WritePagesToDisk(writebacks);
+    } catch (const Exception &) {
+      write_error = std::current_exception();
+    }
+    lock.lock();
+    for (auto [frame_id, writeback_page_id] : frames) {
+      if (writeback_page_id != INVALID_PAGE_ID) {
+        writeback_frames_.erase(writeback_page_id);
+        if (write_error != nullptr) {
+          RestoreEvictedPage(frame_id, writeback_page_id);
+        } else {
+          GetPage(frame_id)->io_state_ = PageIOState::READING;
+        }
+        // Wake up fetchers of the evicted page; they can read it from disk now, or find it back in the frame.
+        GetPage(frame_id)->io_cv_.notify_all();
+      }
+    }
+  }
+
+  lock.unlock();
+  std::vector<std::pair<page_id_t, char *>> reads;
+  for (auto [frame_id, writeback_page_id] : frames) {
+    if (write_error != nullptr && writeback_page_id != INVALID_PAGE_ID) {
+      continue;
+    }
+    auto *page = GetPage(frame_id);
+    page->ResetMemory();
+    if (!read_from_disk && page->GetPageId() == HEADER_PAGE_ID) {
+      // A new header page records the page size of the database.
+      HeaderPage::InitData(page->data_, page_size_);
+    }
+    reads.emplace_back(page->GetPageId(), page->data_);
+  }
+  if (read_from_disk) {
+    ReadPagesFromDisk(reads);
+  }
+  lock.lock();
+
+  for (auto [frame_id, writeback_page_id] : frames) {
+    if (write_error != nullptr && writeback_page_id != INVALID_PAGE_ID) {
+      continue;
+    }
+    auto *page = GetPage(frame_id);
+    page->io_state_ = PageIOState::READY;
+    page->io_cv_.notify_all();
+  }
+  if (write_error != nullptr) {
+    std::rethrow_exception(write_error);
+  }
+}
+
+void BufferPoolManagerInstance::RestoreEvictedPage(frame_id_t frame_id, page_id_t page_id) {
+  auto *page = GetPage(frame_id);
+  // The new page never got its data. Whoever waits for it finds the frame holding another page and lets go of it.
+  page_table_->Remove(page->GetPageId());
+  pages_set_.erase(page->GetPageId());
+  // The evicted page is still in the frame, and still not on disk.
+  page_table_->Insert(page_id, frame_id);
+  pages_set_.insert(page_id);
+  page->page_id_ = page_id;
+  page->is_dirty_ = true;
+  page->io_state_ = PageIOState::READY;
+  UnpinFrame(frame_id);
+}
+
+auto BufferPoolManagerInstance::WaitForFrame(frame_id_t frame_id, page_id_t page_id, std::unique_lock<std::mutex> &lock)
+    -> bool {
+  auto *page = GetPage(frame_id);
+  page->io_cv_.wait(lock, [page] { return page->io_state_ == PageIOState::READY; });
+  return page->GetPageId() == page_id;
+}
+
+void BufferPoolManagerInstance::WaitForWriteBack(page_id_t page_id, std::unique_lock<std::mutex> &lock) {
+  auto it = writeback_frames_.find(page_id);
+  while (it != writeback_frames_.end()) {
+    GetPage(it->second)->io_cv_.wait(lock);
+    it = writeback_frames_.find(page_id);
+  }
+}
+
+void BufferPoolManagerInstance::PinFrame(frame_id_t frame_id) {
+  replacer_->SetEvictable(frame_id, false);
+  GetPage(frame_id)->pin_count_++;
+  replacer_->RecordAccess(frame_id);
+}
+
+void BufferPoolManagerInstance::UnpinFrame(frame_id_t frame_id) {
+  auto *page = GetPage(frame_id);
+  page->pin_count_--;
+  if (page->GetPinCount() == 0) {
+    replacer_->SetEvictable(frame_id, true);
+  }
+}
+
+auto BufferPoolManagerInstance::WriteBackPage(page_id_t page_id, std::unique_lock<std::mutex> &lock) -> bool {
+  frame_id_t frame_id;
+  if (!page_table_->Find(page_id, frame_id)) {
+    return false;
+  }
+  auto *page = GetPage(frame_id);
+  // Pin the frame so it cannot be evicted and reused while the latch is released. This is not an access by the
+  // workload, so the replacer history is left alone.
+  replacer_->SetEvictable(frame_id, false);
+  page->pin_count_++;
+  if (!WaitForFrame(frame_id, page_id, lock)) {
+    UnpinFrame(frame_id);
+    return false;
+  }
+
+  // Clear the dirty flag before writing, so that a modification made during the write marks the page dirty again.
+  page->is_dirty_ = false;
+  lock.unlock();
+  // Write a copy taken under the page latch, so that a writer holding the page cannot tear it.
+  std::vector<char> copy(page_size_);
+  page->RLatch();
+  memcpy(copy.data(), page->GetData(), page_size_);
+  page->RUnlatch();
+  try {
+    WritePageToDisk(page_id, copy.data());
+  } catch (const Exception &) {
+    lock.lock();
+    page->is_dirty_ = true;
+    UnpinFrame(frame_id);
+    throw;
+  }
+  lock.lock();
+  BufferPoolCounters::Add(counters_.Local().flushes_);
+
+  UnpinFrame(frame_id);
   return true;
 }
-auto BufferPoolManagerInstance::GetPage(frame_id_t frame_id) -> Page * { return &GetPages()[frame_id]; }
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    for (auto page_id : page_ids) {
+      if (prefetch_queue_.size() >= pool_size_) {
+        break;
+      }
+      if (page_id != INVALID_PAGE_ID) {
+        prefetch_queue_.push_back(page_id);
+      }
+    }
+    if (!prefetcher_running_ && !prefetcher_.joinable()) {
+      prefetcher_running_ = true;
+      prefetcher_ = std::thread(&BufferPoolManagerInstance::PrefetchLoop, this);
+    }
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::PrefetchLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return !prefetcher_running_ || !prefetch_queue_.empty(); });
+    if (!prefetcher_running_) {
+      return;
+    }
+    // Read a window of queued pages as one batch. The window is kept small next to the pool, as its frames stay pinned
+    // until the whole batch is in.
+    const size_t batch_size = std::max<size_t>(1, std::min<size_t>(READ_AHEAD_PAGES, pool_size_ / 8));
+    std::vector<std::pair<frame_id_t, page_id_t>> frames;
+    while (!prefetch_queue_.empty() && frames.size() < batch_size) {
+      const page_id_t page_id = prefetch_queue_.front();
+      prefetch_queue_.pop_front();
+      if (!PrefetchPage(page_id, &frames)) {
+        break;
+      }
+    }
+    if (!frames.empty()) {
+      bool written = true;
+      try {
+        FillFrames(frames, true, lock);
+      } catch (const Exception &e) {
+        // The evicted pages are back in their frames and still dirty; the prefetched pages are read on demand instead.
+        LOG_WARN("prefetcher: %s", e.what());
+        written = false;
+      }
+      for (auto [frame_id, writeback_page_id] : frames) {
+        // FillFrames() has let go of the frames it gave back to their evicted pages.
+        if (written || writeback_page_id == INVALID_PAGE_ID) {
+          UnpinFrame(frame_id);
+        }
+      }
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::PrefetchPage(page_id_t page_id, std::vector<std::pair<frame_id_t, page_id_t>> *frames)
+    -> bool {
+  if (!IsAllocated(page_id)) {
+    return true;
+  }
+  frame_id_t frame_id;
+  if (writeback_frames_.count(page_id) != 0 || page_table_->Find(page_id, frame_id)) {
+    return true;
+  }
+  page_id_t writeback_page_id;
+  if (!GetFrame(&frame_id, &writeback_page_id, nullptr)) {
+    return false;
+  }
+  auto *page = GetPage(frame_id);
+
+  // Install the page exactly like FetchPgImp(), holding the pin only for as long as the read is in flight.
+  pages_set_.insert(page_id);
+  page_table_->Insert(page_id, frame_id);
+  page->page_id_ = page_id;
+  page->pin_count_++;
+  page->is_dirty_ = false;
+  replacer_->SetEvictable(frame_id, false);
+  replacer_->RecordLoad(frame_id, page_id);
+  frames->emplace_back(frame_id, writeback_page_id);
+  return true;
+}
+
+void BufferPoolManagerInstance::StartPageCleaner(double clean_ratio) {
+  BUSTUB_ASSERT(clean_ratio >= 0 && clean_ratio <= 1, "clean ratio must be between 0 and 1");
+  std::unique_lock<std::mutex> lock(latch_);
+  clean_ratio_ = clean_ratio;
+  if (page_cleaner_running_) {
+    return;
+  }
+  page_cleaner_running_ = true;
+  page_cleaner_ = std::thread(&BufferPoolManagerInstance::PageCleanerLoop, this);
+}
+
+void BufferPoolManagerInstance::StopPageCleaner() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    page_cleaner_running_ = false;
+  }
+  page_cleaner_cv_.notify_one();
+  if (page_cleaner_.joinable()) {
+    page_cleaner_.join();
+  }
+}
+
+void BufferPoolManagerInstance::PageCleanerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (page_cleaner_running_) {
+    page_cleaner_cv_.wait_for(lock, page_cleaner_interval);
+    if (page_cleaner_running_) {
+      CleanPages(lock);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::CleanPages(std::unique_lock<std::mutex> &lock) {
+  // Frames that are resident, unpinned and have no I/O in flight are exactly the ones the replacer may evict.
+  size_t num_evictable = 0;
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty_pages;
+  for (size_t i = 0; i < pool_size_; i++) {
+    auto *page = GetPage(static_cast<frame_id_t>(i));
+    if (page->GetPageId() == INVALID_PAGE_ID || page->GetPinCount() > 0 || page->io_state_ != PageIOState::READY) {
+      continue;
+    }
+    num_evictable++;
+    if (page->IsDirty()) {
+      dirty_pages.emplace_back(page->GetPageId(), static_cast<frame_id_t>(i));
+    }
+  }
+  const auto num_clean_target = static_cast<size_t>(std::ceil(clean_ratio_ * static_cast<double>(num_evictable)));
+  const size_t num_clean = num_evictable - dirty_pages.size();
+  if (num_clean >= num_clean_target) {
+    return;
+  }
+
+  std::sort(dirty_pages.begin(), dirty_pages.end());
+  dirty_pages.resize(std::min(dirty_pages.size(), num_clean_target - num_clean));
+  std::vector<Page *> pages;
+  for (auto [page_id, frame_id] : dirty_pages) {
+    // Pin without recording an access, as in WriteBackPage(), and clear the dirty flag before the write so that a
+    // concurrent modification marks the page dirty again.
+    replacer_->SetEvictable(frame_id, false);
+    GetPage(frame_id)->pin_count_++;
+    GetPage(frame_id)->is_dirty_ = false;
+    pages.push_back(GetPage(frame_id));
+  }
+  lock.unlock();
+  // The pages were unpinned, but may be pinned and changed by now; copy them under their latches one at a time.
+  std::vector<char> copies(pages.size() * page_size_);
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  for (size_t i = 0; i < pages.size(); i++) {
+    char *copy = copies.data() + i * page_size_;
+    pages[i]->RLatch();
+    memcpy(copy, pages[i]->GetData(), page_size_);
+    pages[i]->RUnlatch();
+    writes.emplace_back(dirty_pages[i].first, copy);
+  }
+  bool written = true;
+  try {
+    WritePagesToDisk(writes);
+  } catch (const Exception &e) {
+    // There is no one to report to; the pages stay dirty, and whoever flushes or evicts them next gets the error.
+    LOG_WARN("page cleaner: %s", e.what());
+    written = false;
+  }
+  lock.lock();
+  if (written) {
+    BufferPoolCounters::Add(counters_.Local().flushes_, dirty_pages.size());
+  }
+  for (auto [page_id, frame_id] : dirty_pages) {
+    if (!written) {
+      GetPage(frame_id)->is_dirty_ = true;
+    }
+    UnpinFrame(frame_id);
+  }
+}
+
+auto BufferPoolManagerInstance::Resize(size_t pool_size) -> bool {
+  BUSTUB_ASSERT(pool_size > 0, "a buffer pool needs at least one frame");
+  std::scoped_lock<std::mutex> resize_lock(resize_latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+
+  while (pool_size_ < pool_size) {
+    // Spare frames left behind by an earlier shrink are reused before new memory is allocated.
+    if (pool_size_ == frames_.size()) {
+      const size_t chunk_size = std::min<size_t>(BUFFER_POOL_CHUNK_SIZE, pool_size - pool_size_);
+      lock.unlock();
+      auto chunk = std::make_unique<FrameChunk>(chunk_size, buffer_pool_huge_pages, page_size_);
+      lock.lock();
+      const auto first_frame_id = static_cast<frame_id_t>(frames_.size());
+      for (size_t i = 0; i < chunk_size; i++) {
+        frames_.push_back(&chunk->GetPages()[i]);
+      }
+      chunks_.emplace_back(first_frame_id, std::move(chunk));
+    }
+    const size_t new_pool_size = std::min({pool_size, frames_.size(), pool_size_ + BUFFER_POOL_CHUNK_SIZE});
+    replacer_->Resize(new_pool_size);
+    for (size_t i = pool_size_; i < new_pool_size; i++) {
+      free_list_.push_back(static_cast<frame_id_t>(i));
+    }
+    pool_size_ = new_pool_size;
+  }
+
+  while (pool_size_ > pool_size) {
+    const size_t begin = std::max(pool_size, pool_size_ - std::min<size_t>(pool_size_, BUFFER_POOL_CHUNK_SIZE));
+    if (!WithdrawFrames(begin, pool_size_, lock)) {
+      return false;
+    }
+    pool_size_ = begin;
+    replacer_->Resize(begin);
+
+    // Release the chunks that now lie entirely above the pool, without holding the latch.
+    std::vector<std::unique_ptr<FrameChunk>> withdrawn_chunks;
+    while (chunks_.size() > 1 && static_cast<size_t>(chunks_.back().first) >= pool_size_) {
+      frames_.resize(chunks_.back().first);
+      withdrawn_chunks.push_back(std::move(chunks_.back().second));
+      chunks_.pop_back();
+    }
+    lock.unlock();
+    withdrawn_chunks.clear();
+    lock.lock();
+  }
+  return true;
+}
+
+auto BufferPoolManagerInstance::WithdrawFrames(size_t begin, size_t end, std::unique_lock<std::mutex> &lock) -> bool {
+  const auto deadline = std::chrono::steady_clock::now() + buffer_pool_withdraw_timeout;
+  auto in_range = [begin, end](frame_id_t frame_id) {
+    return static_cast<size_t>(frame_id) >= begin && static_cast<size_t>(frame_id) < end;
+  };
+  while (true) {
+    // A withdrawn frame holds no page and is neither on the free list nor in the replacer, so nothing can hand it out
+    // again. The free list is filtered on every pass since DeletePage() may have put a frame of the range back.
+    free_list_.remove_if(in_range);
+    std::vector<page_id_t> dirty_pages;
+    bool pinned = false;
+    for (size_t i = begin; i < end; i++) {
+      const auto frame_id = static_cast<frame_id_t>(i);
+      auto *page = GetPage(frame_id);
+      if (page->GetPageId() == INVALID_PAGE_ID) {
+        continue;
+      }
+      if (page->GetPinCount() > 0 || page->io_state_ != PageIOState::READY) {
+        pinned = true;
+      } else if (page->IsDirty()) {
+        dirty_pages.push_back(page->GetPageId());
+      } else {
+        replacer_->Remove(frame_id);
+        page_table_->Remove(page->GetPageId());
+        pages_set_.erase(page->GetPageId());
+        page->page_id_ = INVALID_PAGE_ID;
+      }
+    }
+    if (!pinned && dirty_pages.empty()) {
+      return true;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      for (size_t i = begin; i < end; i++) {
+        if (GetPage(static_cast<frame_id_t>(i))->GetPageId() == INVALID_PAGE_ID) {
+          free_list_.push_back(static_cast<frame_id_t>(i));
+        }
+      }
+      return false;
+    }
+
+    // Write back the dirty pages and check them again on the next pass, as they may have been pinned in the meantime.
+    for (auto page_id : dirty_pages) {
+      WriteBackPage(page_id, lock);
+    }
+    if (dirty_pages.empty()) {
+      lock.unlock();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      lock.lock();
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::GetPage(frame_id_t frame_id) -> Page * { return frames_[frame_id]; }
+
+auto BufferPoolManagerInstance::AcquireLatch() -> std::unique_lock<std::mutex> {
+  // Only a contended acquisition is timed, so that the common case does not pay for reading the clock.
+  std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    const auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    BufferPoolCounters::Add(counters_.Local().latch_wait_ns_, ElapsedNanoseconds(start));
+  }
+  return lock;
+}
+
+void BufferPoolManagerInstance::ReadPageFromDisk(page_id_t page_id, char *page_data) {
+  const auto start = std::chrono::steady_clock::now();
+  disk_manager_->ReadPage(page_id, page_data);
+  auto &counters = counters_.Local();
+  BufferPoolCounters::Add(counters.disk_reads_);
+  BufferPoolCounters::Add(counters.disk_read_ns_, ElapsedNanoseconds(start));
+}
+
+void BufferPoolManagerInstance::ReadPagesFromDisk(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  if (pages.size() == 1) {
+    ReadPageFromDisk(pages.front().first, pages.front().second);
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  disk_manager_->ReadPages(pages);
+  auto &counters = counters_.Local();
+  BufferPoolCounters::Add(counters.disk_reads_, pages.size());
+  BufferPoolCounters::Add(counters.disk_read_ns_, ElapsedNanoseconds(start));
+}
+
+void BufferPoolManagerInstance::WritePagesToDisk(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  if (pages.size() == 1) {
+    WritePageToDisk(pages.front().first, pages.front().second);
+    return;
+  }
+  SyncFreePageBitmap();
+  FlushLogForPages(pages);
+  const auto start = std::chrono::steady_clock::now();
+  disk_manager_->WritePages(pages);
+  auto &counters = counters_.Local();
+  BufferPoolCounters::Add(counters.disk_writes_, pages.size());
+  BufferPoolCounters::Add(counters.disk_write_ns_, ElapsedNanoseconds(start));
+}
+
+void BufferPoolManagerInstance::WritePageToDisk(page_id_t page_id, const char *page_data) {
+  SyncFreePageBitmap();
+  FlushLogForPages({{page_id, page_data}});
+  const auto start = std::chrono::steady_clock::now();
+  disk_manager_->WritePage(page_id, page_data);
+  auto &counters = counters_.Local();
+  BufferPoolCounters::Add(counters.disk_writes_);
+  BufferPoolCounters::Add(counters.disk_write_ns_, ElapsedNanoseconds(start));
+}
+
+void BufferPoolManagerInstance::FlushLogForPages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  if (log_manager_ == nullptr) {
+    return;
+  }
+  lsn_t max_lsn = INVALID_LSN;
+  for (const auto &[page_id, data] : pages) {
+    lsn_t lsn;
+    memcpy(&lsn, data + Page::OFFSET_LSN, sizeof(lsn_t));
+    max_lsn = std::max(max_lsn, lsn);
+  }
+  // Recovery appends its CLRs with logging off. Otherwise, without logging, a page LSN is that of a record of an
+  // earlier run, which is durable, or zero.
+  max_lsn = std::min(max_lsn, log_manager_->GetNextLSN() - 1);
+  if (max_lsn > log_manager_->GetPersistentLSN()) {
+    log_manager_->Flush(max_lsn);
+  }
+}
 
 }  // namespace bustub
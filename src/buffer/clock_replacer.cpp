@@ -12,18 +12,85 @@
 
 #include "buffer/clock_replacer.h"
 
+#include "common/macros.h"
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : frames_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (size_ == 0) {
+    return false;
+  }
+  // The first sweep clears the reference bits it passes, so the second sweep at the latest finds a victim.
+  while (true) {
+    auto &frame = frames_[hand_];
+    const auto current = static_cast<frame_id_t>(hand_);
+    hand_ = (hand_ + 1) % frames_.size();
+    if (!frame.live_ || !frame.evictable_) {
+      continue;
+    }
+    if (frame.referenced_) {
+      frame.referenced_ = false;
+      continue;
+    }
+    frame = FrameInfo{};
+    size_--;
+    *frame_id = current;
+    return true;
+  }
+}
+
+void ClockReplacer::RecordAccess(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size(), "invalid frame id");
+  frames_[frame_id].live_ = true;
+  frames_[frame_id].referenced_ = true;
+}
+
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size(), "invalid frame id");
+  auto &frame = frames_[frame_id];
+  if (!frame.live_ || frame.evictable_ == set_evictable) {
+    return;
+  }
+  frame.evictable_ = set_evictable;
+  if (set_evictable) {
+    size_++;
+  } else {
+    size_--;
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (!frame.live_) {
+    return;
+  }
+  BUSTUB_ASSERT(frame.evictable_, "cannot remove a non-evictable frame");
+  frame = FrameInfo{};
+  size_--;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Resize(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = num_frames; i < frames_.size(); i++) {
+    BUSTUB_ASSERT(!frames_[i].live_, "cannot shrink the replacer past a frame it tracks");
+  }
+  frames_.resize(num_frames);
+  if (hand_ >= num_frames) {
+    hand_ = 0;
+  }
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+auto ClockReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return size_;
+}
 
 }  // namespace bustub
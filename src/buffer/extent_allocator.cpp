@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.cpp
+//
+// Identification: src/buffer/extent_allocator.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/extent_allocator.h"
+
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+auto ExtentAllocator::NewPage(page_id_t *page_id, BufferAccessStrategy *strategy) -> Page * {
+  page_id_t new_page_id = TakePageId();
+  // Without extents, pages are created one at a time.
+  if (new_page_id == INVALID_PAGE_ID) {
+    return bpm_->NewPageInTablespace(page_id, tablespace_id_, strategy);
+  }
+  auto *page = bpm_->NewPageAt(new_page_id, strategy);
+  if (page == nullptr) {
+    std::scoped_lock<std::mutex> lock(latch_);
+    returned_page_ids_.push_back(new_page_id);
+    return nullptr;
+  }
+  *page_id = new_page_id;
+  return page;
+}
+
+void ExtentAllocator::ReleasePage(page_id_t page_id) {
+  bpm_->UnpinPage(page_id, false);
+  if (extent_.load() == 0) {
+    // no extent was ever reserved, so the page came from the free pages of the buffer pool
+    bpm_->DeletePage(page_id);
+    return;
+  }
+  // Deleting the page would hand its id to anyone; the next NewPageAt() reuses the frame if it is still there.
+  std::scoped_lock<std::mutex> lock(latch_);
+  returned_page_ids_.push_back(page_id);
+}
+
+auto ExtentAllocator::TakePageId() -> page_id_t {
+  // Fast path: take the next id of the current extent without the latch. Callers usually hold page latches of the
+  // table or index, so they should not queue up here.
+  uint64_t extent = extent_.load();
+  while (NextOf(extent) < EndOf(extent)) {
+    if (extent_.compare_exchange_weak(extent, extent + 1)) {
+      return NextOf(extent);
+    }
+  }
+
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (!returned_page_ids_.empty()) {
+    const page_id_t page_id = returned_page_ids_.back();
+    returned_page_ids_.pop_back();
+    return page_id;
+  }
+  // Another thread may have reserved a new extent while this one waited for the latch.
+  extent = extent_.load();
+  while (NextOf(extent) < EndOf(extent)) {
+    if (extent_.compare_exchange_weak(extent, extent + 1)) {
+      return NextOf(extent);
+    }
+  }
+  const page_id_t first_page_id = bpm_->AllocateExtent(tablespace_id_, extent_size_);
+  if (first_page_id == INVALID_PAGE_ID) {
+    return INVALID_PAGE_ID;
+  }
+  extent_.store(MakeExtent(first_page_id + 1, first_page_id + static_cast<page_id_t>(extent_size_)));
+  return first_page_id;
+}
+
+}  // namespace bustub
@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_chunk.cpp
+//
+// Identification: src/buffer/frame_chunk.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_chunk.h"
+
+#include <sys/mman.h>
+#include <cstdint>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+/** Size of a transparent huge page on the platforms that have them. */
+static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+
+FrameChunk::FrameChunk(size_t num_frames, bool huge_pages, size_t page_size)
+    : num_frames_(num_frames), pages_(std::make_unique<Page[]>(num_frames)) {
+  const size_t data_size = num_frames * page_size;
+  // Huge pages only back huge-page-aligned ranges, so map a little more and start at the first aligned address.
+  const bool align_huge = huge_pages && data_size >= HUGE_PAGE_SIZE;
+  map_size_ = align_huge ? data_size + HUGE_PAGE_SIZE : data_size;
+  map_ = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map_ == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't allocate buffer pool frames");
+  }
+  auto address = reinterpret_cast<uintptr_t>(map_);
+  if (align_huge) {
+    address = (address + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+#ifdef MADV_HUGEPAGE
+    madvise(reinterpret_cast<void *>(address), data_size, MADV_HUGEPAGE);
+#endif
+  }
+  auto *data = reinterpret_cast<char *>(address);
+  for (size_t i = 0; i < num_frames; i++) {
+    pages_[i].data_ = data + i * page_size;
+    pages_[i].page_size_ = page_size;
+  }
+}
+
+FrameChunk::~FrameChunk() { munmap(map_, map_size_); }
+
+}  // namespace bustub
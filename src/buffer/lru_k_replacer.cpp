@@ -19,26 +19,13 @@ LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (nomax_replacers_.size() + max_replacers_.size() == 0) {
+  // Frames with +inf backward k-distance always go first; both sets keep their victim at the front.
+  auto &replacers = nomax_replacers_.empty() ? max_replacers_ : nomax_replacers_;
+  if (replacers.empty()) {
     return false;
   }
-  if (!nomax_replacers_.empty()) {
-    *frame_id = *nomax_replacers_.begin();
-    for (auto x : nomax_replacers_) {
-      if (timestamp_[*frame_id].Getime() > timestamp_[x].Getime()) {
-        *frame_id = x;
-      }
-    }
-    nomax_replacers_.erase(*frame_id);
-  } else {
-    *frame_id = *max_replacers_.begin();
-    for (auto x : max_replacers_) {
-      if (timestamp_[*frame_id].Getime() > timestamp_[x].Getime()) {
-        *frame_id = x;
-      }
-    }
-    max_replacers_.erase(*frame_id);
-  }
+  *frame_id = replacers.begin()->second;
+  replacers.erase(replacers.begin());
   timestamp_[*frame_id].Clear();
   return true;
 }
@@ -51,31 +38,25 @@ void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
 
 void LRUKReplacer::DelReplacers(frame_id_t frame_id) {
   auto &x = timestamp_[frame_id];
-  if (!x.IsLive()) {
+  if (!x.IsLive() || !x.IsEvicatable()) {
     return;
   }
   if (x.IsMax()) {
-    if (InMaxReplacers(frame_id)) {
-      max_replacers_.erase(frame_id);
-    }
+    max_replacers_.erase({x.Getime(), frame_id});
   } else {
-    if (InNoMaxReplacers(frame_id)) {
-      nomax_replacers_.erase(frame_id);
-    }
+    nomax_replacers_.erase({x.Getime(), frame_id});
   }
 }
 
 void LRUKReplacer::AddReplacers(frame_id_t frame_id) {
   auto &x = timestamp_[frame_id];
-  if (!x.IsLive()) {
+  if (!x.IsLive() || !x.IsEvicatable()) {
     return;
   }
-  if (x.IsEvicatable()) {
-    if (x.IsMax()) {
-      max_replacers_.insert(frame_id);
-    } else {
-      nomax_replacers_.insert(frame_id);
-    }
+  if (x.IsMax()) {
+    max_replacers_.emplace(x.Getime(), frame_id);
+  } else {
+    nomax_replacers_.emplace(x.Getime(), frame_id);
   }
 }
 
@@ -83,26 +64,24 @@ void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::scoped_lock<std::mutex> lock(latch_);
   BUSTUB_ASSERT(frame_id <= static_cast<int>(replacer_size_) - 1, true);
   auto &x = timestamp_[frame_id];
-  if (!x.IsLive()) {
+  if (!x.IsLive() || x.IsEvicatable() == set_evictable) {
     return;
   }
   if (set_evictable) {
     x.SetEvictable(true);
     AddReplacers(frame_id);
   } else {
-    x.SetEvictable(false);
     DelReplacers(frame_id);
+    x.SetEvictable(false);
   }
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (timestamp_[frame_id].IsLive()) {
-    BUSTUB_ASSERT(InNoMaxReplacers(frame_id) || InMaxReplacers(frame_id), true);
-  }
   if (!timestamp_[frame_id].IsLive()) {
     return;
   }
+  BUSTUB_ASSERT(InNoMaxReplacers(frame_id) || InMaxReplacers(frame_id), true);
   DelReplacers(frame_id);
   timestamp_[frame_id].Clear();
 }
@@ -112,22 +91,38 @@ auto LRUKReplacer::Size() -> size_t {
   return nomax_replacers_.size() + max_replacers_.size();
 }
 
+void LRUKReplacer::Resize(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = num_frames; i < timestamp_.size(); i++) {
+    BUSTUB_ASSERT(!timestamp_[i].IsLive(), "cannot shrink the replacer past a frame it tracks");
+  }
+  replacer_size_ = num_frames;
+  // Frameinfo is not assignable, so the vector can only be resized at its end.
+  while (timestamp_.size() > num_frames) {
+    timestamp_.pop_back();
+  }
+  while (timestamp_.size() < num_frames) {
+    timestamp_.emplace_back(k_);
+  }
+}
+
 inline auto LRUKReplacer::InNoMaxReplacers(frame_id_t frame_id) -> bool {
-  return nomax_replacers_.find(frame_id) != nomax_replacers_.end();
+  auto &x = timestamp_[frame_id];
+  return x.IsEvicatable() && !x.IsMax() && nomax_replacers_.count({x.Getime(), frame_id}) != 0;
 }
 
 inline auto LRUKReplacer::InMaxReplacers(frame_id_t frame_id) -> bool {
-  return max_replacers_.find(frame_id) != max_replacers_.end();
+  auto &x = timestamp_[frame_id];
+  return x.IsEvicatable() && x.IsMax() && max_replacers_.count({x.Getime(), frame_id}) != 0;
 }
 auto LRUKReplacer::Creattime() -> size_t { return ++current_timestamp_; }
 
 auto LRUKReplacer::Addstamp(frame_id_t frame_id) -> void {
   auto &x = timestamp_[frame_id];
+  // The eviction order is keyed on the access history, so take the frame out before its history changes.
+  DelReplacers(frame_id);
   x.Setlive(true);
   x.Add(Creattime());
-  if (x.IsMax() && InNoMaxReplacers(frame_id)) {
-    nomax_replacers_.erase(frame_id);
-    max_replacers_.insert(frame_id);
-  }
+  AddReplacers(frame_id);
 }
 }  // namespace bustub
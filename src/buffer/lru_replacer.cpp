@@ -12,18 +12,76 @@
 
 #include "buffer/lru_replacer.h"
 
+#include "common/macros.h"
+
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages) : frames_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (evictable_frames_.empty()) {
+    return false;
+  }
+  *frame_id = evictable_frames_.begin()->second;
+  evictable_frames_.erase(evictable_frames_.begin());
+  frames_[*frame_id] = FrameInfo{};
+  return true;
+}
+
+void LRUReplacer::RecordAccess(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size(), "invalid frame id");
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    evictable_frames_.erase({frame.last_access_, frame_id});
+  }
+  frame.live_ = true;
+  frame.last_access_ = ++current_timestamp_;
+  if (frame.evictable_) {
+    evictable_frames_.emplace(frame.last_access_, frame_id);
+  }
+}
+
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size(), "invalid frame id");
+  auto &frame = frames_[frame_id];
+  if (!frame.live_ || frame.evictable_ == set_evictable) {
+    return;
+  }
+  frame.evictable_ = set_evictable;
+  if (set_evictable) {
+    evictable_frames_.emplace(frame.last_access_, frame_id);
+  } else {
+    evictable_frames_.erase({frame.last_access_, frame_id});
+  }
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (!frame.live_) {
+    return;
+  }
+  BUSTUB_ASSERT(frame.evictable_, "cannot remove a non-evictable frame");
+  evictable_frames_.erase({frame.last_access_, frame_id});
+  frame = FrameInfo{};
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::Resize(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = num_frames; i < frames_.size(); i++) {
+    BUSTUB_ASSERT(!frames_[i].live_, "cannot shrink the replacer past a frame it tracks");
+  }
+  frames_.resize(num_frames);
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+auto LRUReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return evictable_frames_.size();
+}
 
 }  // namespace bustub
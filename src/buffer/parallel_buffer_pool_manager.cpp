@@ -0,0 +1,242 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                                     size_t replacer_k, LogManager *log_manager,
+                                                     ReplacerType replacer_type)
+    : disk_manager_(disk_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "a parallel buffer pool needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        pool_size, static_cast<uint32_t>(num_instances), static_cast<uint32_t>(i), disk_manager, replacer_k,
+        log_manager, replacer_type));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
+  size_t pool_size = 0;
+  for (auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::GetNumPages() -> size_t {
+  size_t num_pages = 0;
+  for (auto &instance : instances_) {
+    num_pages += instance->GetNumPages();
+  }
+  return num_pages;
+}
+
+auto ParallelBufferPoolManager::Resize(size_t pool_size) -> bool {
+  if (pool_size < instances_.size()) {
+    return false;
+  }
+  bool resized = true;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    const size_t instance_pool_size = pool_size / instances_.size() + (i < pool_size % instances_.size() ? 1 : 0);
+    resized = instances_[i]->Resize(instance_pool_size) && resized;
+  }
+  return resized;
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance * {
+  BUSTUB_ASSERT(page_id >= 0, "cannot route an invalid page id to a buffer pool instance");
+  // Route by block number, so that every tablespace is spread over all instances.
+  return instances_[static_cast<size_t>(BlockOf(page_id)) % instances_.size()].get();
+}
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+  for (auto page_id : page_ids) {
+    if (page_id >= 0) {
+      instance_page_ids[static_cast<size_t>(BlockOf(page_id)) % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!instance_page_ids[i].empty()) {
+      instances_[i]->PrefetchPages(instance_page_ids[i]);
+    }
+  }
+}
+
+void ParallelBufferPoolManager::StartPageCleaner(double clean_ratio) {
+  for (auto &instance : instances_) {
+    instance->StartPageCleaner(clean_ratio);
+  }
+}
+
+void ParallelBufferPoolManager::StopPageCleaner() {
+  for (auto &instance : instances_) {
+    instance->StopPageCleaner();
+  }
+}
+
+auto ParallelBufferPoolManager::GetCleanEvictions() const -> size_t {
+  size_t clean_evictions = 0;
+  for (const auto &instance : instances_) {
+    clean_evictions += instance->GetCleanEvictions();
+  }
+  return clean_evictions;
+}
+
+auto ParallelBufferPoolManager::GetDirtyEvictions() const -> size_t {
+  size_t dirty_evictions = 0;
+  for (const auto &instance : instances_) {
+    dirty_evictions += instance->GetDirtyEvictions();
+  }
+  return dirty_evictions;
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+auto ParallelBufferPoolManager::GetDirtyPages() -> std::vector<page_id_t> {
+  std::vector<page_id_t> page_ids;
+  for (auto &instance : instances_) {
+    auto instance_page_ids = instance->GetDirtyPages();
+    page_ids.insert(page_ids.end(), instance_page_ids.begin(), instance_page_ids.end());
+  }
+  return page_ids;
+}
+
+auto ParallelBufferPoolManager::FlushPages(const std::vector<page_id_t> &page_ids) -> FlushStats {
+  std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+  for (auto page_id : page_ids) {
+    if (page_id >= 0) {
+      instance_page_ids[static_cast<size_t>(BlockOf(page_id)) % instances_.size()].push_back(page_id);
+    }
+  }
+  FlushStats stats;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    // Even without pages of its own, the first instance syncs, which covers writes of evicted pages.
+    if (!instance_page_ids[i].empty() || i == 0) {
+      stats += instances_[i]->FlushPages(instance_page_ids[i]);
+    }
+  }
+  return stats;
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * { return NewPageWithStrategy(page_id, nullptr); }
+
+auto ParallelBufferPoolManager::FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPageWithStrategy(page_id, strategy);
+}
+
+auto ParallelBufferPoolManager::NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) -> Page * {
+  return NewPageInTablespace(page_id, DEFAULT_TABLESPACE, strategy);
+}
+
+auto ParallelBufferPoolManager::NewPageInTablespace(page_id_t *page_id, tablespace_id_t tablespace_id,
+                                                    BufferAccessStrategy *strategy) -> Page * {
+  // Every call moves the starting point forward, so that concurrent allocations spread over all instances instead of
+  // all hitting instance 0 until it is full.
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; i++) {
+    auto *page = instances_[(start + i) % num_instances]->NewPageInTablespace(page_id, tablespace_id, strategy);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::AllocateExtent(tablespace_id_t tablespace_id, size_t num_pages) -> page_id_t {
+  std::scoped_lock<std::mutex> lock(extent_latch_);
+  while (true) {
+    // The run may start right after the last id the instance furthest ahead handed out: ids of the other instances
+    // below that are still free.
+    page_id_t last_page_id = MakePageId(tablespace_id, 0) - 1;
+    for (auto &instance : instances_) {
+      last_page_id = std::max(last_page_id, instance->NextUnallocatedPageId(tablespace_id) -
+                                                static_cast<page_id_t>(instances_.size()));
+    }
+    const page_id_t first_page_id = last_page_id + 1;
+    if (static_cast<size_t>(BlockOf(first_page_id)) + num_pages > BLOCKS_PER_TABLESPACE) {
+      return INVALID_PAGE_ID;
+    }
+    // Instances that reserved their share before one failed skip it on the next attempt; in the default tablespace
+    // that frees it again.
+    if (std::all_of(instances_.begin(), instances_.end(),
+                    [&](auto &instance) { return instance->ReserveExtent(first_page_id, num_pages); })) {
+      disk_manager_->PreallocatePages(first_page_id, num_pages);
+      return first_page_id;
+    }
+  }
+}
+
+auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+auto ParallelBufferPoolManager::FlushAllPgsImp() -> FlushStats {
+  std::vector<std::vector<std::pair<page_id_t, const char *>>> instance_pages;
+  std::vector<std::vector<char>> instance_copies(instances_.size());
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    instance_pages.push_back(instances_[i]->PinPagesToFlush(&instance_copies[i]));
+    pages.insert(pages.end(), instance_pages.back().begin(), instance_pages.back().end());
+  }
+  uint64_t write_ns = 0;
+  FlushStats stats;
+  try {
+    stats = BufferPoolManagerInstance::WriteSortedPages(disk_manager_, &pages, &write_ns);
+  } catch (const Exception &) {
+    for (size_t i = 0; i < instances_.size(); i++) {
+      instances_[i]->AbortFlush(instance_pages[i]);
+    }
+    throw;
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    // Every instance is charged its share of the write time.
+    const uint64_t share = pages.empty() ? 0 : write_ns * instance_pages[i].size() / pages.size();
+    instances_[i]->FinishFlush(instance_pages[i], share);
+  }
+  // One durability barrier for the whole pool.
+  disk_manager_->Sync();
+  return stats;
+}
+
+}  // namespace bustub
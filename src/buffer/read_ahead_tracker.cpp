@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_tracker.cpp
+//
+// Identification: src/buffer/read_ahead_tracker.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead_tracker.h"
+
+#include <vector>
+
+namespace bustub {
+
+void ReadAheadTracker::OnPageChange(BufferPoolManager *buffer_pool_manager, page_id_t from_page_id,
+                                    page_id_t to_page_id) {
+  if (from_page_id == INVALID_PAGE_ID || to_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  const page_id_t stride = to_page_id - from_page_id;
+  if (stride <= 0 || stride != stride_) {
+    stride_ = stride;
+    run_length_ = 1;
+    prefetched_until_ = INVALID_PAGE_ID;
+    return;
+  }
+  run_length_++;
+  if (run_length_ < READ_AHEAD_TRIGGER) {
+    return;
+  }
+
+  // Refill the window once the scan is within half a window of its end, so that reads stay ahead of the scan.
+  if (prefetched_until_ != INVALID_PAGE_ID && prefetched_until_ - to_page_id > stride_ * (READ_AHEAD_PAGES / 2)) {
+    return;
+  }
+  page_id_t next_page_id = prefetched_until_ == INVALID_PAGE_ID ? to_page_id : prefetched_until_;
+  const page_id_t window_end = to_page_id + stride_ * READ_AHEAD_PAGES;
+  std::vector<page_id_t> page_ids;
+  while (next_page_id + stride_ <= window_end) {
+    next_page_id += stride_;
+    page_ids.push_back(next_page_id);
+  }
+  if (page_ids.empty()) {
+    return;
+  }
+  prefetched_until_ = next_page_id;
+  buffer_pool_manager->PrefetchPages(page_ids);
+}
+
+}  // namespace bustub
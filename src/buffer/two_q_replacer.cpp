@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.cpp
+//
+// Identification: src/buffer/two_q_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_q_replacer.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+TwoQReplacer::TwoQReplacer(size_t num_frames)
+    : kin_(std::max<size_t>(1, num_frames / 4)), kout_(std::max<size_t>(1, num_frames / 2)), frames_(num_frames) {}
+
+auto TwoQReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // Take from A1in while it is over its share, or when Am has nothing to give.
+  const bool from_a1in = !a1in_evictable_.empty() && (a1in_size_ > kin_ || am_evictable_.empty());
+  auto &evictable = from_a1in ? a1in_evictable_ : am_evictable_;
+  if (evictable.empty()) {
+    return false;
+  }
+  *frame_id = evictable.begin()->second;
+  evictable.erase(evictable.begin());
+
+  auto &frame = frames_[*frame_id];
+  if (from_a1in) {
+    a1in_size_--;
+    if (frame.page_id_ != INVALID_PAGE_ID) {
+      a1out_.push_front(frame.page_id_);
+      a1out_index_[frame.page_id_] = a1out_.begin();
+      if (a1out_.size() > kout_) {
+        a1out_index_.erase(a1out_.back());
+        a1out_.pop_back();
+      }
+    }
+  }
+  frame = FrameInfo{};
+  return true;
+}
+
+void TwoQReplacer::RecordAccess(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size(), "invalid frame id");
+  auto &frame = frames_[frame_id];
+  if (frame.queue_ == Queue::NONE) {
+    LoadLocked(frame_id, INVALID_PAGE_ID);
+    return;
+  }
+  // Accesses to a page in A1in are assumed to be correlated with its first one and do not reorder it.
+  if (frame.queue_ == Queue::AM) {
+    if (frame.evictable_) {
+      am_evictable_.erase({frame.key_, frame_id});
+    }
+    frame.key_ = ++current_timestamp_;
+    if (frame.evictable_) {
+      am_evictable_.emplace(frame.key_, frame_id);
+    }
+  }
+}
+
+void TwoQReplacer::RecordLoad(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size(), "invalid frame id");
+  BUSTUB_ASSERT(frames_[frame_id].queue_ == Queue::NONE, "a page can only be loaded into a frame that is not in use");
+  LoadLocked(frame_id, page_id);
+}
+
+void TwoQReplacer::LoadLocked(frame_id_t frame_id, page_id_t page_id) {
+  auto &frame = frames_[frame_id];
+  auto it = a1out_index_.find(page_id);
+  if (it != a1out_index_.end()) {
+    a1out_.erase(it->second);
+    a1out_index_.erase(it);
+    frame.queue_ = Queue::AM;
+  } else {
+    frame.queue_ = Queue::A1IN;
+    a1in_size_++;
+  }
+  frame.key_ = ++current_timestamp_;
+  frame.evictable_ = false;
+  frame.page_id_ = page_id;
+}
+
+void TwoQReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < frames_.size(), "invalid frame id");
+  auto &frame = frames_[frame_id];
+  if (frame.queue_ == Queue::NONE || frame.evictable_ == set_evictable) {
+    return;
+  }
+  frame.evictable_ = set_evictable;
+  if (set_evictable) {
+    EvictableFrames(frame.queue_).emplace(frame.key_, frame_id);
+  } else {
+    EvictableFrames(frame.queue_).erase({frame.key_, frame_id});
+  }
+}
+
+void TwoQReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.queue_ == Queue::NONE) {
+    return;
+  }
+  BUSTUB_ASSERT(frame.evictable_, "cannot remove a non-evictable frame");
+  EvictableFrames(frame.queue_).erase({frame.key_, frame_id});
+  if (frame.queue_ == Queue::A1IN) {
+    a1in_size_--;
+  }
+  frame = FrameInfo{};
+}
+
+void TwoQReplacer::Resize(size_t num_frames) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = num_frames; i < frames_.size(); i++) {
+    BUSTUB_ASSERT(frames_[i].queue_ == Queue::NONE, "cannot shrink the replacer past a frame it tracks");
+  }
+  frames_.resize(num_frames);
+  kin_ = std::max<size_t>(1, num_frames / 4);
+  kout_ = std::max<size_t>(1, num_frames / 2);
+  while (a1out_.size() > kout_) {
+    a1out_index_.erase(a1out_.back());
+    a1out_.pop_back();
+  }
+}
+
+auto TwoQReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return a1in_evictable_.size() + am_evictable_.size();
+}
+
+}  // namespace bustub
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -12,11 +13,13 @@
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
 #include "common/bustub_instance.h"
 #include "common/enums/statement_type.h"
 #include "common/exception.h"
+#include "common/macros.h"
 #include "common/util/string_util.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction.h"
@@ -31,21 +34,76 @@
 #include "planner/planner.h"
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
+#include "storage/disk/async_disk_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/page/header_page.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
+/**
+ * Create the buffer pool of a BusTub instance. When `buffer_pool_instances` is larger than one, the frames are split
+ * evenly over that many independent shards.
+ */
+static auto MakeBufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager,
+                                  ReplacerType replacer_type) -> BufferPoolManager * {
+  const size_t num_instances = buffer_pool_instances;
+  if (num_instances <= 1) {
+    return new BufferPoolManagerInstance(pool_size, disk_manager, LRUK_REPLACER_K, log_manager, replacer_type);
+  }
+  return new ParallelBufferPoolManager(num_instances, (pool_size + num_instances - 1) / num_instances, disk_manager,
+                                       LRUK_REPLACER_K, log_manager, replacer_type);
+}
+
 auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext> {
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+void BustubInstance::ReserveHeaderPage() {
+  if (buffer_pool_manager_ == nullptr) {
+    return;
+  }
+  // The high-water mark covers every page in the database file, even without a free space map to read it from.
+  if (buffer_pool_manager_->GetNumPages() == 0) {
+    // A new database: the first page id is the header page's, and the buffer pool formats it.
+    page_id_t page_id;
+    if (buffer_pool_manager_->NewPage(&page_id) == nullptr) {
+      return;
+    }
+    BUSTUB_ASSERT(page_id == HEADER_PAGE_ID, "the first page of a new database is the header page");
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return;
+  }
+  // A reopened database: page 0 was allocated first, so it is the header page, unless the database is older.
+  auto *header_page = reinterpret_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  if (header_page == nullptr) {
+    return;
+  }
+  const char *data = header_page->GetData();
+  bool is_dirty = false;
+  bool is_old_format = false;
+  if (HeaderPage::ReadPageSize(data) == 0) {
+    if (std::all_of(data, data + buffer_pool_manager_->GetPageSize(), [](char c) { return c == 0; })) {
+      // the header page did not reach the disk before the crash
+      header_page->Init(buffer_pool_manager_->GetPageSize());
+      is_dirty = true;
+    } else {
+      // older versions kept the record count where the magic number is now
+      is_old_format = true;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, is_dirty);
+  if (is_old_format) {
+    throw Exception("the header page of the database is in the format of an older version of BusTub");
+  }
+}
+
+BustubInstance::BustubInstance(const std::string &db_file_name, ReplacerType replacer_type, size_t page_size) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  disk_manager_ = new AsyncDiskManager(db_file_name, true, false, page_size);
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
@@ -53,18 +111,27 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
   // buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = MakeBufferPoolManager(128, disk_manager_, log_manager_, replacer_type);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
   }
+  try {
+    ReserveHeaderPage();
+  } catch (const Exception &) {
+    // the database cannot be opened; leave nothing running behind
+    delete buffer_pool_manager_;
+    delete log_manager_;
+    delete disk_manager_;
+    throw;
+  }
 
   // Transaction (txn) related.
   lock_manager_ = new LockManager();
   txn_manager_ = new TransactionManager(lock_manager_, log_manager_);
 
   // Checkpoint related.
-  checkpoint_manager_ = new CheckpointManager(txn_manager_, log_manager_, buffer_pool_manager_);
+  checkpoint_manager_ = new CheckpointManager(txn_manager_, log_manager_, buffer_pool_manager_, disk_manager_);
 
   // Catalog.
   catalog_ = new Catalog(buffer_pool_manager_, lock_manager_, log_manager_);
@@ -73,11 +140,11 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
 
-BustubInstance::BustubInstance() {
+BustubInstance::BustubInstance(ReplacerType replacer_type, size_t page_size) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManagerUnlimitedMemory();
+  disk_manager_ = new DiskManagerUnlimitedMemory(page_size);
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
@@ -85,18 +152,19 @@ BustubInstance::BustubInstance() {
   // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
   // buffer pool size specified in `config.h`.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ = MakeBufferPoolManager(128, disk_manager_, log_manager_, replacer_type);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
   }
+  ReserveHeaderPage();
 
   // Transaction (txn) related.
   lock_manager_ = new LockManager();
   txn_manager_ = new TransactionManager(lock_manager_, log_manager_);
 
   // Checkpoint related.
-  checkpoint_manager_ = new CheckpointManager(txn_manager_, log_manager_, buffer_pool_manager_);
+  checkpoint_manager_ = new CheckpointManager(txn_manager_, log_manager_, buffer_pool_manager_, disk_manager_);
 
   // Catalog.
   catalog_ = new Catalog(buffer_pool_manager_, lock_manager_, log_manager_);
@@ -146,6 +214,24 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayBufferPoolStats(ResultWriter &writer) {
+  if (buffer_pool_manager_ == nullptr) {
+    throw NotImplementedException("BufferPoolManager is not implemented");
+  }
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("name");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  for (const auto &[name, value] : buffer_pool_manager_->GetStats().ToRows()) {
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(value);
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -172,8 +258,27 @@ see the execution plan of your query.
   WriteOneCell(help, writer);
 }
 
+void BustubInstance::ResizeBufferPool(const std::string &value) {
+  if (buffer_pool_manager_ == nullptr) {
+    throw NotImplementedException("BufferPoolManager is not implemented");
+  }
+  int64_t pool_size = 0;
+  try {
+    pool_size = std::stoll(value);
+  } catch (std::logic_error &e) {
+    pool_size = 0;
+  }
+  if (pool_size <= 0) {
+    throw Exception(fmt::format("invalid buffer_pool_size: {}", value));
+  }
+  if (!buffer_pool_manager_->Resize(static_cast<size_t>(pool_size))) {
+    throw Exception(fmt::format("failed to resize the buffer pool to {} frames", pool_size));
+  }
+}
+
 auto BustubInstance::ExecuteSql(const std::string &sql, ResultWriter &writer) -> bool {
   auto txn = txn_manager_->Begin();
+  txn->SetSynchronousCommit(IsSynchronousCommit());
   auto result = ExecuteSqlTxn(sql, writer, txn);
   txn_manager_->Commit(txn);
   delete txn;
@@ -251,12 +356,25 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       }
       case StatementType::VARIABLE_SHOW_STATEMENT: {
         const auto &show_stmt = dynamic_cast<const VariableShowStatement &>(*statement);
-        auto content = GetSessionVariable(show_stmt.variable_);
+        if (show_stmt.variable_ == "buffer_pool_stats") {
+          CmdDisplayBufferPoolStats(writer);
+          continue;
+        }
+        auto content = show_stmt.variable_ == "buffer_pool_size" && buffer_pool_manager_ != nullptr
+                           ? std::to_string(buffer_pool_manager_->GetPoolSize())
+                           : GetSessionVariable(show_stmt.variable_);
         WriteOneCell(fmt::format("{}={}", show_stmt.variable_, content), writer);
         continue;
       }
       case StatementType::VARIABLE_SET_STATEMENT: {
         const auto &set_stmt = dynamic_cast<const VariableSetStatement &>(*statement);
+        if (set_stmt.variable_ == "buffer_pool_size") {
+          ResizeBufferPool(set_stmt.value_);
+          continue;
+        }
+        if (set_stmt.variable_ == "file_per_table") {
+          file_per_table = set_stmt.value_ == "true" || set_stmt.value_ == "on" || set_stmt.value_ == "1";
+        }
         session_variables_[set_stmt.variable_] = set_stmt.value_;
         continue;
       }
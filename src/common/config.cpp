@@ -18,6 +18,18 @@ std::atomic<bool> enable_logging(false);
 
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
+std::chrono::milliseconds async_commit_lag = std::chrono::milliseconds(10);
+
+std::atomic<size_t> buffer_pool_instances(1);
+
+std::chrono::milliseconds page_cleaner_interval = std::chrono::milliseconds(10);
+
+std::chrono::milliseconds buffer_pool_withdraw_timeout = std::chrono::milliseconds(1000);
+
+std::atomic<bool> buffer_pool_huge_pages(false);
+
+std::atomic<bool> file_per_table(false);
+
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
 }  // namespace bustub
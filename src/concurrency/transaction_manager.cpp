@@ -12,12 +12,14 @@
 
 #include "concurrency/transaction_manager.h"
 
+#include <exception>
 #include <mutex>  // NOLINT
 #include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "catalog/catalog.h"
+#include "common/exception.h"
 #include "storage/table/table_heap.h"
 namespace bustub {
 
@@ -33,9 +35,12 @@ auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level)
   }
 
   if (enable_logging) {
+    // Register the transaction along with its BEGIN record, so that a checkpoint that comes after the record sees it.
+    std::scoped_lock active_txns_lock(active_txns_latch_);
     LogRecord record = LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BEGIN);
     lsn_t lsn = log_manager_->AppendLogRecord(&record);
     txn->SetPrevLSN(lsn);
+    active_txns_[txn->GetTransactionId()] = {txn, record.GetLogOffset()};
   }
 
   std::unique_lock<std::shared_mutex> l(txn_map_mutex);
@@ -59,10 +64,32 @@ void TransactionManager::Commit(Transaction *txn) {
   }
   write_set->clear();
 
+  std::exception_ptr flush_error;
+  if (enable_logging) {
+    LogRecord record = LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+    lsn_t lsn = log_manager_->AppendLogRecord(&record);
+    txn->SetPrevLSN(lsn);
+    // The commit is durable once its record is; concurrent commits share the flush.
+    try {
+      if (txn->IsSynchronousCommit()) {
+        log_manager_->Flush(lsn);
+      } else {
+        log_manager_->FlushAsync(lsn);
+      }
+    } catch (const Exception &) {
+      // The commit is not durable, and no later one will be; the locks are released all the same.
+      flush_error = std::current_exception();
+    }
+  }
+  EndActiveTransaction(txn);
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
+  if (flush_error != nullptr) {
+    std::rethrow_exception(flush_error);
+  }
 }
 
 void TransactionManager::Abort(Transaction *txn) {
@@ -109,12 +136,40 @@ void TransactionManager::Abort(Transaction *txn) {
   table_write_set->clear();
   index_write_set->clear();
 
+  if (enable_logging) {
+    LogRecord record = LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+    lsn_t lsn = log_manager_->AppendLogRecord(&record);
+    txn->SetPrevLSN(lsn);
+  }
+  EndActiveTransaction(txn);
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
 
+void TransactionManager::WaitForLSN(lsn_t lsn) {
+  if (enable_logging && log_manager_ != nullptr) {
+    log_manager_->WaitForLSN(lsn);
+  }
+}
+
+auto TransactionManager::GetActiveTransactions() -> std::vector<ActiveTransaction> {
+  std::scoped_lock active_txns_lock(active_txns_latch_);
+  std::vector<ActiveTransaction> active_txns;
+  active_txns.reserve(active_txns_.size());
+  for (const auto &[txn_id, txn_and_offset] : active_txns_) {
+    active_txns.push_back({txn_id, txn_and_offset.first->GetPrevLSN(), txn_and_offset.second});
+  }
+  return active_txns;
+}
+
+void TransactionManager::EndActiveTransaction(Transaction *txn) {
+  std::scoped_lock active_txns_lock(active_txns_latch_);
+  active_txns_.erase(txn->GetTransactionId());
+}
+
 void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
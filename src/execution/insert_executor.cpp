@@ -18,7 +18,10 @@ namespace bustub {
 
 InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_executor_(std::move(child_executor)),
+      strategy_(exec_ctx->MakeBufferAccessStrategy(BufferAccessStrategy::Type::BULK_WRITE)) {}
 
 void InsertExecutor::Init() {
   has_output_ = false;
@@ -48,7 +51,8 @@ auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
   int cnt = 0;
   // Get each son data which is inserted,insert one by one
   while (child_executor_->Next(&child_tuple, &child_rid)) {
-    if (table_info->table_->InsertTuple(child_tuple, &child_rid, exec_ctx_->GetTransaction())) {
+    auto *strategy = exec_ctx_->IsBulkAccess(table_info->table_->GetNumPages()) ? strategy_ : nullptr;
+    if (table_info->table_->InsertTuple(child_tuple, &child_rid, exec_ctx_->GetTransaction(), strategy)) {
       cnt++;
       for (auto &index_info : exec_ctx_->GetCatalog()->GetTableIndexes(table_info->name_)) {
         auto key =
@@ -15,7 +15,9 @@
 namespace bustub {
 
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx), plan_(plan) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      strategy_(exec_ctx->MakeBufferAccessStrategy(BufferAccessStrategy::Type::BULK_READ)) {}
 
 void SeqScanExecutor::Init() {
   if (exec_ctx_->GetTransaction()->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
@@ -28,7 +30,8 @@ void SeqScanExecutor::Init() {
       throw ExecutionException(e.GetInfo());
     }
   }
-  it_ = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())->table_->Begin(exec_ctx_->GetTransaction());
+  auto *table = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())->table_.get();
+  it_ = table->Begin(exec_ctx_->GetTransaction(), exec_ctx_->IsBulkAccess(table->GetNumPages()) ? strategy_ : nullptr);
   // throw NotImplementedException("SeqScanExecutor is not implemented");
 }
 
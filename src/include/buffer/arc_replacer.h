@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST 2003).
+ *
+ * Resident pages are split into T1, pages seen once recently, and T2, pages seen at least twice, both managed as LRU.
+ * The ghost lists B1 and B2 remember the ids of pages recently evicted from T1 and T2. A page loaded again while in B1
+ * means T1 was too small, so the target size p of T1 grows; a page found in B2 shrinks it. Victims come from T1
+ * while it is larger than p and from T2 otherwise. The policy thus adapts between recency (scans) and frequency (a
+ * hot working set) without any tuning parameter.
+ *
+ * Pinned frames cannot be evicted, so when the preferred list has no evictable frame the other list is used.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_frames the maximum number of frames the ARCReplacer will be required to store, i.e. the cache size c
+   */
+  explicit ARCReplacer(size_t num_frames);
+
+  ~ARCReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void RecordLoad(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  void Resize(size_t num_frames) override;
+
+  /** @return the current target size p of T1 */
+  auto GetTargetT1Size() -> size_t {
+    std::scoped_lock<std::mutex> lock(latch_);
+    return target_t1_size_;
+  }
+
+ private:
+  /** The list a resident frame is in. */
+  enum class List { NONE, T1, T2 };
+
+  /** Book-keeping of one frame. */
+  struct FrameInfo {
+    List list_{List::NONE};
+    size_t last_access_{0};
+    bool evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** An ARC ghost list: page ids, most recently evicted first, with an index for O(1) lookup and removal. */
+  struct GhostList {
+    std::list<page_id_t> pages_;
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+
+    auto Contains(page_id_t page_id) const -> bool { return index_.count(page_id) != 0; }
+    auto Size() const -> size_t { return pages_.size(); }
+    void PushFront(page_id_t page_id) {
+      pages_.push_front(page_id);
+      index_[page_id] = pages_.begin();
+    }
+    void Erase(page_id_t page_id) {
+      auto it = index_.find(page_id);
+      pages_.erase(it->second);
+      index_.erase(it);
+    }
+    void PopBack() {
+      index_.erase(pages_.back());
+      pages_.pop_back();
+    }
+  };
+
+  /** An entry of the eviction order of a list: the last access of the frame, and the frame itself. */
+  using EvictionKey = std::pair<size_t, frame_id_t>;
+
+  /** @return the evictable frames of the given list */
+  auto EvictableFrames(List list) -> std::set<EvictionKey> & { return list == List::T1 ? t1_evictable_ : t2_evictable_; }
+
+  void LoadLocked(frame_id_t frame_id, page_id_t page_id);
+
+  /** Drop the oldest ghosts until |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c. */
+  void TrimGhosts();
+
+  /** The cache size c. */
+  size_t capacity_;
+  std::mutex latch_;
+  size_t current_timestamp_{0};
+  std::vector<FrameInfo> frames_;
+  /** The adaptive target size p of T1. */
+  size_t target_t1_size_{0};
+  /** Number of frames in T1 and T2, evictable or not. */
+  size_t t1_size_{0};
+  size_t t2_size_{0};
+  /** Evictable frames of T1 and T2, least recently used first. */
+  std::set<EvictionKey> t1_evictable_;
+  std::set<EvictionKey> t2_evictable_;
+  /** Ghost lists of pages evicted from T1 and T2. */
+  GhostList b1_;
+  GhostList b2_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+
+/**
+ * BufferAccessStrategy lets a bulk operation, such as a sequential scan over a large table or a large insert, recycle
+ * a small private ring of frames instead of competing for the whole buffer pool. Pages that miss in the buffer pool
+ * are loaded into the next frame of the ring; once the ring wraps around, the page in that frame is evicted again if
+ * nobody else has it pinned. Pages that are already cached are used in place and do not enter the ring. This way a
+ * scan that touches every page once leaves the rest of the pool, e.g. hot index pages, alone.
+ *
+ * A strategy keeps one ring per buffer pool instance, sized to at most an eighth of that instance, and is meant to be
+ * used by a single executor at a time: it is not thread-safe.
+ */
+class BufferAccessStrategy {
+ public:
+  /** The kind of bulk access, which determines the default ring size. */
+  enum class Type { BULK_READ, BULK_WRITE };
+
+  /** Marks a ring slot that has no frame yet. */
+  static constexpr frame_id_t EMPTY_SLOT = -1;
+
+  /**
+   * Creates a new BufferAccessStrategy.
+   * @param type the kind of bulk access
+   * @param ring_size the maximum number of frames in the ring of each buffer pool instance
+   */
+  BufferAccessStrategy(Type type, size_t ring_size) : type_(type), ring_size_(ring_size) {}
+
+  /** @return the default ring size for the given kind of bulk access */
+  static auto DefaultRingSize(Type type) -> size_t {
+    return type == Type::BULK_READ ? BULK_READ_RING_SIZE : BULK_WRITE_RING_SIZE;
+  }
+
+  /** @return the kind of bulk access */
+  auto GetType() const -> Type { return type_; }
+
+  /** @return the maximum number of frames in the ring of each buffer pool instance */
+  auto GetRingSize() const -> size_t { return ring_size_; }
+
+  /**
+   * Moves the ring of a buffer pool instance to its next slot.
+   * @param bpm the buffer pool instance owning the ring
+   * @param pool_size the number of frames of that instance, which bounds the ring size
+   * @return the frame in the new current slot, or EMPTY_SLOT if the slot has not been filled yet
+   */
+  auto Advance(const BufferPoolManager *bpm, size_t pool_size) -> frame_id_t;
+
+  /**
+   * Puts a frame into the current slot of the ring of a buffer pool instance, replacing the frame that was there.
+   * @param bpm the buffer pool instance owning the ring
+   * @param frame_id the frame to remember
+   */
+  void SetCurrent(const BufferPoolManager *bpm, frame_id_t frame_id);
+
+ private:
+  /** The frames of one buffer pool instance that this strategy recycles. */
+  struct Ring {
+    std::vector<frame_id_t> frames_;
+    size_t current_{0};
+  };
+
+  /** The kind of bulk access. */
+  Type type_;
+  /** The maximum number of frames per ring. */
+  size_t ring_size_;
+  /** The ring of each buffer pool instance the strategy has been used with. */
+  std::unordered_map<const BufferPoolManager *, Ring> rings_;
+};
+
+}  // namespace bustub
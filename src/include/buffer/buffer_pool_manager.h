@@ -15,7 +15,10 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -78,15 +81,141 @@ class BufferPoolManager {
   }
 
   /** Grading function. Do not modify! */
-  void FlushAllPages(bufferpool_callback_fn callback = nullptr) {
+  auto FlushAllPages(bufferpool_callback_fn callback = nullptr) -> FlushStats {
     GradingCallback(callback, CallbackType::BEFORE, INVALID_PAGE_ID);
-    FlushAllPgsImp();
+    auto stats = FlushAllPgsImp();
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
+    return stats;
   }
 
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /** @return size of the pages, which is the page size of the database */
+  virtual auto GetPageSize() -> size_t { return BUSTUB_PAGE_SIZE; }
+
+  /**
+   * @return how many page ids of the default tablespace were handed out so far, deleted pages included; 0 for a new
+   * database. The default implementation does not keep track and returns 0.
+   */
+  virtual auto GetNumPages() -> size_t { return 0; }
+
+  /**
+   * Grows or shrinks the buffer pool to the given number of frames while it is in use. Growing adds empty frames;
+   * shrinking writes back and drops the pages held by the removed frames, waiting for them to be unpinned. The
+   * default implementation does not support resizing.
+   * @param pool_size the new number of frames, at least 1
+   * @return false if the pool could not be resized, e.g. because the frames to remove stayed pinned
+   */
+  virtual auto Resize([[maybe_unused]] size_t pool_size) -> bool { return false; }
+
+  /**
+   * Fetches a page like FetchPage(), but on a miss loads it into the private ring of the given strategy instead of an
+   * arbitrary frame of the pool. The default implementation ignores the strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the buffer access strategy of the caller, or nullptr to use the whole pool
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  virtual auto FetchPageWithStrategy(page_id_t page_id, [[maybe_unused]] BufferAccessStrategy *strategy) -> Page * {
+    return FetchPage(page_id);
+  }
+
+  /**
+   * Creates a new page like NewPage(), but places it into the private ring of the given strategy. The default
+   * implementation ignores the strategy.
+   * @param[out] page_id id of created page
+   * @param strategy the buffer access strategy of the caller, or nullptr to use the whole pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual auto NewPageWithStrategy(page_id_t *page_id, [[maybe_unused]] BufferAccessStrategy *strategy) -> Page * {
+    return NewPage(page_id);
+  }
+
+  /**
+   * Creates a new page like NewPageWithStrategy(), in the given tablespace. The default implementation only supports
+   * the DEFAULT_TABLESPACE.
+   * @param[out] page_id id of created page
+   * @param tablespace_id the tablespace to allocate the page in
+   * @param strategy the buffer access strategy of the caller, or nullptr to use the whole pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual auto NewPageInTablespace(page_id_t *page_id, tablespace_id_t tablespace_id, BufferAccessStrategy *strategy)
+      -> Page * {
+    return tablespace_id == DEFAULT_TABLESPACE ? NewPageWithStrategy(page_id, strategy) : nullptr;
+  }
+
+  /**
+   * Reserves a run of contiguous page ids in a tablespace and preallocates it on disk. A table heap or an index fills
+   * the run in order with NewPageAt(), so that its pages end up next to each other in the file, and scans of it turn
+   * into large sequential reads. Reserved ids that are never used are lost. The default implementation does not
+   * support extents.
+   * @param tablespace_id the tablespace to reserve the pages in
+   * @param num_pages number of pages in the run
+   * @return the id of the first page of the run, or INVALID_PAGE_ID if no run could be reserved
+   */
+  virtual auto AllocateExtent([[maybe_unused]] tablespace_id_t tablespace_id, [[maybe_unused]] size_t num_pages)
+      -> page_id_t {
+    return INVALID_PAGE_ID;
+  }
+
+  /**
+   * Creates a new page like NewPageWithStrategy(), with an id that was reserved by AllocateExtent() and not used
+   * before. The default implementation does not support extents.
+   * @param page_id the reserved id of the new page
+   * @param strategy the buffer access strategy of the caller, or nullptr to use the whole pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual auto NewPageAt([[maybe_unused]] page_id_t page_id, [[maybe_unused]] BufferAccessStrategy *strategy)
+      -> Page * {
+    return nullptr;
+  }
+
+  /**
+   * Creates a tablespace through the disk manager, see DiskManager::CreateTablespace(). The default implementation
+   * keeps everything in the DEFAULT_TABLESPACE.
+   * @return the id of the new tablespace
+   */
+  virtual auto CreateTablespace() -> tablespace_id_t { return DEFAULT_TABLESPACE; }
+
+  /**
+   * Asks the buffer pool to read the given pages ahead of use. Prefetching is only a hint: the call returns right
+   * away, the pages are loaded in the background and left unpinned and evictable, and pages that are already
+   * resident, not allocated yet, or do not fit into the pool are skipped. The default implementation does nothing.
+   * @param page_ids ids of the pages that are expected to be fetched soon, in the order they will be fetched
+   */
+  virtual void PrefetchPages([[maybe_unused]] const std::vector<page_id_t> &page_ids) {}
+
+  /**
+   * Adds up the counters of the buffer pool: fetch hits and misses, new pages, evictions, flushes, and the time spent
+   * waiting on the latch and in disk I/O. The counters only ever grow. The default implementation counts nothing.
+   * @return a snapshot of the counters
+   */
+  virtual auto GetStats() -> BufferPoolStats { return {}; }
+
+  /**
+   * Lists the pages that may have changes not on disk yet: the dirty pages, and the pinned ones, whose changes are
+   * only marked when they are unpinned, and the evicted pages whose write-back is in flight. A checkpoint writes them
+   * back with FlushPages(). The default implementation lists none.
+   * @return the ids of the pages
+   */
+  virtual auto GetDirtyPages() -> std::vector<page_id_t> { return {}; }
+
+  /**
+   * Writes back the given pages that are still resident and dirty or pinned, as one batch followed by a sync. Every
+   * change its writer finished under the page's write latch before the call is on disk when it returns, including
+   * changes to pages that are still pinned. The default implementation flushes the pages one by one.
+   * @param page_ids ids of the pages to write back
+   * @return the number of pages written and of runs of adjacent page ids among them
+   */
+  virtual auto FlushPages(const std::vector<page_id_t> &page_ids) -> FlushStats {
+    FlushStats stats;
+    for (auto page_id : page_ids) {
+      stats.pages_written_ += FlushPage(page_id) ? 1 : 0;
+    }
+    stats.runs_ = stats.pages_written_;
+    return stats;
+  }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -138,8 +267,9 @@ class BufferPoolManager {
   virtual auto DeletePgImp(page_id_t page_id) -> bool = 0;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the dirty pages in the buffer pool to disk.
+   * @return the number of pages written and of runs they were coalesced into
    */
-  virtual void FlushAllPgsImp() = 0;
+  virtual auto FlushAllPgsImp() -> FlushStats = 0;
 };
 }  // namespace bustub
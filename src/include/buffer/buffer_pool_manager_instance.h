@@ -12,16 +12,25 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
+#include <memory>
 #include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/frame_chunk.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "container/hash/extendible_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/tablespace.h"
+#include "storage/page/free_page_bitmap_page.h"
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -37,9 +46,24 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_type the replacement policy
    */
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU_K);
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_type the replacement policy
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU_K);
 
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
@@ -49,8 +73,162 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the size (number of frames) of the buffer pool. */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
-  /** @brief Return the pointer to all the pages in the buffer pool. */
-  auto GetPages() -> Page * { return pages_; }
+  /** @brief Return the size of the pages, taken from the disk manager. */
+  auto GetPageSize() -> size_t override { return page_size_; }
+
+  /** @brief Return how many page ids of the default tablespace this instance handed out, from the high-water mark. */
+  auto GetNumPages() -> size_t override {
+    return static_cast<size_t>(next_page_id_ - static_cast<page_id_t>(instance_index_)) / num_instances_;
+  }
+
+  /**
+   * @brief Return the pointer to the frames the buffer pool was created with. Frames added by Resize() live in separate
+   * chunks and are not part of this array.
+   */
+  auto GetPages() -> Page * { return chunks_.front().second->GetPages(); }
+
+  /**
+   * @brief Grow or shrink the buffer pool while it is in use, one chunk of BUFFER_POOL_CHUNK_SIZE frames at a time.
+   *
+   * Growing allocates the new frames without holding the latch and then adds them to the free list. Shrinking
+   * withdraws the frames with the highest ids: free frames leave the free list, dirty pages are written back, and
+   * resident pages are dropped once they are unpinned. Memory is released once a whole chunk has been withdrawn; the
+   * frames of the initial chunk stay allocated as spare frames for the next grow. Fetches are blocked at most for the
+   * book-keeping of one chunk, never for its I/O.
+   *
+   * @param pool_size the new number of frames, at least 1
+   * @return false if some frames stayed pinned for longer than buffer_pool_withdraw_timeout. The pool then keeps the
+   * chunks it could not withdraw.
+   */
+  auto Resize(size_t pool_size) -> bool override;
+
+  /**
+   * @brief Start the background page cleaner. Every page_cleaner_interval, or sooner when an eviction had to write
+   * back a dirty victim, the cleaner writes back dirty unpinned pages until at least clean_ratio of the evictable
+   * frames are clean. Pages are written in page id order so that the writes are sequential on disk.
+   * @param clean_ratio fraction of evictable frames to keep clean, between 0 and 1
+   */
+  void StartPageCleaner(double clean_ratio = PAGE_CLEANER_CLEAN_RATIO);
+
+  /** @brief Stop the background page cleaner and wait for it to exit. Does nothing if it is not running. */
+  void StopPageCleaner();
+
+  /**
+   * @brief Queue pages to be read in by the background prefetcher, which is started on first use. Each page is loaded
+   * into a frame from the free list or the replacer, its access is recorded, and it is left unpinned. At most pool_size
+   * requests are queued; the rest are dropped.
+   * @param page_ids ids of the pages to prefetch
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * @brief Fetch a page, loading it into the ring of the given strategy on a miss. FetchPage() is the same call
+   * without a strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the buffer access strategy of the caller, or nullptr to use the whole pool
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * @brief Create a new page in the ring of the given strategy. NewPage() is the same call without a strategy.
+   * @param[out] page_id id of created page
+   * @param strategy the buffer access strategy of the caller, or nullptr to use the whole pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * @brief Create a new page in the given tablespace. Pages of other tablespaces than the default one are allocated
+   * past the end of the tablespace's file and never reused; their space is given back by dropping the tablespace.
+   * @param[out] page_id id of created page
+   * @param tablespace_id the tablespace to allocate the page in
+   * @param strategy the buffer access strategy of the caller, or nullptr to use the whole pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPageInTablespace(page_id_t *page_id, tablespace_id_t tablespace_id, BufferAccessStrategy *strategy)
+      -> Page * override;
+
+  /**
+   * @brief Reserve and preallocate a run of contiguous page ids. Only a stand-alone instance can do this by itself;
+   * in a ParallelBufferPoolManager a run spans all instances, which reserve their share with ReserveExtent().
+   * @return the id of the first page of the run, or INVALID_PAGE_ID if this instance is part of a parallel pool or
+   * the tablespace is full
+   */
+  auto AllocateExtent(tablespace_id_t tablespace_id, size_t num_pages) -> page_id_t override;
+
+  /**
+   * @brief Create a new page with an id reserved by AllocateExtent(). If a prefetch already read the reserved page, its
+   * frame is reused.
+   */
+  auto NewPageAt(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /** @return the lowest page id of the tablespace above every id this instance has handed out or reserved */
+  auto NextUnallocatedPageId(tablespace_id_t tablespace_id) -> page_id_t;
+
+  /**
+   * @brief Reserve the page ids of this instance within the run [first_page_id, first_page_id + num_pages), and skip
+   * the ones between the last allocated id and the run. Skipped ids of the default tablespace are marked free, so
+   * that they are reused. Fails if this instance already handed out an id at or past first_page_id.
+   * @return true if the ids were reserved
+   */
+  auto ReserveExtent(page_id_t first_page_id, size_t num_pages) -> bool;
+
+  /**
+   * @brief First half of a flush of the whole pool: pin every page that needs writing, wait for its I/O, clear its
+   * dirty flag and copy it under its read latch. Also writes out the free page bitmap, like every write of new pages.
+   * The pages stay pinned until FinishFlush().
+   * @param[out] copies the buffer holding the copies; it must outlive the write
+   * @return the ids and copied data of the pinned pages
+   */
+  auto PinPagesToFlush(std::vector<char> *copies) -> std::vector<std::pair<page_id_t, const char *>>;
+
+  /**
+   * @brief Second half of a flush of the whole pool: unpin the pages written, count them, and persist the free page
+   * bitmap with the exact high-water mark.
+   * @param pages the pages returned by PinPagesToFlush()
+   * @param write_ns the time spent writing them
+   */
+  void FinishFlush(const std::vector<std::pair<page_id_t, const char *>> &pages, uint64_t write_ns);
+
+  /**
+   * @brief Instead of FinishFlush() when the write failed: mark the pages dirty again and unpin them.
+   * @param pages the pages returned by PinPagesToFlush()
+   */
+  void AbortFlush(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /**
+   * @brief Sort pages by id and write them with one DiskManager::WritePages().
+   * @param disk_manager the disk manager to write with
+   * @param[in,out] pages the pages to write; sorted on return
+   * @param[out] write_ns the time spent writing
+   * @return the number of pages and of runs of adjacent page ids among them
+   */
+  static auto WriteSortedPages(DiskManager *disk_manager, std::vector<std::pair<page_id_t, const char *>> *pages,
+                               uint64_t *write_ns) -> FlushStats;
+
+  /** @brief Create a tablespace with the disk manager. */
+  auto CreateTablespace() -> tablespace_id_t override { return disk_manager_->CreateTablespace(); }
+
+  /** @return the number of evictions whose victim was clean, i.e. did not need to be written back */
+  auto GetCleanEvictions() const -> size_t { return counters_.Snapshot().clean_evictions_; }
+
+  /** @return the number of evictions whose victim was dirty and had to be written back first */
+  auto GetDirtyEvictions() const -> size_t { return counters_.Snapshot().dirty_evictions_; }
+
+  /** @return a snapshot of the counters of this instance */
+  auto GetStats() -> BufferPoolStats override { return counters_.Snapshot(); }
+
+  /** @return the ids of the resident pages that are dirty or pinned, and of evicted ones still being written back */
+  auto GetDirtyPages() -> std::vector<page_id_t> override;
+
+  /**
+   * @brief Write back the given pages that are resident and dirty or pinned. The pages are pinned and their dirty
+   * flags cleared, then each is copied under its read latch, so that the copy holds every change whose writer
+   * released the latch and no half-done one, and the copies are written sorted by page id with one Sync(). A write-back
+   * of one of the pages by an eviction is waited for, so that the Sync() covers it as well.
+   */
+  auto FlushPages(const std::vector<page_id_t> &page_ids) -> FlushStats override;
 
  protected:
   /**
@@ -111,7 +289,7 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @brief Flush the target page to disk.
    *
    * Use the DiskManager::WritePage() method to flush a page to disk, REGARDLESS of the dirty flag.
-   * Unset the dirty flag of the page after flushing.
+   * Unset the dirty flag of the page after flushing. The page is made durable with DiskManager::SyncRange().
    *
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
@@ -121,9 +299,10 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush the dirty pages in the buffer pool to disk as one batch, sorted by page id so that adjacent pages
+   * go out as one large write, followed by a single DiskManager::Sync(). Clean pages are skipped.
    */
-  void FlushAllPgsImp() override;
+  auto FlushAllPgsImp() -> FlushStats override;
 
   /**
    * TODO(P1): Add implementation
@@ -140,20 +319,172 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
-  auto GetFrame(frame_id_t *frame_id) -> bool;
+  /**
+   * @brief Pick a frame for a new page. With a strategy, the frame in the next slot of its ring is recycled if it is
+   * unused; otherwise the frame comes from the free list first and then from the replacer, and enters the ring.
+   * Caller must hold the latch. The evicted page, if any, goes through EvictFrame().
+   * @param[out] frame_id the picked frame
+   * @param[out] writeback_page_id id of the dirty page that still has to be written back, or INVALID_PAGE_ID
+   * @param strategy the buffer access strategy of the caller, or nullptr
+   * @return false if all frames are pinned
+   */
+  auto GetFrame(frame_id_t *frame_id, page_id_t *writeback_page_id, BufferAccessStrategy *strategy) -> bool;
+
+  /**
+   * @brief Remove the page held by a frame that has been taken out of the replacer. The page leaves the page table
+   * right away; if it is dirty it is recorded in writeback_frames_ and its id is returned, and the caller has to write
+   * it back with FillFrame(). Caller must hold the latch.
+   * @param frame_id the frame to evict
+   * @param[out] writeback_page_id id of the dirty page that still has to be written back; untouched if it is clean
+   */
+  void EvictFrame(frame_id_t frame_id, page_id_t *writeback_page_id);
+
+  /**
+   * @brief Finish installing a page into a frame returned by GetFrame(). Writes back the evicted page (if any) and then
+   * reads the new page from disk or zeroes it. The latch is released during the disk I/O and reacquired before
+   * returning; the frame is marked READY and its waiters are woken up.
+   * @param frame_id the frame to fill, already pinned and registered in the page table under its new page id
+   * @param writeback_page_id id of the evicted dirty page, or INVALID_PAGE_ID
+   * @param read_from_disk true to read the new page from disk, false to zero it
+   * @param lock the held buffer pool latch
+   * @throws Exception if the write-back failed; the evicted page is back in the frame, dirty, and the new page is not
+   * in the buffer pool. The caller's pin on the frame is released.
+   */
+  void FillFrame(frame_id_t frame_id, page_id_t writeback_page_id, bool read_from_disk,
+                 std::unique_lock<std::mutex> &lock);
+
+  /**
+   * @brief FillFrame() for several frames at once: all evicted pages are written back as one batch, then all new pages
+   * are read as one batch. If the write-back fails, every frame with an evicted page gets it back as in FillFrame(),
+   * and the other frames are filled before the error is rethrown.
+   * @param frames the frames to fill, each with the id of its evicted page that has to be written back, or
+   * INVALID_PAGE_ID
+   */
+  void FillFrames(const std::vector<std::pair<frame_id_t, page_id_t>> &frames, bool read_from_disk,
+                  std::unique_lock<std::mutex> &lock);
+
+  /**
+   * @brief Undo the installation of a new page into a frame after the write-back of the page evicted from it failed:
+   * make the evicted page resident and dirty again, wake up the waiters and release the installer's pin. The caller
+   * must hold the latch and have taken the evicted page out of writeback_frames_.
+   */
+  void RestoreEvictedPage(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * @brief Block until the frame is READY. The caller must hold the latch and a pin on the frame.
+   * @return false if the frame does not hold the page anymore, because its installation was undone; the caller still
+   * has to release its pin
+   */
+  auto WaitForFrame(frame_id_t frame_id, page_id_t page_id, std::unique_lock<std::mutex> &lock) -> bool;
+
+  /** @brief Block until page_id is no longer being written back by an eviction. The caller must hold the latch. */
+  void WaitForWriteBack(page_id_t page_id, std::unique_lock<std::mutex> &lock);
+
+  /** @brief Pin a resident frame and record the access. The caller must hold the latch. */
+  void PinFrame(frame_id_t frame_id);
+
+  /** @brief Unpin a resident frame, making it evictable once the pin count drops to zero. Caller must hold the latch. */
+  void UnpinFrame(frame_id_t frame_id);
+
+  /**
+   * @brief Write a resident page to disk with the latch released. The frame is pinned for the duration of the write,
+   * and what is written is a copy of the page taken under its read latch. If the write throws, the page stays dirty.
+   * @return false if the page is not in the page table
+   */
+  auto WriteBackPage(page_id_t page_id, std::unique_lock<std::mutex> &lock) -> bool;
 
   auto GetPage(frame_id_t frame_id) -> Page *;
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
-  /** The next page id to be allocated  */
+
+  /** @brief Acquire the latch, adding the time spent waiting for it to the stats. */
+  auto AcquireLatch() -> std::unique_lock<std::mutex>;
+
+  /** @brief Read a page from disk, adding the read to the stats. Must not be called with the latch held. */
+  void ReadPageFromDisk(page_id_t page_id, char *page_data);
+
+  /**
+   * @brief Write a page to disk, adding the write to the stats. The free page bitmap is synced first. Must not be
+   * called with the latch held.
+   */
+  void WritePageToDisk(page_id_t page_id, const char *page_data);
+
+  /** @brief ReadPageFromDisk() for several pages, submitted to the disk manager as one batch. */
+  void ReadPagesFromDisk(const std::vector<std::pair<page_id_t, char *>> &pages);
+
+  /** @brief WritePageToDisk() for several pages, submitted to the disk manager as one batch. */
+  void WritePagesToDisk(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /**
+   * @brief Write-ahead logging: make the log durable up to the newest page LSN of the pages before they are written.
+   * Only records that were appended are flushed, so this does nothing while logging is off, except during recovery.
+   */
+  void FlushLogForPages(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /**
+   * @brief Copy pinned pages under their read latches, so that a flush never writes a page in the middle of a change.
+   * Must not be called with the latch held.
+   * @param pinned the pages to copy
+   * @param[out] copies the buffer holding the copies
+   * @return the ids and copied data of the pages
+   */
+  auto CopyPinnedPages(const std::vector<Page *> &pinned, std::vector<char> *copies)
+      -> std::vector<std::pair<page_id_t, const char *>>;
+
+  /**
+   * @brief Take the frames [begin, end) out of use: remove them from the free list, write back their dirty pages and
+   * drop their pages once they are unpinned. Caller must hold the latch, which is released while waiting.
+   * @return false on timeout, in which case the frames withdrawn so far are put back on the free list
+   */
+  auto WithdrawFrames(size_t begin, size_t end, std::unique_lock<std::mutex> &lock) -> bool;
+
+  /** @brief Main loop of the prefetcher thread. */
+  void PrefetchLoop();
+
+  /**
+   * @brief Install a page into a frame for prefetching unless it is resident, being written back, or not allocated.
+   * The frame stays pinned until the caller has filled it with FillFrames() and unpinned it. The caller must hold the
+   * latch.
+   * @param[out] frames the frame and the page it evicted are appended here if the page is installed
+   * @return false if there is no frame to install the page into
+   */
+  auto PrefetchPage(page_id_t page_id, std::vector<std::pair<frame_id_t, page_id_t>> *frames) -> bool;
+
+  /** @brief Main loop of the page cleaner thread. */
+  void PageCleanerLoop();
+
+  /**
+   * @brief Write back dirty unpinned pages, lowest page id first, until clean_ratio_ of the evictable frames are clean.
+   * The pages are pinned while the latch is released for the writes, which write copies taken under the page latches.
+   * The caller must hold the latch.
+   */
+  void CleanPages(std::unique_lock<std::mutex> &lock);
+  /** Number of frames in use by the buffer pool. Only changed by Resize(), with the latch held. */
+  std::atomic<size_t> pool_size_;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
+  /**
+   * The lowest page id that has never been allocated. Each instance only hands out ids congruent to instance_index_.
+   * Only changed under allocator_latch_.
+   */
   std::atomic<page_id_t> next_page_id_ = 0;
+  /** Size of the pages of the database, and of the frames */
+  const size_t page_size_;
   /** Bucket size for the extendible hash table */
   const size_t bucket_size_ = 4;
 
   std::unordered_set<page_id_t> pages_set_;
 
-  /** Array of buffer pool pages. */
-  Page *pages_;
+  /**
+   * Memory of the buffer pool frames, with the id of the first frame of each chunk. The first chunk holds the frames
+   * the pool was created with; Resize() adds and frees the others. Page data is aligned for direct I/O. Protected by
+   * the latch.
+   */
+  std::vector<std::pair<frame_id_t, std::unique_ptr<FrameChunk>>> chunks_;
+  /** Every allocated frame by frame id. Frames at or above pool_size_ are spare and not in use. Protected by the latch. */
+  std::vector<Page *> frames_;
+  /** Serializes Resize() calls. */
+  std::mutex resize_latch_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. Please ignore this for P1. */
@@ -161,26 +492,135 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** Page table for keeping track of buffer pool pages. */
   ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
   /** Replacer to find unpinned pages for replacement. */
-  LRUKReplacer *replacer_;
+  Replacer *replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * Dirty pages evicted from the page table whose write-back is still in flight, mapped to the frame holding them.
+   * A fetch of such a page waits on that frame until the write-back is done, so it never reads a stale page from disk.
+   */
+  std::unordered_map<page_id_t, frame_id_t> writeback_frames_;
+  /**
+   * This latch protects the page table, the free list, the replacer, writeback_frames_ and the book-keeping fields of
+   * every page (pin count, dirty flag, page id and I/O state). It is never held during disk I/O.
+   */
   std::mutex latch_;
 
+  /** The background page cleaner, if started. */
+  std::thread page_cleaner_;
+  /** True while the page cleaner should keep running. Protected by the latch. */
+  bool page_cleaner_running_ = false;
+  /** Fraction of evictable frames the page cleaner keeps clean. Protected by the latch. */
+  double clean_ratio_ = PAGE_CLEANER_CLEAN_RATIO;
+  /** Wakes up the page cleaner early, either to stop it or because an eviction found a dirty victim. */
+  std::condition_variable page_cleaner_cv_;
+  /** The background prefetcher, started by the first PrefetchPages() call. */
+  std::thread prefetcher_;
+  /** True while the prefetcher should keep running. Protected by the latch. */
+  bool prefetcher_running_ = false;
+  /** Pages waiting to be prefetched. Protected by the latch. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** Wakes up the prefetcher when pages are queued or when it should stop. */
+  std::condition_variable prefetch_cv_;
+  /** Per-thread counters behind GetStats(). */
+  BufferPoolCounters counters_;
+
+  /**
+   * Free page bitmap of this instance, one entry per bitmap page. Bitmap page n is stored as page
+   * n * num_instances_ + instance_index_ of the free space map. Protected by allocator_latch_.
+   */
+  std::vector<std::unique_ptr<FreePageBitmapPage>> free_page_bitmap_;
+  /** Bitmap pages changed since they were last written. Protected by allocator_latch_. */
+  std::vector<bool> free_page_bitmap_dirty_;
+  /** Whether any bitmap page is dirty, so that page writes only take the allocator latch when there is work to do. */
+  std::atomic<bool> free_page_bitmap_changed_{false};
+  /** Protects the page allocator. Acquired after the latch, never before it. */
+  std::mutex allocator_latch_;
+  /** Next block to allocate in each tablespace other than the default one. Protected by the allocator_latch_. */
+  std::unordered_map<tablespace_id_t, page_id_t> next_blocks_;
+  /** Serializes writes of the free page bitmap, so that an older copy of a bitmap page never overwrites a newer one. */
+  std::mutex free_page_bitmap_io_latch_;
+
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Allocate a page on disk: the lowest deallocated page id of this instance, or a new one past the
+   * high-water mark. The allocation only reaches the free space map with the next SyncFreePageBitmap(), which happens
+   * before any page is written. Caller should acquire the latch before calling this function.
    * @return the id of the allocated page
    */
   auto AllocatePage() -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
-   * @param page_id id of the page to deallocate
+   * @brief Allocate a block of this instance in a tablespace other than the default one. Caller should acquire the
+   * latch before calling this function.
+   * @return the id of the allocated page
+   */
+  auto AllocateTablespacePage(tablespace_id_t tablespace_id) -> page_id_t;
+
+  /**
+   * @brief The next block this instance allocates in the tablespace. Allocation resumes past the end of the
+   * tablespace's file, so a page that was allocated but never written before a crash may be handed out again, like
+   * any page that was never referenced. Caller should hold the allocator_latch_.
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
+  auto NextTablespaceBlock(tablespace_id_t tablespace_id) -> page_id_t &;
+
+  /** @return the lowest block of this instance at or after the given one */
+  auto RoundUpToInstance(page_id_t block) const -> page_id_t {
+    return block + static_cast<page_id_t>((instance_index_ + num_instances_ - block % num_instances_) % num_instances_);
   }
 
+  /**
+   * @brief Register a newly created page in a frame returned by GetFrame() and zero it. Caller holds the latch.
+   * @return the pinned page
+   */
+  auto InstallNewPage(page_id_t page_id, frame_id_t frame_id, page_id_t writeback_page_id,
+                      std::unique_lock<std::mutex> &lock) -> Page *;
+
+  /** @return true if the page id was handed out by this instance and may be on disk */
+  auto IsAllocated(page_id_t page_id) -> bool;
+
+  /**
+   * @brief Read the free page bitmap of this instance from the free space map and restore the high-water mark. Pages
+   * allocated after the last persisted high-water mark may be lost in a crash, so allocation resumes past it.
+   */
+  void LoadFreePageBitmap();
+
+  /** @brief Write the changed bitmap pages to the free space map. Must not be called with the latch held. */
+  void WriteFreePageBitmap();
+
+  /**
+   * @brief Write the free page bitmap if it changed. Called before every page write, so that a page never reaches disk
+   * ahead of its allocation: otherwise a crash could hand out its page id again. Must not be called with the latch held.
+   */
+  void SyncFreePageBitmap();
+
+  /** @return the page id in the given slot of this instance's bitmap */
+  auto SlotToPageId(uint32_t slot) const -> page_id_t {
+    return static_cast<page_id_t>(slot * num_instances_ + instance_index_);
+  }
+
+  /** @return the slot of the given page id in this instance's bitmap */
+  auto PageIdToSlot(page_id_t page_id) const -> uint32_t {
+    return static_cast<uint32_t>(page_id) / num_instances_;
+  }
+
+  /**
+   * @brief Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
+   * validate input data and ensure that a parallel BPM is routing requests to the correct BPI
+   * @param page_id
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /**
+   * @brief Deallocate a page on disk by marking it free in the bitmap, so that AllocatePage() hands it out again. The
+   * change is written lazily, with the next allocation or FlushAllPages(); if it is lost, the page just stays unused.
+   * Caller should acquire the latch before calling this function.
+   * @param page_id id of the page to deallocate
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /** @brief Mark a page id of the default tablespace free in the bitmap. Caller should hold the allocator_latch_. */
+  void MarkPageFree(page_id_t page_id);
+
   // TODO(student): You may add additional private members and helper functions
 };
 }  // namespace bustub
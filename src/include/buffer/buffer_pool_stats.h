@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolStats is a snapshot of the counters of a buffer pool. Times are in nanoseconds.
+ */
+struct BufferPoolStats {
+  /** FetchPage calls that found the page resident. */
+  uint64_t fetch_hits_{0};
+  /** FetchPage calls that had to read the page from disk. */
+  uint64_t fetch_misses_{0};
+  /** Pages created by NewPage. */
+  uint64_t new_pages_{0};
+  /** Evictions whose victim was clean. */
+  uint64_t clean_evictions_{0};
+  /** Evictions whose victim was dirty and had to be written back first. */
+  uint64_t dirty_evictions_{0};
+  /** Pages written by FlushPage, FlushAllPages, the page cleaner and resizing, i.e. not by an eviction. */
+  uint64_t flushes_{0};
+  /** Pages read from disk. */
+  uint64_t disk_reads_{0};
+  /** Pages written to disk. */
+  uint64_t disk_writes_{0};
+  /** Time spent waiting to acquire the buffer pool latch. */
+  uint64_t latch_wait_ns_{0};
+  /** Time spent in disk reads. */
+  uint64_t disk_read_ns_{0};
+  /** Time spent in disk writes. */
+  uint64_t disk_write_ns_{0};
+
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+    fetch_hits_ += other.fetch_hits_;
+    fetch_misses_ += other.fetch_misses_;
+    new_pages_ += other.new_pages_;
+    clean_evictions_ += other.clean_evictions_;
+    dirty_evictions_ += other.dirty_evictions_;
+    flushes_ += other.flushes_;
+    disk_reads_ += other.disk_reads_;
+    disk_writes_ += other.disk_writes_;
+    latch_wait_ns_ += other.latch_wait_ns_;
+    disk_read_ns_ += other.disk_read_ns_;
+    disk_write_ns_ += other.disk_write_ns_;
+    return *this;
+  }
+
+  /** @return the fraction of fetches that were hits, or 0 if there were no fetches */
+  auto HitRatio() const -> double {
+    const uint64_t fetches = fetch_hits_ + fetch_misses_;
+    return fetches == 0 ? 0 : static_cast<double>(fetch_hits_) / static_cast<double>(fetches);
+  }
+
+  /** @return the counters as (name, value) pairs, in the order `SHOW buffer_pool_stats` prints them */
+  auto ToRows() const -> std::vector<std::pair<std::string, std::string>> {
+    return {{"fetch_hits", std::to_string(fetch_hits_)},
+            {"fetch_misses", std::to_string(fetch_misses_)},
+            {"hit_ratio", std::to_string(HitRatio())},
+            {"new_pages", std::to_string(new_pages_)},
+            {"clean_evictions", std::to_string(clean_evictions_)},
+            {"dirty_evictions", std::to_string(dirty_evictions_)},
+            {"flushes", std::to_string(flushes_)},
+            {"disk_reads", std::to_string(disk_reads_)},
+            {"disk_writes", std::to_string(disk_writes_)},
+            {"latch_wait_us", std::to_string(latch_wait_ns_ / 1000)},
+            {"disk_read_us", std::to_string(disk_read_ns_ / 1000)},
+            {"disk_write_us", std::to_string(disk_write_ns_ / 1000)}};
+  }
+};
+
+/**
+ * FlushStats tells what a FlushAllPages() wrote.
+ */
+struct FlushStats {
+  /** Dirty pages written. */
+  uint64_t pages_written_{0};
+  /** Runs of adjacent page ids the pages were coalesced into; a disk manager writes each with one vectored write. */
+  uint64_t runs_{0};
+
+  auto operator+=(const FlushStats &other) -> FlushStats & {
+    pages_written_ += other.pages_written_;
+    runs_ += other.runs_;
+    return *this;
+  }
+};
+
+/**
+ * BufferPoolCounters holds the live counters of a buffer pool. They are split into BUFFER_POOL_STATS_SLOTS
+ * cache-line-sized slots and every thread updates only its own slot, so that counting does not bounce a shared cache
+ * line between cores. Threads are assigned slots round-robin; past BUFFER_POOL_STATS_SLOTS threads, slots are shared,
+ * which is why the counters are still atomic. Snapshot() adds up all slots.
+ */
+class BufferPoolCounters {
+ public:
+  /** The counters of one slot, updated with relaxed atomics. */
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> fetch_hits_{0};
+    std::atomic<uint64_t> fetch_misses_{0};
+    std::atomic<uint64_t> new_pages_{0};
+    std::atomic<uint64_t> clean_evictions_{0};
+    std::atomic<uint64_t> dirty_evictions_{0};
+    std::atomic<uint64_t> flushes_{0};
+    std::atomic<uint64_t> disk_reads_{0};
+    std::atomic<uint64_t> disk_writes_{0};
+    std::atomic<uint64_t> latch_wait_ns_{0};
+    std::atomic<uint64_t> disk_read_ns_{0};
+    std::atomic<uint64_t> disk_write_ns_{0};
+  };
+
+  /** Adds the given amount to one counter of a slot. The add is uncontended unless threads share the slot. */
+  static void Add(std::atomic<uint64_t> &counter, uint64_t amount = 1) {
+    counter.fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  /** @return the slot of the calling thread */
+  auto Local() -> Slot & { return slots_[ThreadSlot()]; }
+
+  /** @return the sum of all slots; concurrent updates may or may not be included */
+  auto Snapshot() const -> BufferPoolStats {
+    BufferPoolStats stats;
+    for (const auto &slot : slots_) {
+      stats.fetch_hits_ += slot.fetch_hits_.load(std::memory_order_relaxed);
+      stats.fetch_misses_ += slot.fetch_misses_.load(std::memory_order_relaxed);
+      stats.new_pages_ += slot.new_pages_.load(std::memory_order_relaxed);
+      stats.clean_evictions_ += slot.clean_evictions_.load(std::memory_order_relaxed);
+      stats.dirty_evictions_ += slot.dirty_evictions_.load(std::memory_order_relaxed);
+      stats.flushes_ += slot.flushes_.load(std::memory_order_relaxed);
+      stats.disk_reads_ += slot.disk_reads_.load(std::memory_order_relaxed);
+      stats.disk_writes_ += slot.disk_writes_.load(std::memory_order_relaxed);
+      stats.latch_wait_ns_ += slot.latch_wait_ns_.load(std::memory_order_relaxed);
+      stats.disk_read_ns_ += slot.disk_read_ns_.load(std::memory_order_relaxed);
+      stats.disk_write_ns_ += slot.disk_write_ns_.load(std::memory_order_relaxed);
+    }
+    return stats;
+  }
+
+ private:
+  static auto ThreadSlot() -> size_t {
+    static std::atomic<size_t> next_slot{0};
+    thread_local const size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % BUFFER_POOL_STATS_SLOTS;
+    return slot;
+  }
+
+  std::array<Slot, BUFFER_POOL_STATS_SLOTS> slots_;
+};
+
+}  // namespace bustub
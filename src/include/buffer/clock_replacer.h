@@ -12,7 +12,6 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
 #include <vector>
 
@@ -23,6 +22,11 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every access sets the reference bit of a frame. To find a victim, the clock hand sweeps over the frames: an
+ * evictable frame with its reference bit set gets a second chance and has the bit cleared, and the first evictable
+ * frame found with a clear bit is evicted. Accesses cost O(1) and take no ordering structure at all, which makes
+ * CLOCK the cheapest policy to maintain.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -37,16 +41,32 @@ class ClockReplacer : public Replacer {
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  void Resize(size_t num_frames) override;
+
  private:
-  // TODO(student): implement me!
+  /** Book-keeping of one frame. */
+  struct FrameInfo {
+    bool live_{false};
+    bool evictable_{false};
+    bool referenced_{false};
+  };
+
+  std::mutex latch_;
+  std::vector<FrameInfo> frames_;
+  /** The frame the clock hand points at. */
+  size_t hand_{0};
+  /** Number of evictable frames. */
+  size_t size_{0};
 };
 
 }  // namespace bustub
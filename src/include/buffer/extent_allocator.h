@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.h
+//
+// Identification: src/include/buffer/extent_allocator.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ExtentAllocator creates the pages of one table heap or index. Instead of taking page ids one at a time from the
+ * buffer pool, where concurrent tables and indexes interleave, it reserves runs (extents) of contiguous page ids with
+ * BufferPoolManager::AllocateExtent() and fills them in order. The pages of a table then lie next to each other on
+ * disk, so that a sequential scan or a walk along the leaves of an index reads large contiguous ranges, which the OS
+ * and the buffer pool read-ahead can serve with a few large reads.
+ *
+ * If the buffer pool does not support extents, pages are created one at a time as before. The unused rest of the
+ * current extent is lost when the allocator is destroyed, e.g. on restart.
+ */
+class ExtentAllocator {
+ public:
+  /**
+   * @param bpm the buffer pool to create the pages in
+   * @param tablespace_id the tablespace to create the pages in
+   * @param extent_size number of pages to reserve at a time
+   */
+  ExtentAllocator(BufferPoolManager *bpm, tablespace_id_t tablespace_id, size_t extent_size = EXTENT_SIZE)
+      : bpm_(bpm), tablespace_id_(tablespace_id), extent_size_(extent_size) {}
+
+  /**
+   * Creates a new page, pinned, at the next page id of the current extent. Thread-safe.
+   * @param[out] page_id id of created page
+   * @param strategy the buffer access strategy of the caller, or nullptr to use the whole pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id, BufferAccessStrategy *strategy = nullptr) -> Page *;
+
+  /**
+   * Gives back a page from NewPage() that was not used: unpins it and keeps its id for the next NewPage(), so that the
+   * extent stays in one piece. Without extents, the page is deleted. Thread-safe.
+   * @param page_id id of the page, which the caller has pinned once and not changed
+   */
+  void ReleasePage(page_id_t page_id);
+
+  /** @return the tablespace the pages are created in */
+  auto GetTablespaceId() const -> tablespace_id_t { return tablespace_id_; }
+
+ private:
+  /** @return a page id of the current extent, a new extent, or INVALID_PAGE_ID if there are no extents */
+  auto TakePageId() -> page_id_t;
+
+  /** The current extent packs the next unused page id and the end of the extent into one word. */
+  static auto MakeExtent(page_id_t next_page_id, page_id_t end_page_id) -> uint64_t {
+    return static_cast<uint64_t>(static_cast<uint32_t>(end_page_id)) << 32 | static_cast<uint32_t>(next_page_id);
+  }
+  static auto NextOf(uint64_t extent) -> page_id_t { return static_cast<page_id_t>(extent & UINT32_MAX); }
+  static auto EndOf(uint64_t extent) -> page_id_t { return static_cast<page_id_t>(extent >> 32); }
+
+  BufferPoolManager *bpm_;
+  tablespace_id_t tablespace_id_;
+  size_t extent_size_;
+  /** Next unused page id and end of the current extent, see MakeExtent(). Empty at first. */
+  std::atomic<uint64_t> extent_{0};
+  /** Protects reserving a new extent and the returned page ids. */
+  std::mutex latch_;
+  /** Page ids taken from an extent whose page could not be created, to be used before a new extent. */
+  std::vector<page_id_t> returned_page_ids_;
+};
+
+}  // namespace bustub
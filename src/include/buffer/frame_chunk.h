@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_chunk.h
+//
+// Identification: src/include/buffer/frame_chunk.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * FrameChunk owns a run of buffer pool frames. The page data of all its frames is one anonymous memory mapping, so
+ * every frame starts on an OS page boundary and can be handed to the kernel for direct (O_DIRECT) I/O. With huge pages
+ * requested, the mapping is aligned to and advised for transparent huge pages, which saves TLB misses in large pools
+ * where the OS supports them.
+ */
+class FrameChunk {
+ public:
+  /**
+   * Allocates the frames and their zeroed page data.
+   * @param num_frames number of frames, at least 1
+   * @param huge_pages whether to back the page data with transparent huge pages
+   * @param page_size the size of the page data of a frame
+   */
+  FrameChunk(size_t num_frames, bool huge_pages, size_t page_size = BUSTUB_PAGE_SIZE);
+
+  ~FrameChunk();
+
+  FrameChunk(const FrameChunk &) = delete;
+  auto operator=(const FrameChunk &) -> FrameChunk & = delete;
+
+  /** @return the frames of the chunk */
+  auto GetPages() -> Page * { return pages_.get(); }
+
+  /** @return the number of frames */
+  auto Size() const -> size_t { return num_frames_; }
+
+ private:
+  size_t num_frames_;
+  std::unique_ptr<Page[]> pages_;
+  /** The mapping; larger than the page data when it had to be aligned for huge pages. */
+  void *map_;
+  size_t map_size_;
+};
+
+}  // namespace bustub
@@ -15,11 +15,11 @@
 #include <limits>
 #include <list>
 #include <mutex>  // NOLINT
-#include <queue>
-#include <unordered_map>
-#include <unordered_set>
+#include <set>
+#include <utility>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
@@ -36,7 +36,7 @@ namespace bustub {
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -54,7 +54,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    * TODO(P1): Add implementation
@@ -72,7 +72,7 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
@@ -85,7 +85,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame that received a new access.
    */
-  void RecordAccess(frame_id_t frame_id);
+  void RecordAccess(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -104,7 +104,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -123,7 +123,14 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
+
+  /**
+   * @brief Change the number of frames the replacer can track. Frames at or above num_frames must not be in the
+   * replacer when it shrinks.
+   * @param num_frames the new number of frames
+   */
+  void Resize(size_t num_frames) override;
   /**
    * TODO(P1): Add implementation
    *
@@ -131,7 +138,7 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
   auto Creattime() -> size_t;
   auto Addstamp(frame_id_t frame_id) -> void;
 
@@ -156,7 +163,7 @@ class LRUKReplacer {
       evictable_ = false;
       live_ = false;
     }
-    void Add(int time) {
+    void Add(size_t time) {
       time_[pos_] = time;
       pos_ = (pos_ + 1) % max_k_;
       size_++;
@@ -172,19 +179,28 @@ class LRUKReplacer {
   };
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  [[maybe_unused]] size_t current_timestamp_{0};
-  // [[maybe_unused]] size_t curr_size_{0};
-  [[maybe_unused]] size_t replacer_size_;
-  [[maybe_unused]] size_t k_;
+  /** An entry of the eviction order: the timestamp the frame is ordered by, and the frame itself. */
+  using EvictionKey = std::pair<size_t, frame_id_t>;
+
+  size_t current_timestamp_{0};
+  size_t replacer_size_;
+  size_t k_;
   std::vector<Frameinfo> timestamp_;
-  std::unordered_set<frame_id_t> max_replacers_;
-  std::unordered_set<frame_id_t> nomax_replacers_;
+  /**
+   * Evictable frames with k recorded accesses, ordered by their k-th most recent access. The first entry has the
+   * largest backward k-distance.
+   */
+  std::set<EvictionKey> max_replacers_;
+  /**
+   * Evictable frames with fewer than k recorded accesses (+inf backward k-distance), ordered by their earliest access
+   * so that the first entry is the classical LRU victim.
+   */
+  std::set<EvictionKey> nomax_replacers_;
   std::mutex latch_;
   void AddReplacers(frame_id_t frame_id);
   void DelReplacers(frame_id_t frame_id);
   auto InMaxReplacers(frame_id_t frame_id) -> bool;
   auto InNoMaxReplacers(frame_id_t frame_id) -> bool;
 };
+
 }  // namespace bustub
@@ -12,8 +12,9 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
+#include <set>
+#include <utility>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -22,7 +23,8 @@
 namespace bustub {
 
 /**
- * LRUReplacer implements the Least Recently Used replacement policy.
+ * LRUReplacer implements the Least Recently Used replacement policy: it evicts the evictable frame whose last access
+ * is the oldest.
  */
 class LRUReplacer : public Replacer {
  public:
@@ -37,16 +39,31 @@ class LRUReplacer : public Replacer {
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  void Resize(size_t num_frames) override;
+
  private:
-  // TODO(student): implement me!
+  /** Book-keeping of one frame. */
+  struct FrameInfo {
+    size_t last_access_{0};
+    bool live_{false};
+    bool evictable_{false};
+  };
+
+  std::mutex latch_;
+  size_t current_timestamp_{0};
+  std::vector<FrameInfo> frames_;
+  /** Evictable frames ordered by their last access, least recently used first. */
+  std::set<std::pair<size_t, frame_id_t>> evictable_frames_;
 };
 
 }  // namespace bustub
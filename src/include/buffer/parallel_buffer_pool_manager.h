@@ -0,0 +1,210 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/config.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager spreads pages over several independent BufferPoolManagerInstances. Page ids are sharded
+ * by `page_id % num_instances`, so each instance owns its own page table, free list, replacer and latch, and requests
+ * for pages living in different instances never contend with each other.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of each instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU_K);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, summed over all instances */
+  auto GetPoolSize() -> size_t override;
+
+  /** @return size of the pages, the same in all instances */
+  auto GetPageSize() -> size_t override { return disk_manager_->GetPageSize(); }
+
+  /** @return how many page ids of the default tablespace were handed out, summed over all instances */
+  auto GetNumPages() -> size_t override;
+
+  /**
+   * Resizes every instance, spreading the frames as evenly as possible. Instances are resized one after another, so
+   * only the instance being resized is blocked at a time.
+   * @param pool_size the new total number of frames, at least the number of instances
+   * @return false if pool_size is too small or an instance could not be resized
+   */
+  auto Resize(size_t pool_size) -> bool override;
+
+  /** @return the number of BufferPoolManagerInstances */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /**
+   * Fetches a page from the instance owning it, using that instance's ring of the strategy on a miss.
+   * @param page_id id of page to be fetched
+   * @param strategy the buffer access strategy of the caller, or nullptr to use the whole pool
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Creates a new page like NewPgImp(), in the ring of the strategy of whichever instance creates it.
+   * @param[out] page_id id of created page
+   * @param strategy the buffer access strategy of the caller, or nullptr to use the whole pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Creates a new page in the given tablespace, in whichever instance has a frame for it.
+   * @param[out] page_id id of created page
+   * @param tablespace_id the tablespace to allocate the page in
+   * @param strategy the buffer access strategy of the caller, or nullptr to use the whole pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPageInTablespace(page_id_t *page_id, tablespace_id_t tablespace_id, BufferAccessStrategy *strategy)
+      -> Page * override;
+
+  /**
+   * Reserves a run of contiguous page ids. Since consecutive page ids belong to different instances, every instance
+   * reserves its share of the run; the run starts past the last id any instance has handed out. If an instance hands
+   * out a page inside the run in the meantime, the run moves further on.
+   * @param tablespace_id the tablespace to reserve the pages in
+   * @param num_pages number of pages in the run
+   * @return the id of the first page of the run, or INVALID_PAGE_ID if the tablespace is full
+   */
+  auto AllocateExtent(tablespace_id_t tablespace_id, size_t num_pages) -> page_id_t override;
+
+  /** Creates a reserved page in the instance that owns its id. */
+  auto NewPageAt(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override {
+    return GetBufferPoolManager(page_id)->NewPageAt(page_id, strategy);
+  }
+
+  /** Creates a tablespace with the disk manager all instances share. */
+  auto CreateTablespace() -> tablespace_id_t override { return instances_.front()->CreateTablespace(); }
+
+  /**
+   * Forwards the prefetch requests to the instances owning the pages.
+   * @param page_ids ids of the pages to prefetch
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * Starts the background page cleaner of every instance.
+   * @param clean_ratio fraction of evictable frames each instance keeps clean
+   */
+  void StartPageCleaner(double clean_ratio = PAGE_CLEANER_CLEAN_RATIO);
+
+  /** Stops the background page cleaner of every instance. */
+  void StopPageCleaner();
+
+  /** @return the number of evictions with a clean victim, summed over all instances */
+  auto GetCleanEvictions() const -> size_t;
+
+  /** @return the number of evictions with a dirty victim, summed over all instances */
+  auto GetDirtyEvictions() const -> size_t;
+
+  /** @return the counters of all instances, summed up */
+  auto GetStats() -> BufferPoolStats override;
+
+  /** @return the dirty or pinned pages of all instances */
+  auto GetDirtyPages() -> std::vector<page_id_t> override;
+
+  /** Forwards the pages to the instances owning them, each of which writes its share as one batch. */
+  auto FlushPages(const std::vector<page_id_t> &page_ids) -> FlushStats override;
+
+ protected:
+  /**
+   * Fetch the requested page from the buffer pool.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Creates a new page in the buffer pool. Instances are tried in a round robin manner: the starting instance moves
+   * forward by one on every call, so that consecutive allocations do not all land on the same instance. If the
+   * starting instance has no free or evictable frame, the following instances are tried in turn.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * Deletes a page from the buffer pool.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Flushes the dirty pages of all instances to disk. The pages of all instances are sorted and written together,
+   * since adjacent page ids belong to different instances, followed by a single DiskManager::Sync().
+   */
+  auto FlushAllPgsImp() -> FlushStats override;
+
+ private:
+  /** The sharded buffer pool instances. Instance i owns every page id with `page_id % num_instances == i`. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** The instance NewPgImp starts probing from on its next call. */
+  std::atomic<size_t> next_instance_{0};
+  /** The disk manager all instances share. */
+  DiskManager *disk_manager_;
+  /** Serializes AllocateExtent(), so that concurrent reservations do not keep pushing each other on. */
+  std::mutex extent_latch_;
+};
+
+}  // namespace bustub
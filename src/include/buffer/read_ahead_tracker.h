@@ -0,0 +1,46 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_tracker.h
+//
+// Identification: src/include/buffer/read_ahead_tracker.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ReadAheadTracker follows the page-to-page moves of a scan over linked pages, such as a table heap or the leaves of a
+ * B+ tree. Once READ_AHEAD_TRIGGER moves in a row had the same positive stride, it asks the buffer pool to prefetch
+ * the next READ_AHEAD_PAGES pages along that stride, and refills the window whenever the scan has used half of it.
+ */
+class ReadAheadTracker {
+ public:
+  /**
+   * Records that the scan moved from one page to the next, and issues read-ahead if the scan looks sequential.
+   * @param buffer_pool_manager the buffer pool to prefetch into
+   * @param from_page_id the page the scan left
+   * @param to_page_id the page the scan moved to
+   */
+  void OnPageChange(BufferPoolManager *buffer_pool_manager, page_id_t from_page_id, page_id_t to_page_id);
+
+ private:
+  /** Stride of the last move. */
+  page_id_t stride_{0};
+  /** Number of moves in a row with stride_. */
+  int run_length_{0};
+  /** Last page id that has been prefetched, or INVALID_PAGE_ID if the current run has not prefetched anything yet. */
+  page_id_t prefetched_until_{INVALID_PAGE_ID};
+};
+
+}  // namespace bustub
@@ -12,12 +12,18 @@
 
 #pragma once
 
+#include <memory>
+
 #include "common/config.h"
 
 namespace bustub {
 
 /**
- * Replacer is an abstract class that tracks page usage.
+ * Replacer is an abstract class that tracks frame usage and picks the frame to evict when the buffer pool is full.
+ *
+ * Every frame in the replacer is either evictable or not. A frame enters the replacer on its first recorded access
+ * as non-evictable, becomes evictable when the buffer pool unpins it, and leaves the replacer when it is evicted or
+ * removed. Size() counts the evictable frames only.
  */
 class Replacer {
  public:
@@ -25,26 +31,63 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
-   * @return true if a victim frame was found, false otherwise
+   * Evict a frame as defined by the replacement policy. Only evictable frames are candidates. The evicted frame
+   * leaves the replacer.
+   * @param[out] frame_id id of frame that was evicted
+   * @return true if a frame was evicted, false if no frame is evictable
+   */
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * Record an access to the page held by a frame, e.g. a buffer pool hit.
+   * @param frame_id the id of the accessed frame
+   */
+  virtual void RecordAccess(frame_id_t frame_id) = 0;
+
+  /**
+   * Record that a page has just been loaded into a frame, which counts as its first access. Policies that remember
+   * recently evicted pages (2Q, ARC) use the page id to recognize pages coming back; the default implementation just
+   * records an access.
+   * @param frame_id the id of the frame the page was loaded into
+   * @param page_id the id of the loaded page
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual void RecordLoad(frame_id_t frame_id, [[maybe_unused]] page_id_t page_id) { RecordAccess(frame_id); }
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Toggle whether a frame may be evicted. Does nothing if the frame is not in the replacer.
+   * @param frame_id the id of the frame
+   * @param set_evictable whether the frame is evictable
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Remove an evictable frame from the replacer along with its history, e.g. because its page was deleted. Unlike
+   * Evict(), the page is not remembered as recently evicted. Does nothing if the frame is not in the replacer.
+   * @param frame_id the id of the frame to remove
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
-  /** @return the number of elements in the replacer that can be victimized */
+  /** @return the number of evictable frames */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * Change the number of frames tracked by the replacer, when the buffer pool grows or shrinks. Before shrinking, the
+   * buffer pool removes every frame at or above the new size from the replacer.
+   * @param num_frames the new number of frames
+   */
+  virtual void Resize(size_t num_frames) = 0;
 };
 
+/** The replacement policies a buffer pool can be configured with. */
+enum class ReplacerType { LRU_K, LRU, CLOCK, TWO_Q, ARC };
+
+/**
+ * Creates a replacer.
+ * @param replacer_type the replacement policy
+ * @param num_frames the number of frames of the buffer pool
+ * @param k the lookback constant of LRU-K; ignored by the other policies
+ * @return the new replacer
+ */
+auto MakeReplacer(ReplacerType replacer_type, size_t num_frames, size_t k) -> std::unique_ptr<Replacer>;
+
 }  // namespace bustub
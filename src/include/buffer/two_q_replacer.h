@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.h
+//
+// Identification: src/include/buffer/two_q_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * TwoQReplacer implements the full 2Q replacement policy (Johnson and Shasha, VLDB 1994).
+ *
+ * Pages loaded for the first time enter A1in, a FIFO queue that is not reordered by further accesses. While A1in
+ * holds more than a quarter of the frames, victims are taken from it, and their page ids are remembered in A1out, a
+ * ghost queue of up to half as many pages as there are frames. A page that is loaded again while it is in A1out has
+ * proven to be reused and enters Am, which is managed as LRU. A sequential scan therefore only cycles through A1in and
+ * never pushes the pages in Am out.
+ */
+class TwoQReplacer : public Replacer {
+ public:
+  /**
+   * Create a new TwoQReplacer.
+   * @param num_frames the maximum number of frames the TwoQReplacer will be required to store
+   */
+  explicit TwoQReplacer(size_t num_frames);
+
+  ~TwoQReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void RecordLoad(frame_id_t frame_id, page_id_t page_id) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  void Resize(size_t num_frames) override;
+
+ private:
+  /** The queue a frame is in. */
+  enum class Queue { NONE, A1IN, AM };
+
+  /** Book-keeping of one frame. */
+  struct FrameInfo {
+    Queue queue_{Queue::NONE};
+    /** Load time for A1in, last access time for Am. */
+    size_t key_{0};
+    bool evictable_{false};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** An entry of the eviction order of a queue: the timestamp the frame is ordered by, and the frame itself. */
+  using EvictionKey = std::pair<size_t, frame_id_t>;
+
+  /** @return the evictable frames of the given queue */
+  auto EvictableFrames(Queue queue) -> std::set<EvictionKey> & {
+    return queue == Queue::A1IN ? a1in_evictable_ : am_evictable_;
+  }
+
+  void LoadLocked(frame_id_t frame_id, page_id_t page_id);
+
+  /** Maximum number of frames in A1in before it gives up frames. */
+  size_t kin_;
+  /** Maximum number of page ids remembered in A1out. */
+  size_t kout_;
+  std::mutex latch_;
+  size_t current_timestamp_{0};
+  std::vector<FrameInfo> frames_;
+  /** Number of frames in A1in, evictable or not. */
+  size_t a1in_size_{0};
+  /** Evictable frames of A1in in load order. */
+  std::set<EvictionKey> a1in_evictable_;
+  /** Evictable frames of Am, least recently used first. */
+  std::set<EvictionKey> am_evictable_;
+  /** Page ids recently evicted from A1in, most recent first. */
+  std::list<page_id_t> a1out_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> a1out_index_;
+};
+
+}  // namespace bustub
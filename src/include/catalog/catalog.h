@@ -136,7 +136,8 @@ class Catalog {
     // When create_table_heap == false, it means that we're running binder tests (where no txn will be provided) or
     // we are running shell without buffer pool. We don't need to create TableHeap in this case.
     if (create_table_heap) {
-      table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+      const tablespace_id_t tablespace_id = file_per_table ? bpm_->CreateTablespace() : DEFAULT_TABLESPACE;
+      table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn, tablespace_id);
     }
 
     // Fetch the table OID for the new table
@@ -226,7 +227,10 @@ class Catalog {
     // just the key, value, and comparator types
 
     // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    const tablespace_id_t tablespace_id =
+        file_per_table && bpm_ != nullptr ? bpm_->CreateTablespace() : DEFAULT_TABLESPACE;
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
+                                                                                      tablespace_id);
 
     // Populate the index with all tuples in table heap
     auto *table_meta = GetTable(table_name);
@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "catalog/catalog.h"
 #include "common/config.h"
 #include "common/util/string_util.h"
@@ -210,10 +211,29 @@ class BustubInstance {
    */
   auto MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext>;
 
+  /**
+   * Keep page 0 for the header page of the database, which holds the page size and the roots of the B+ tree indexes,
+   * so that it never becomes a table or index page. A new database allocates it; a reopened one must have it.
+   * @throws Exception if page 0 of a reopened database is not a header page, as in databases of older versions
+   */
+  void ReserveHeaderPage();
+
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Create a BusTub instance on a database file.
+   * @param db_file_name the database file
+   * @param replacer_type the replacement policy of the buffer pool
+   * @param page_size page size of the database if it is created, see DiskManager
+   */
+  explicit BustubInstance(const std::string &db_file_name, ReplacerType replacer_type = ReplacerType::LRU_K,
+                          size_t page_size = BUSTUB_PAGE_SIZE);
 
-  BustubInstance();
+  /**
+   * Create a BusTub instance on an in-memory disk.
+   * @param replacer_type the replacement policy of the buffer pool
+   * @param page_size page size of the database, see DiskManager
+   */
+  explicit BustubInstance(ReplacerType replacer_type = ReplacerType::LRU_K, size_t page_size = BUSTUB_PAGE_SIZE);
 
   ~BustubInstance();
 
@@ -266,10 +286,20 @@ class BustubInstance {
     return variable == "1" || variable == "true" || variable == "yes";
   }
 
+  /** @return false if the session commits asynchronously, after `SET synchronous_commit = off` */
+  auto IsSynchronousCommit() -> bool {
+    auto variable = StringUtil::Lower(GetSessionVariable("synchronous_commit"));
+    return variable != "0" && variable != "false" && variable != "no" && variable != "off";
+  }
+
  private:
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
+  /** Handles `SHOW buffer_pool_stats` by printing the counters of the buffer pool, one per row. */
+  void CmdDisplayBufferPoolStats(ResultWriter &writer);
+  /** Handles `SET buffer_pool_size = N` by resizing the buffer pool to N frames. */
+  void ResizeBufferPool(const std::string &value);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
   std::unordered_map<std::string, std::string> session_variables_;
 };
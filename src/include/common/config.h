@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -27,18 +28,56 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** A transaction that commits without waiting for the log is durable at most this long (and one log write) later. */
+extern std::chrono::milliseconds async_commit_lag;
+
+/** Number of BufferPoolManagerInstances a BusTub instance shards its buffer pool into. 1 disables sharding. */
+extern std::atomic<size_t> buffer_pool_instances;
+
+/** How often the buffer pool page cleaner wakes up to write back dirty pages ahead of eviction. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
+/** How long shrinking the buffer pool waits for the frames it removes to be unpinned before giving up. */
+extern std::chrono::milliseconds buffer_pool_withdraw_timeout;
+
+/** True if buffer pools allocated from now on should back their frames with transparent huge pages. */
+extern std::atomic<bool> buffer_pool_huge_pages;
+
+/** True if tables and indexes created from now on should get a tablespace (database file) of their own. */
+extern std::atomic<bool> file_per_table;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
-static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_PAGE_SIZE = 4096;  // default and smallest page size of a database, in bytes
+static constexpr int BUSTUB_MAX_PAGE_SIZE = 65536;  // largest page size a database can be created with
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr double PAGE_CLEANER_CLEAN_RATIO = 0.25;  // fraction of evictable frames the page cleaner keeps clean
+static constexpr int READ_AHEAD_TRIGGER = 2;  // equal page-to-page strides in a row before a scan issues read-ahead
+static constexpr int READ_AHEAD_PAGES = 8;    // number of pages a scan reads ahead
+static constexpr int BULK_READ_RING_SIZE = 32;   // frames in the private ring of a bulk read (sequential scan)
+static constexpr int BULK_WRITE_RING_SIZE = 64;  // frames in the private ring of a bulk write (insert)
+static constexpr int BUFFER_POOL_CHUNK_SIZE = 128;  // frames added or removed at a time when resizing the buffer pool
+static constexpr int PAGE_ALLOCATION_BATCH = 64;  // new page ids covered by one persisted allocator high-water mark
+static constexpr int EXTENT_SIZE = 64;  // contiguous pages a table heap or index reserves at a time
+static constexpr int BUFFER_POOL_STATS_SLOTS = 16;  // per-thread counter slots of a buffer pool instance
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;     // I/Os an AsyncDiskManager keeps in flight at most
+static constexpr int ASYNC_IO_FALLBACK_THREADS = 4;  // I/O threads of an AsyncDiskManager without io_uring
+static constexpr int TABLESPACE_BLOCK_BITS = 23;  // low bits of a page id that number the page within its tablespace
+static constexpr int MAX_TABLESPACES = 256;  // database files; their ids take the page id bits above the block number
+static constexpr int DEFAULT_TABLESPACE = 0;  // tablespace of the main database file
+static constexpr int RECOVERY_THREADS = 8;  // threads that redo pages and undo transactions at restart
+static constexpr int RECOVERY_LOG_READ_SIZE = 1 << 20;  // bytes of the log that recovery reads at once
+static constexpr int LOG_INSERT_SLOTS = 64;  // log appenders that copy their records into the log buffer at once
+static constexpr int CHECKPOINT_FLUSH_BATCH = 64;  // pages a checkpoint writes back at once, between which it yields
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
+using tablespace_id_t = uint32_t;  // tablespace id type
 using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
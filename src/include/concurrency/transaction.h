@@ -192,6 +192,16 @@ class Transaction {
   /** @return the isolation level of this transaction */
   inline auto GetIsolationLevel() const -> IsolationLevel { return isolation_level_; }
 
+  /** @return true if the commit of this transaction waits until its COMMIT record is durable */
+  inline auto IsSynchronousCommit() const -> bool { return synchronous_commit_; }
+
+  /**
+   * Choose whether the commit waits for the log. An asynchronous commit returns as soon as its COMMIT record is in the
+   * log buffer and becomes durable within async_commit_lag, so a crash can lose it even though it returned.
+   * @param synchronous_commit true to wait for the log on commit, which is the default
+   */
+  inline void SetSynchronousCommit(bool synchronous_commit) { synchronous_commit_ = synchronous_commit; }
+
   /** @return the list of table write records of this transaction */
   inline auto GetWriteSet() -> std::shared_ptr<std::deque<TableWriteRecord>> { return table_write_set_; }
 
@@ -332,13 +342,15 @@ class Transaction {
   std::thread::id thread_id_;
   /** The ID of this transaction. */
   txn_id_t txn_id_;
+  /** Whether the commit waits until the COMMIT record is durable. */
+  bool synchronous_commit_{true};
 
   /** The undo set of table tuples. */
   std::shared_ptr<std::deque<TableWriteRecord>> table_write_set_;
   /** The undo set of indexes. */
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
-  /** The LSN of the last record written by the transaction. */
-  lsn_t prev_lsn_;
+  /** The LSN of the last record written by the transaction; a checkpoint reads it from another thread. */
+  std::atomic<lsn_t> prev_lsn_;
 
   std::mutex latch_;
 
@@ -13,9 +13,12 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>  // NOLINT
 #include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
@@ -30,6 +33,15 @@ class LockManager;
  */
 class TransactionManager {
  public:
+  /** A transaction that is running while logging is on, as a checkpoint records it. */
+  struct ActiveTransaction {
+    txn_id_t txn_id_;
+    /** LSN of the last log record of the transaction */
+    lsn_t last_lsn_;
+    /** offset of the BEGIN record of the transaction in the log file */
+    int64_t begin_log_offset_;
+  };
+
   explicit TransactionManager(LockManager *lock_manager, LogManager *log_manager = nullptr)
       : lock_manager_(lock_manager), log_manager_(log_manager) {}
 
@@ -45,11 +57,20 @@ class TransactionManager {
       -> Transaction *;
 
   /**
-   * Commits a transaction.
+   * Commits a transaction. Unless the transaction commits asynchronously, this returns only once the commit is
+   * durable.
    * @param txn the transaction to commit
+   * @throws Exception if the log could not be written; the transaction has ended and released its locks regardless
    */
   void Commit(Transaction *txn);
 
+  /**
+   * Waits until the log is durable up to the given LSN, e.g. to fence on asynchronous commits: after
+   * WaitForLSN(txn->GetPrevLSN()) the commit of txn survives a crash. Returns right away if logging is off.
+   * @param lsn the LSN that has to be durable
+   */
+  void WaitForLSN(lsn_t lsn);
+
   /**
    * Aborts a transaction
    * @param txn the transaction to abort
@@ -77,6 +98,13 @@ class TransactionManager {
     return res;
   }
 
+  /**
+   * Lists the transactions that wrote a BEGIN record and did not commit or abort yet. Unlike txn_map, this only holds
+   * running transactions, so a fuzzy checkpoint can read them while they keep running.
+   * @return the running transactions
+   */
+  auto GetActiveTransactions() -> std::vector<ActiveTransaction>;
+
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
 
@@ -84,6 +112,9 @@ class TransactionManager {
   void ResumeTransactions();
 
  private:
+  /** Removes a committed or aborted transaction from active_txns_; the caller may delete it afterwards. */
+  void EndActiveTransaction(Transaction *txn);
+
   /**
    * Releases all the locks held by the given transaction.
    * @param txn the transaction whose locks should be released
@@ -136,10 +167,15 @@ class TransactionManager {
 
   std::atomic<txn_id_t> next_txn_id_{0};
   LockManager *lock_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
+
+  /** Protects active_txns_. */
+  std::mutex active_txns_latch_;
+  /** The running transactions that write log records, and the offset of their BEGIN record in the log file. */
+  std::unordered_map<txn_id_t, std::pair<Transaction *, int64_t>> active_txns_;
 };
 
 }  // namespace bustub
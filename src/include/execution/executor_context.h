@@ -12,10 +12,12 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
@@ -51,6 +53,26 @@ class ExecutorContext {
   /** @return the buffer pool manager */
   auto GetBufferPoolManager() -> BufferPoolManager * { return bpm_; }
 
+  /**
+   * Creates a buffer access strategy for an executor that reads or writes a table in bulk. The strategy is owned by
+   * this context and lives as long as the query.
+   * @param type the kind of bulk access
+   * @return a new buffer access strategy with the default ring size for type
+   */
+  auto MakeBufferAccessStrategy(BufferAccessStrategy::Type type) -> BufferAccessStrategy * {
+    return strategies_
+        .emplace_back(std::make_unique<BufferAccessStrategy>(type, BufferAccessStrategy::DefaultRingSize(type)))
+        .get();
+  }
+
+  /**
+   * Like PostgreSQL, only tables larger than a quarter of the buffer pool are accessed through a ring; smaller ones
+   * are cached in the pool as usual, so that repeated scans of them stay in memory.
+   * @param num_pages the number of pages of the table
+   * @return true if an executor accessing the whole table should use its buffer access strategy
+   */
+  auto IsBulkAccess(size_t num_pages) const -> bool { return num_pages > bpm_->GetPoolSize() / 4; }
+
   /** @return the log manager - don't worry about it for now */
   auto GetLogManager() -> LogManager * { return nullptr; }
 
@@ -71,6 +93,8 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The buffer access strategies created by the executors of this query */
+  std::vector<std::unique_ptr<BufferAccessStrategy>> strategies_;
 };
 
 }  // namespace bustub
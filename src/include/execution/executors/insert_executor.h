@@ -59,6 +59,8 @@ class InsertExecutor : public AbstractExecutor {
   const InsertPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_executor_;
   bool has_output_{false};
+  /** The ring of frames used once the table has grown too large to be cached in the buffer pool */
+  BufferAccessStrategy *strategy_;
 };
 
 }  // namespace bustub
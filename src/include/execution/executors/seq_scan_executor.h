@@ -51,5 +51,7 @@ class SeqScanExecutor : public AbstractExecutor {
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableIterator it_ = TableIterator(nullptr, bustub::RID(), nullptr);
+  /** The ring of frames used when the table is too large to be cached in the buffer pool */
+  BufferAccessStrategy *strategy_;
 };
 }  // namespace bustub
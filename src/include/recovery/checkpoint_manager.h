@@ -12,6 +12,10 @@
 
 #pragma once
 
+#include <exception>
+#include <thread>  // NOLINT
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction_manager.h"
 #include "recovery/log_manager.h"
@@ -19,25 +23,61 @@
 namespace bustub {
 
 /**
- * CheckpointManager creates consistent checkpoints by blocking all other transactions temporarily.
+ * CheckpointManager creates fuzzy checkpoints, which do not stop the transactions.
+ *
+ * BeginCheckpoint() appends a BEGIN_CHECKPOINT record, takes the pages that may have changes not on disk at that
+ * point, and leaves it to a background thread to write them back, CHECKPOINT_FLUSH_BATCH pages at a time, while the
+ * transactions keep running. EndCheckpoint() waits for the writes, then appends END_CHECKPOINT records with the
+ * active transaction table and the dirty page table, flushes the log and points the master record at the checkpoint.
+ *
+ * Since every change logged before the BEGIN_CHECKPOINT record is on disk by then, redo starts there; the recLSN of
+ * every page still dirty is at least the LSN of that record. Undo needs the records of the transactions that were
+ * running, so recovery reads the log from the BEGIN record of the oldest of them, or the checkpoint, whichever comes
+ * first. The log before that is not needed anymore.
  */
 class CheckpointManager {
  public:
+  /**
+   * @param transaction_manager the transaction manager, for the active transaction table
+   * @param log_manager the log manager to append the checkpoint records with
+   * @param buffer_pool_manager the buffer pool to write back
+   * @param disk_manager the disk manager that keeps the master record
+   */
   CheckpointManager(TransactionManager *transaction_manager, LogManager *log_manager,
-                    BufferPoolManager *buffer_pool_manager)
+                    BufferPoolManager *buffer_pool_manager, DiskManager *disk_manager)
       : transaction_manager_(transaction_manager),
         log_manager_(log_manager),
-        buffer_pool_manager_(buffer_pool_manager) {}
+        buffer_pool_manager_(buffer_pool_manager),
+        disk_manager_(disk_manager) {}
 
-  ~CheckpointManager() = default;
+  /** Waits for the writes of a checkpoint that was begun and not ended. */
+  ~CheckpointManager();
 
+  /** Start a checkpoint and the background writes of its pages. Logging must be on. */
   void BeginCheckpoint();
+
+  /** Wait for the writes of the checkpoint, then complete it. Rethrows the error if a write failed. */
   void EndCheckpoint();
 
+  /** @return the LSN of the BEGIN_CHECKPOINT record of the last checkpoint begun, or INVALID_LSN */
+  auto GetCheckpointLSN() const -> lsn_t { return begin_lsn_; }
+
  private:
-  TransactionManager *transaction_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** Write back the pages in batches; the loop of the background thread. */
+  void FlushPages(std::vector<page_id_t> page_ids);
+
+  TransactionManager *transaction_manager_;
+  LogManager *log_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  DiskManager *disk_manager_;
+
+  /** The BEGIN_CHECKPOINT record of the checkpoint in progress, or of the last one. */
+  lsn_t begin_lsn_{INVALID_LSN};
+  int64_t begin_log_offset_{0};
+  /** Writes back the pages of the checkpoint in progress. */
+  std::thread flush_thread_;
+  /** The error that stopped flush_thread_, if any; EndCheckpoint() rethrows it. */
+  std::exception_ptr flush_error_;
 };
 
 }  // namespace bustub
@@ -13,9 +13,15 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <condition_variable>  // NOLINT
-#include <future>              // NOLINT
-#include <mutex>               // NOLINT
+#include <cstdint>
+#include <exception>
+#include <future>  // NOLINT
+#include <limits>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,50 +31,162 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * The log buffer is a ring that appenders fill without a lock. The insertion point of the log, the next LSN and the
+ * byte position of the next record, is packed into one atomic word, so an appender claims its LSN and its bytes with
+ * a single fetch_add and then copies its record in, in parallel with all other appenders. While it does, it
+ * advertises its position in one of LOG_INSERT_SLOTS insertion slots. The flush thread only writes out the log up to
+ * the lowest position still advertised, i.e. over the contiguous region of completed records, and persistent_lsn_
+ * advances with it. Every write and sync covers all records completed since the previous one, so commits that wait
+ * for the log at the same time share a sync (group commit). Appenders only wait when the ring is full.
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-    flush_buffer_ = new char[LOG_BUFFER_SIZE];
-  }
+  explicit LogManager(DiskManager *disk_manager);
 
-  ~LogManager() {
-    delete[] log_buffer_;
-    delete[] flush_buffer_;
-    log_buffer_ = nullptr;
-    flush_buffer_ = nullptr;
-  }
+  ~LogManager();
 
   void RunFlushThread();
   void StopFlushThread();
 
   auto AppendLogRecord(LogRecord *log_record) -> lsn_t;
 
-  inline auto GetNextLSN() -> lsn_t { return next_lsn_; }
+  /**
+   * Make the log durable up to and including the given LSN, and wait until it is. Without a flush thread the caller
+   * writes the log itself.
+   * @param lsn the LSN that has to be durable; clamped to the last LSN handed out
+   * @throws Exception if a write of the log failed, now or before
+   */
+  void Flush(lsn_t lsn);
+
+  /**
+   * Make the log durable up to and including the given LSN within async_commit_lag, without waiting for it. The
+   * flush thread then writes out everything appended in the meantime with the same sync. Without a flush thread the
+   * caller writes the log itself.
+   * @param lsn the LSN that has to become durable
+   */
+  void FlushAsync(lsn_t lsn);
+
+  /**
+   * Wait until the log is durable up to and including the given LSN, e.g. the LSN of an asynchronous commit. Unlike
+   * Flush(), this does not make the flush thread write early, so it costs no extra sync but may take up to
+   * async_commit_lag, or log_timeout if nothing asked for the LSN to be flushed.
+   * @param lsn the LSN that has to be durable; clamped to the last LSN handed out
+   * @throws Exception if a write of the log failed, now or before
+   */
+  void WaitForLSN(lsn_t lsn);
+
+  /**
+   * Continue the LSNs of a log that already has records, e.g. at LogRecovery::GetNextLSN() after a restart, so that
+   * new records are newer than every page LSN. The records before are taken as durable. Only valid before the first
+   * record is appended.
+   * @param lsn the LSN of the next record
+   */
+  void SetNextLSN(lsn_t lsn);
+
+  inline auto GetNextLSN() -> lsn_t { return LsnOf(insert_point_); }
   inline auto GetPersistentLSN() -> lsn_t { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline auto GetLogBuffer() -> char * { return log_buffer_; }
+  /** @return the size of the ring of log records, in bytes */
+  inline auto GetLogBufferSize() const -> size_t { return log_buffer_size_; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /** Bytes a record takes on top of its tuples: the header, a RID and two tuple sizes. */
+  static constexpr size_t MAX_RECORD_OVERHEAD = 64;
+  /** Value of an insertion slot that no appender uses. */
+  static constexpr uint64_t IDLE_SLOT = std::numeric_limits<uint64_t>::max();
+
+  /**
+   * An insertion point: the LSN in the low half and the byte position in the high half, which wraps around at 4 GB;
+   * ToLogPosition() restores the full position. Adding (size << 32) + 1 claims one record of size bytes.
+   */
+  static auto LsnOf(uint64_t insert_point) -> lsn_t { return static_cast<lsn_t>(insert_point & 0xFFFFFFFF); }
+  static auto PosOf(uint64_t insert_point) -> uint32_t { return static_cast<uint32_t>(insert_point >> 32); }
+
+  /** An insertion slot, on a cache line of its own. */
+  struct alignas(64) InsertSlot {
+    /** The insertion point the appender's record starts at, or a lower bound of it, or IDLE_SLOT. */
+    std::atomic<uint64_t> insert_point_{IDLE_SLOT};
+  };
+
+  /** Take a free insertion slot, advertising the current insertion point in it. */
+  auto AcquireSlot() -> InsertSlot &;
+
+  /**
+   * @return the position of a record that is not written out yet, given the 32 bits of its insertion point. The
+   * record is less than 4 GB past flushed_pos_, which cannot pass it while it is being appended.
+   */
+  auto ToLogPosition(uint32_t pos) const -> uint64_t {
+    const uint64_t flushed_pos = flushed_pos_;
+    return flushed_pos + static_cast<uint32_t>(pos - static_cast<uint32_t>(flushed_pos));
+  }
+
+  /** Wait until the ring has room for size bytes at the position pos. */
+  void WaitForSpace(uint32_t pos, size_t size);
+
+  /** The loop of the flush thread. */
+  void FlushLoop();
+
+  /**
+   * Write out the completed records past flushed_pos_. latch_ is held on entry and on return, but not during the
+   * write. Throws, with latch_ held, if this or an earlier write failed.
+   */
+  void FlushLogBuffer(std::unique_lock<std::mutex> &lock);
+
+  /** Get the log flushed: wake the flush thread and wait for it, or flush in this thread if there is none. */
+  void RequestFlush(std::unique_lock<std::mutex> &lock);
+
+  /** Write the record in the on-disk format described in log_record.h. */
+  static void SerializeLogRecord(const LogRecord &log_record, char *data);
 
-  /** The atomic counter which records the next log sequence number. */
-  std::atomic<lsn_t> next_lsn_;
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
+  /** Offset in the log file of the record at byte position 0: the size of the log file when the manager started. */
+  const int64_t log_file_offset_;
+
+  /** Size of the ring, a power of two. */
+  const size_t log_buffer_size_;
+  /** The ring of log records; the record at byte position pos starts at pos % log_buffer_size_. */
   char *log_buffer_;
+  /** A batch that wraps around the end of the ring is copied here to be written at once. */
   char *flush_buffer_;
 
-  std::mutex latch_;
+  /** The next LSN and the byte position of the next record. */
+  std::atomic<uint64_t> insert_point_{0};
+  /**
+   * Byte position up to which the log is written out; the ring has room up to log_buffer_size_ past it. Unlike the
+   * insertion point, it does not wrap around.
+   */
+  std::atomic<uint64_t> flushed_pos_{0};
+  std::array<InsertSlot, LOG_INSERT_SLOTS> slots_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  /** Serializes flushes and protects the flags below. */
+  std::mutex latch_;
 
+  std::thread *flush_thread_{nullptr};
+  /** Set to make the flush thread exit. Protected by latch_. */
+  bool stop_flush_thread_{false};
+  /** Set when someone waits for the log to be flushed. Protected by latch_. */
+  bool flush_requested_{false};
+  /** True while a batch is being written. Protected by latch_. */
+  bool flushing_{false};
+  /**
+   * The error of the write that failed, if any. What reached the disk is unknown then, and a failed sync may have
+   * dropped the rest, so persistent_lsn_ stays where it is and every later flush rethrows the error. Protected by
+   * latch_.
+   */
+  std::exception_ptr write_error_;
+  /** The largest LSN passed to FlushAsync(); the flush thread writes up to it within async_commit_lag. */
+  std::atomic<lsn_t> async_flush_lsn_{INVALID_LSN};
+
+  /** Wakes the flush thread. */
   std::condition_variable cv_;
+  /** Signalled when a flush completed. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
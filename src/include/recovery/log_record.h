@@ -14,6 +14,8 @@
 
 #include <cassert>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
@@ -32,6 +34,12 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** The start of a checkpoint: redo starts here once the checkpoint is complete. */
+  BEGIN_CHECKPOINT,
+  /** The active transaction table and the dirty page table of a checkpoint; there may be several per checkpoint. */
+  END_CHECKPOINT,
+  /** A compensation log record: the undo of a change by recovery, which is redone but never undone itself. */
+  CLR,
 };
 
 /**
@@ -54,13 +62,22 @@ enum class LogRecordType {
  * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
  *-----------------------------------------------------------------------------------
  * For new page type log record
- *--------------------------
- * | HEADER | prev_page_id |
- *--------------------------
+ *------------------------------------
+ * | HEADER | prev_page_id | page_id |
+ *------------------------------------
+ * For end checkpoint type log record, whose prevLSN is the LSN of its BEGIN_CHECKPOINT record
+ *-------------------------------------------------------------------------------------------------
+ * | HEADER | txn_count | (txn_id, last_lsn) * txn_count | page_count | (page_id, rec_lsn) * page_count |
+ *-------------------------------------------------------------------------------------------------
+ * For compensation log record, followed by the record it undoes without its header
+ *-----------------------------------------------------------------
+ * | HEADER | undo_next_lsn | undone_type | undone record's body |
+ *-----------------------------------------------------------------
  */
 class LogRecord {
   friend class LogManager;
   friend class LogRecovery;
+  friend class CheckpointManager;
 
  public:
   LogRecord() = default;
@@ -110,6 +127,34 @@ class LogRecord {
     size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
   }
 
+  // constructor for END_CHECKPOINT type
+  LogRecord(lsn_t begin_checkpoint_lsn, LogRecordType log_record_type,
+            std::vector<std::pair<txn_id_t, lsn_t>> active_txns, std::vector<std::pair<page_id_t, lsn_t>> dirty_pages)
+      : prev_lsn_(begin_checkpoint_lsn),
+        log_record_type_(log_record_type),
+        active_txns_(std::move(active_txns)),
+        dirty_pages_(std::move(dirty_pages)) {
+    size_ = HEADER_SIZE + 2 * sizeof(int32_t) + active_txns_.size() * (sizeof(txn_id_t) + sizeof(lsn_t)) +
+            dirty_pages_.size() * (sizeof(page_id_t) + sizeof(lsn_t));
+  }
+
+  // constructor for CLR type: the undo of the given INSERT/DELETE/UPDATE record
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, const LogRecord &undone)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(LogRecordType::CLR),
+        delete_rid_(undone.delete_rid_),
+        delete_tuple_(undone.delete_tuple_),
+        insert_rid_(undone.insert_rid_),
+        insert_tuple_(undone.insert_tuple_),
+        update_rid_(undone.update_rid_),
+        old_tuple_(undone.old_tuple_),
+        new_tuple_(undone.new_tuple_),
+        undo_next_lsn_(undone.prev_lsn_),
+        undone_type_(undone.log_record_type_) {
+    size_ = undone.size_ + sizeof(lsn_t) + sizeof(int32_t);
+  }
+
   ~LogRecord() = default;
 
   inline auto GetDeleteTuple() -> Tuple & { return delete_tuple_; }
@@ -128,6 +173,15 @@ class LogRecord {
 
   inline auto GetNewPageRecord() -> page_id_t { return prev_page_id_; }
 
+  /** @return the active transactions of an END_CHECKPOINT record, with the LSN of their last record */
+  inline auto GetActiveTransactions() -> std::vector<std::pair<txn_id_t, lsn_t>> & { return active_txns_; }
+
+  /** @return the dirty pages of an END_CHECKPOINT record, with the LSN of their oldest change not on disk */
+  inline auto GetDirtyPages() -> std::vector<std::pair<page_id_t, lsn_t>> & { return dirty_pages_; }
+
+  /** @return the offset of the record in the log file, once it is appended */
+  inline auto GetLogOffset() -> int64_t { return log_offset_; }
+
   inline auto GetSize() -> int32_t { return size_; }
 
   inline auto GetLSN() -> lsn_t { return lsn_; }
@@ -138,6 +192,12 @@ class LogRecord {
 
   inline auto GetLogRecordType() -> LogRecordType & { return log_record_type_; }
 
+  /** @return the LSN of the next record to undo after a CLR, i.e. the one before the record it undoes */
+  inline auto GetUndoNextLSN() -> lsn_t { return undo_next_lsn_; }
+
+  /** @return the type of the record a CLR undoes; its body holds that record's RID and tuples */
+  inline auto GetUndoneType() -> LogRecordType { return undone_type_; }
+
   // For debug purpose
   inline auto ToString() const -> std::string {
     std::ostringstream os;
@@ -176,6 +236,17 @@ class LogRecord {
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
+
+  // case5: for end checkpoint
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns_;
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages_;
+
+  // case6: for compensation
+  lsn_t undo_next_lsn_{INVALID_LSN};
+  LogRecordType undone_type_{LogRecordType::INVALID};
+
+  // offset in the log file, set when the record is appended; not serialized
+  int64_t log_offset_{-1};
   static const int HEADER_SIZE = 20;
 };  // namespace bustub
 
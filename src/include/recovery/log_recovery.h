@@ -13,45 +13,133 @@
 #pragma once
 
 #include <algorithm>
+#include <deque>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
+#include "recovery/log_manager.h"
 #include "recovery/log_record.h"
+#include "storage/page/table_page.h"
 
 namespace bustub {
 
 /**
  * Read log file from disk, redo and undo.
+ *
+ * Redo() reads the log from where the master record points, i.e. from the last complete checkpoint or the start, in
+ * large sequential chunks, the next chunk being read while the current one is parsed, and keeps the records in
+ * memory. The END_CHECKPOINT records of that checkpoint fill in the active transaction table and give the redo
+ * point, the smallest recLSN of the dirty page table; records before it are only kept for undo. Redo then
+ * partitions the remaining records by the page they change across worker threads.
+ * Every worker redoes its pages one after the other, the records of a page in LSN order, and skips the records that
+ * are already on the page, i.e. not newer than its page LSN. Pages are independent of each other in the log, so the
+ * workers need no coordination. Undo() then rolls back the transactions that neither committed nor aborted (the
+ * losers), each by a worker that walks its prev_lsn_ chain backwards.
+ * Once the log is read, the log manager continues its LSNs, so that the records written after recovery are newer than
+ * every page LSN and the next recovery redoes them.
+ *
+ * Every change Undo() rolls back gets a compensation log record (CLR) with the LSN of the next record to undo, and
+ * every loser an ABORT record at the end. Redo replays CLRs like any other change, and undo skips the records a CLR
+ * compensates, so that a crash during recovery neither loses an undo nor repeats one.
+ *
+ * Logging must be off during recovery, so that the table pages write no log records of their own.
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
-  }
+  /**
+   * @param disk_manager the disk manager to read the log from
+   * @param buffer_pool_manager the buffer pool of the pages to recover
+   * @param log_manager the log manager to continue the LSNs of the log with; no record may have been appended yet
+   * @param num_threads number of threads that redo pages and undo transactions in parallel
+   */
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, LogManager *log_manager,
+              size_t num_threads = RECOVERY_THREADS)
+      : disk_manager_(disk_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        log_manager_(log_manager),
+        num_threads_(std::max<size_t>(num_threads, 1)) {}
 
-  ~LogRecovery() {
-    delete[] log_buffer_;
-    log_buffer_ = nullptr;
-  }
+  ~LogRecovery() = default;
 
   void Redo();
   void Undo();
-  auto DeserializeLogRecord(const char *data, LogRecord *log_record) -> bool;
+
+  /**
+   * Deserialize a log record from the log.
+   * @param data the log record in the format described in log_record.h
+   * @param size bytes available at data
+   * @param[out] log_record the log record
+   * @return false if data holds no complete log record: it is cut off, or the log ends there
+   */
+  auto DeserializeLogRecord(const char *data, size_t size, LogRecord *log_record) -> bool;
+
+  /** @return the number of log records Redo() read */
+  auto GetNumRecords() const -> size_t { return records_.size(); }
+
+  /** @return the transactions that neither committed nor aborted, with the LSN of their last record */
+  auto GetActiveTransactions() const -> const std::unordered_map<txn_id_t, lsn_t> & { return active_txn_; }
+
+  /** @return the LSN Redo() started redoing at, INVALID_LSN if it redid the whole log */
+  auto GetRedoLSN() const -> lsn_t { return redo_lsn_; }
+
+  /** @return the LSN after the last record of the log, where Redo() let the log manager continue */
+  auto GetNextLSN() const -> lsn_t { return next_lsn_; }
 
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /**
+   * Read the log from the master record's offset into records_, building active_txn_, lsn_mapping_ and redo_lsn_ on
+   * the way.
+   */
+  void ReadLog();
+
+  /**
+   * Redo the records of a partition of the pages.
+   * @param records the pages and the indexes of their records in records_, in LSN order
+   */
+  void RedoPages(std::vector<std::pair<page_id_t, size_t>> *records);
+
+  /**
+   * Redo a log record on one of the pages it changes, unless the page already has it.
+   * @return true if the page changed
+   */
+  auto RedoRecord(TablePage *page, LogRecord *log_record) -> bool;
 
+  /** Undo the records of a transaction, from the given LSN back to its BEGIN record, and log it as aborted. */
+  void UndoTransaction(txn_id_t txn_id, lsn_t last_lsn);
+
+  /**
+   * Roll back the change of a record of the given type, i.e. the record itself, or the one a CLR undoes. A deleted
+   * tuple whose slot was taken again goes into another slot of the page, and the record is changed to that RID.
+   */
+  void UndoRecord(TablePage *page, LogRecord *log_record, LogRecordType type);
+
+  /** @return the tuple a record of the given type changes; an invalid RID for the types that change no tuple */
+  static auto RIDOf(const LogRecord &log_record, LogRecordType type) -> RID;
+
+  /** Change the tuple a record of the given type changes, see RIDOf(). */
+  static void SetRIDOf(LogRecord *log_record, LogRecordType type, const RID &rid);
+
+  /** Fetch a page, waiting for a free frame if the other workers hold all of them. */
+  auto FetchTablePage(page_id_t page_id) -> TablePage *;
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  LogManager *log_manager_;
+  const size_t num_threads_;
+
+  /** All records of the log, in LSN order; a deque, as records do not move when it grows. */
+  std::deque<LogRecord> records_;
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
-  /** Mapping the log sequence number to log file offset for undos. */
-  std::unordered_map<lsn_t, int> lsn_mapping_;
-
-  int offset_ __attribute__((__unused__));  // NOLINT
-  char *log_buffer_;
+  /** Mapping the log sequence number to its record in records_ for undos. */
+  std::unordered_map<lsn_t, size_t> lsn_mapping_;
+  /** Records before this LSN are on disk already. */
+  lsn_t redo_lsn_{INVALID_LSN};
+  lsn_t next_lsn_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.h
+//
+// Identification: src/include/storage/disk/async_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "storage/disk/posix_disk_manager.h"
+
+namespace bustub {
+
+class IoUring;
+
+/**
+ * AsyncDiskManager keeps many page I/Os in flight instead of blocking one thread per page. On Linux it submits them
+ * to an io_uring, several pages per system call, and a completion thread runs the callbacks. Where io_uring is not
+ * available (older kernels, other systems, or a sandbox that forbids it), a pool of ASYNC_IO_FALLBACK_THREADS threads
+ * doing pread()/pwrite() emulates it with the same interface.
+ *
+ * At most ASYNC_IO_QUEUE_DEPTH I/Os are in flight; submitting more blocks until earlier ones complete. The
+ * synchronous ReadPage()/WritePage() of PosixDiskManager keep working alongside, and WritePages()/ReadPages() submit
+ * their pages as one batch and wait for it.
+ */
+class AsyncDiskManager : public PosixDiskManager {
+ public:
+  /** Called once an I/O has completed, on an I/O thread, with false if it failed. Must not block for long. */
+  using Callback = std::function<void(bool)>;
+
+  /** A page read or write. The buffer must stay valid until the callback has run. */
+  struct Request {
+    bool is_write_;
+    page_id_t page_id_;
+    char *data_;
+    Callback callback_;
+  };
+
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param use_io_uring false to always use the thread pool, e.g. to test it
+   * @param direct_io whether to open the database file with O_DIRECT, see PosixDiskManager
+   * @param page_size page size of a new database, see DiskManager
+   */
+  explicit AsyncDiskManager(const std::string &db_file, bool use_io_uring = true, bool direct_io = false,
+                            size_t page_size = BUSTUB_PAGE_SIZE);
+
+  ~AsyncDiskManager() override;
+
+  /**
+   * Wait for all I/Os in flight, stop the I/O threads and close all the file resources.
+   */
+  void ShutDown() override;
+
+  /**
+   * Start reading a page.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, valid until the future is ready
+   * @return a future that becomes true once the page is read, or false if the read failed
+   */
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool>;
+
+  /**
+   * Start writing a page.
+   * @param page_id id of the page
+   * @param page_data raw page data, valid until the future is ready
+   * @return a future that becomes true once the page is written, or false if the write failed
+   */
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool>;
+
+  /**
+   * Submit several I/Os at once. With io_uring, up to ASYNC_IO_QUEUE_DEPTH of them go out in a single system call.
+   * The callbacks may run before this call returns.
+   * @param requests the I/Os to start
+   */
+  void SubmitBatch(std::vector<Request> requests);
+
+  /** Writes the pages as one batch and waits for all of them. Throws an Exception if any of them failed. */
+  void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) override;
+
+  /** Reads the pages as one batch and waits for all of them. */
+  void ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) override;
+
+  /** @return true if I/O goes through io_uring, false if the thread pool emulates it */
+  auto UsesIoUring() const -> bool { return ring_ != nullptr; }
+
+ private:
+  /** Submits the requests as a batch and waits until all of them have completed. Their callbacks are replaced. */
+  void SubmitAndWait(std::vector<Request> requests);
+
+  /** Submits one batch to the io_uring. The batch must fit into the free queue slots. */
+  void SubmitToRing(std::vector<std::unique_ptr<Request>> requests);
+
+  /** Reaps io_uring completions until the ring is stopped. */
+  void CompletionLoop();
+
+  /** Runs queued requests with pread()/pwrite() until the pool is stopped. */
+  void WorkerLoop();
+
+  /** Does the part of an I/O that io_uring left undone (short transfer, error, or no io_uring), then completes it. */
+  void FinishSynchronously(std::unique_ptr<Request> request, size_t done);
+
+  /** Runs the callback of a request and frees its queue slot. */
+  void Complete(std::unique_ptr<Request> request, bool success);
+
+  /** Waits for all I/Os in flight and stops the I/O threads. */
+  void Stop();
+
+  /** The io_uring, or nullptr if the thread pool is used instead. */
+  std::unique_ptr<IoUring> ring_;
+  /** Serializes submissions to the io_uring. */
+  std::mutex submit_latch_;
+  /** Protects in_flight_, queue_ and stopping_. */
+  std::mutex latch_;
+  /** Signalled whenever an I/O completes or is queued. */
+  std::condition_variable cv_;
+  /** Number of submitted I/Os that have not completed yet. */
+  size_t in_flight_{0};
+  /** I/Os waiting for a thread of the pool. */
+  std::deque<std::unique_ptr<Request>> queue_;
+  /** Whether the I/O threads should exit. */
+  bool stopping_{false};
+  /** The io_uring completion thread, or the threads of the pool. */
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace bustub
@@ -12,16 +12,30 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 
 namespace bustub {
 
+/**
+ * The master record points recovery at the last complete checkpoint. Every checkpoint replaces it once its
+ * END_CHECKPOINT records are durable, so a crash during a checkpoint recovers from the one before.
+ */
+struct MasterRecord {
+  /** LSN of the BEGIN_CHECKPOINT record of the checkpoint, or INVALID_LSN if there was no checkpoint yet */
+  lsn_t checkpoint_lsn_{INVALID_LSN};
+  /** offset in the log file where recovery starts reading */
+  int64_t log_offset_{0};
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
@@ -29,10 +43,13 @@ namespace bustub {
 class DiskManager {
  public:
   /**
-   * Creates a new disk manager that writes to the specified database file.
+   * Creates a new disk manager that writes to the specified database file. The page size is fixed when the database
+   * is created and kept in its header page, so an existing database is opened with the page size it was created with,
+   * whatever page_size says. Databases without a header page use BUSTUB_PAGE_SIZE.
    * @param db_file the file name of the database file to write to
+   * @param page_size page size of a new database: a power of two from BUSTUB_PAGE_SIZE to BUSTUB_MAX_PAGE_SIZE
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, size_t page_size = BUSTUB_PAGE_SIZE);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
@@ -42,10 +59,11 @@ class DiskManager {
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. The write is buffered by the OS; it is only durable after the next Sync() or
+   * a SyncRange() that covers the page.
    * @param page_id id of the page
    * @param page_data raw page data
    */
@@ -59,11 +77,93 @@ class DiskManager {
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Write several pages to the database file. Disk managers that can keep several I/Os in flight submit them as one
+   * batch; the default implementation writes them one after the other. Returns once all pages are written.
+   * @param pages ids and raw data of the pages
+   */
+  virtual void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /**
+   * Read several pages from the database file, like WritePages(). Returns once all pages are read.
+   * @param pages ids of the pages and their output buffers
+   */
+  virtual void ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages);
+
+  /**
+   * Durability barrier: make all completed writes to the database file and the free space map durable.
+   * @throws Exception if they could not be made durable
+   */
+  virtual void Sync();
+
+  /**
+   * Write out a range of pages of the database file. Cheaper than Sync() when only a few pages changed, but it does
+   * not cover the free space map or file metadata such as the size of a grown file. The default implementation
+   * calls Sync().
+   * @param first_page_id id of the first page of the range
+   * @param num_pages number of pages in the range
+   * @throws Exception if the range could not be written out
+   */
+  virtual void SyncRange(page_id_t first_page_id, size_t num_pages);
+
+  /**
+   * Reserve disk space for a run of pages that are about to be written, so that the file system can place them
+   * contiguously and later writes do not have to extend the file. The pages read as zeros until they are written.
+   * The default implementation does nothing.
+   * @param first_page_id id of the first page of the run
+   * @param num_pages number of pages in the run
+   */
+  virtual void PreallocatePages([[maybe_unused]] page_id_t first_page_id, [[maybe_unused]] size_t num_pages) {}
+
+  /**
+   * Create a tablespace: a database file of its own, next to the main one, e.g. for one table or index. Its pages are
+   * allocated with BufferPoolManager::NewPageInTablespace(). Disk managers without tablespaces keep everything in the
+   * DEFAULT_TABLESPACE and return it.
+   * @return the id of the new tablespace
+   */
+  virtual auto CreateTablespace() -> tablespace_id_t { return DEFAULT_TABLESPACE; }
+
+  /**
+   * Drop a tablespace and delete its file, which gives its space back to the file system. The buffer pool must not
+   * hold pages of the tablespace any more. The DEFAULT_TABLESPACE can't be dropped.
+   * @param tablespace_id id of the tablespace
+   */
+  virtual void DropTablespace([[maybe_unused]] tablespace_id_t tablespace_id) {}
+
+  /**
+   * @param tablespace_id id of a tablespace other than the DEFAULT_TABLESPACE
+   * @return the number of blocks in the file of the tablespace, i.e. one past the highest block written to it
+   */
+  virtual auto GetNumBlocks([[maybe_unused]] tablespace_id_t tablespace_id) -> page_id_t { return 0; }
+
+  /**
+   * @return the number of pages the database file had when it was opened, including preallocated ones; 0 for a
+   * database created by this disk manager and for disk managers without a database file
+   */
+  virtual auto GetNumPages() -> page_id_t { return num_pages_; }
+
+  /**
+   * Write a page of the free space map. The free space map is kept in its own file next to the database file, so
+   * that it does not use up page ids of the database. Disk managers without a database file keep it in memory.
+   * @param fsm_page_no number of the page within the free space map
+   * @param page_data raw page data
+   */
+  virtual void WriteFreeSpaceMapPage(uint32_t fsm_page_no, const char *page_data);
+
+  /**
+   * Read a page of the free space map.
+   * @param fsm_page_no number of the page within the free space map
+   * @param[out] page_data output buffer
+   * @return false if the page lies past the end of the free space map
+   */
+  virtual auto ReadFreeSpaceMapPage(uint32_t fsm_page_no, char *page_data) -> bool;
+
+  /**
+   * Flush the entire log buffer into disk, and sync the log file so that it is durable.
    * @param log_data raw log data
    * @param size size of log entry
+   * @throws Exception if the log could not be written or made durable
    */
-  void WriteLog(char *log_data, int size);
+  virtual void WriteLog(char *log_data, int size);
 
   /**
    * Read a log entry from the log file.
@@ -72,7 +172,27 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  auto ReadLog(char *log_data, int size, int offset) -> bool;
+  virtual auto ReadLog(char *log_data, int size, int64_t offset) -> bool;
+
+  /** @return the size of the log file, i.e. the offset the next WriteLog() writes to */
+  virtual auto GetLogSize() -> int64_t;
+
+  /**
+   * Replace the master record and make it durable. It is kept in a file of its own next to the log, which is
+   * replaced as a whole, so that a crash leaves either the old or the new record. Disk managers without a database
+   * file keep it in memory.
+   * @param master_record the new master record
+   */
+  virtual void WriteMasterRecord(const MasterRecord &master_record);
+
+  /** @return the master record, or one that recovers from the start of the log if no checkpoint completed yet */
+  virtual auto ReadMasterRecord() -> MasterRecord;
+
+  /** @return the size of the pages of the database, in bytes */
+  auto GetPageSize() const -> size_t { return page_size_; }
+
+  /** @return true iff page_size is a power of two from BUSTUB_PAGE_SIZE to BUSTUB_MAX_PAGE_SIZE */
+  static auto IsValidPageSize(size_t page_size) -> bool;
 
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
@@ -83,6 +203,9 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of Sync() and SyncRange() calls */
+  auto GetNumSyncs() const -> int;
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -93,15 +216,37 @@ class DiskManager {
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
  protected:
-  auto GetFileSize(const std::string &file_name) -> int;
+  auto GetFileSize(const std::string &file_name) -> int64_t;
+  /** Flushes the free space map stream and makes its file durable. */
+  void SyncFreeSpaceMap();
+  /** Makes the named file durable with fdatasync(); throws an Exception if that fails. */
+  static void SyncFile(const std::string &file_name);
+  /** Throws if page_size is not a valid page size. */
+  static void CheckPageSize(size_t page_size);
+  // size of the pages of the database; the free space map always uses BUSTUB_PAGE_SIZE pages
+  size_t page_size_{BUSTUB_PAGE_SIZE};
+  // number of pages of the database file when it was opened
+  page_id_t num_pages_{0};
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
   // stream to write db file
   std::fstream db_io_;
   std::string file_name_;
+  // stream to write the free space map file
+  std::fstream fsm_io_;
+  std::string fsm_name_;
+  // file of the master record
+  std::string master_name_;
+  // master record of disk managers without a database file
+  MasterRecord master_record_;
+  std::mutex master_latch_;
+  // free space map of disk managers without a database file
+  std::vector<std::array<char, BUSTUB_PAGE_SIZE>> fsm_pages_;
+  std::mutex fsm_latch_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
+  std::atomic<int> num_syncs_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
   // With multiple buffer pool instances, need to protect file access
@@ -34,7 +34,11 @@ namespace bustub {
  */
 class DiskManagerMemory : public DiskManager {
  public:
-  explicit DiskManagerMemory(size_t pages);
+  /**
+   * @param pages number of pages to hold
+   * @param page_size size of the pages, see DiskManager
+   */
+  explicit DiskManagerMemory(size_t pages, size_t page_size = BUSTUB_PAGE_SIZE);
 
   ~DiskManagerMemory() override { delete[] memory_; }
 
@@ -62,7 +66,11 @@ class DiskManagerMemory : public DiskManager {
  */
 class DiskManagerUnlimitedMemory : public DiskManager {
  public:
-  DiskManagerUnlimitedMemory() = default;
+  /** @param page_size size of the pages, see DiskManager */
+  explicit DiskManagerUnlimitedMemory(size_t page_size = BUSTUB_PAGE_SIZE) {
+    CheckPageSize(page_size);
+    page_size_ = page_size;
+  }
 
   /**
    * Write a page to the database file.
@@ -76,12 +84,13 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     }
     if (data_[page_id] == nullptr) {
       data_[page_id] = std::make_shared<ProtectedPage>();
+      data_[page_id]->first.resize(page_size_);
     }
     std::shared_ptr<ProtectedPage> ptr = data_[page_id];
     std::unique_lock<std::shared_mutex> l_page(ptr->second);
     l.unlock();
 
-    memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
+    memcpy(ptr->first.data(), page_data, page_size_);
   }
 
   /**
@@ -103,12 +112,12 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     std::shared_lock<std::shared_mutex> l_page(ptr->second);
     l.unlock();
 
-    memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
+    memcpy(page_data, ptr->first.data(), page_size_);
   }
 
  private:
   std::mutex mutex_;
-  using Page = std::array<char, BUSTUB_PAGE_SIZE>;
+  using Page = std::vector<char>;
   using ProtectedPage = std::pair<Page, std::shared_mutex>;
   std::vector<std::shared_ptr<ProtectedPage>> data_;
 };
@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_disk_manager.h
+//
+// Identification: src/include/storage/disk/latency_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * The latency of one kind of I/O: log-normally distributed with the given median and 99th percentile, which is close
+ * to what devices show, a narrow body with a long tail. A median of zero means no delay; a 99th percentile at or
+ * below the median means every I/O takes exactly the median.
+ */
+struct LatencyDistribution {
+  std::chrono::microseconds median_{0};
+  std::chrono::microseconds p99_{0};
+};
+
+/** The simulated device of a LatencyDiskManager. */
+struct LatencyProfile {
+  /** A page read that does not follow the previous I/O. */
+  LatencyDistribution read_;
+  /** A page write that does not follow the previous I/O. */
+  LatencyDistribution write_;
+  /** A page read or write of the page right after the previous I/O, i.e. without a seek. */
+  LatencyDistribution sequential_;
+  /** Sync(), SyncRange() and WriteLog(), which wait for the device to make data durable. */
+  LatencyDistribution sync_;
+  /** I/Os the device serves at the same time; further ones wait for a free slot. */
+  size_t queue_depth_{1};
+  /** Seed of the latency samples, so that runs can be repeated. */
+  uint64_t seed_{0};
+
+  /** No delay and no queue limit worth mentioning: only counts the I/Os. */
+  static auto None() -> LatencyProfile;
+
+  /** A NVMe SSD: ~100 us reads, cached writes, no seeks, many I/Os in flight. */
+  static auto Ssd() -> LatencyProfile;
+
+  /** A 7200 rpm hard disk: a seek and half a rotation for every random I/O, one I/O at a time. */
+  static auto Hdd() -> LatencyProfile;
+};
+
+/**
+ * LatencyDiskManager wraps another disk manager, usually a DiskManagerMemory, and makes its I/Os as slow as those of
+ * a real device. Every page I/O waits for a free slot of the queue, whose depth caps the IOPS, and then until its
+ * sampled latency has passed, including the time the wrapped disk manager took. A batch of WritePages() or
+ * ReadPages() goes out queue_depth_ pages at a time and each group takes as long as its slowest page, so batching
+ * pays off like on a device with a deep queue. It also counts the reads and writes of every page, e.g. to see how
+ * often the buffer pool reads a page again or whether prefetching reads pages that are never used.
+ *
+ * The wrapped disk manager is not owned and must outlive this one. Its own counters see the forwarded calls as well.
+ */
+class LatencyDiskManager : public DiskManager {
+ public:
+  /** Number of reads and writes of one page. */
+  struct PageIoCounts {
+    uint64_t reads_{0};
+    uint64_t writes_{0};
+  };
+
+  /**
+   * @param disk_manager the disk manager to forward the I/Os to
+   * @param profile the simulated device
+   */
+  LatencyDiskManager(DiskManager *disk_manager, const LatencyProfile &profile);
+
+  /** Shut down the wrapped disk manager. */
+  void ShutDown() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) override;
+
+  void ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) override;
+
+  void Sync() override;
+
+  void SyncRange(page_id_t first_page_id, size_t num_pages) override;
+
+  /** Forwarded without delay: reserving space does not touch the pages. */
+  void PreallocatePages(page_id_t first_page_id, size_t num_pages) override;
+
+  auto CreateTablespace() -> tablespace_id_t override;
+
+  void DropTablespace(tablespace_id_t tablespace_id) override;
+
+  auto GetNumBlocks(tablespace_id_t tablespace_id) -> page_id_t override;
+
+  auto GetNumPages() -> page_id_t override;
+
+  /** Forwarded without delay, like the rest of the free space map, which is small and kept in memory. */
+  void WriteFreeSpaceMapPage(uint32_t fsm_page_no, const char *page_data) override;
+
+  auto ReadFreeSpaceMapPage(uint32_t fsm_page_no, char *page_data) -> bool override;
+
+  /** Forwarded after a sync delay, as a log flush waits until the log is durable. */
+  void WriteLog(char *log_data, int size) override;
+
+  /** Forwarded after a sequential read delay. */
+  auto ReadLog(char *log_data, int size, int64_t offset) -> bool override;
+
+  /** Forwarded without delay, like the master record below: only checkpoints and recovery use them. */
+  auto GetLogSize() -> int64_t override;
+
+  void WriteMasterRecord(const MasterRecord &master_record) override;
+
+  auto ReadMasterRecord() -> MasterRecord override;
+
+  /**
+   * @param page_id id of the page
+   * @return the number of reads and writes of the page since the start or the last ResetPageIoCounts()
+   */
+  auto GetPageIoCounts(page_id_t page_id) -> PageIoCounts;
+
+  /** @return the reads and writes of all pages that had any */
+  auto GetAllPageIoCounts() -> std::unordered_map<page_id_t, PageIoCounts>;
+
+  /** Clear the per-page counters. */
+  void ResetPageIoCounts();
+
+  /** @return the number of page reads */
+  auto GetNumReads() const -> uint64_t { return num_reads_; }
+
+  /** @return the most I/Os that were in flight at the same time */
+  auto GetMaxInFlight() const -> size_t { return max_in_flight_; }
+
+  /** @return the total time I/Os spent waiting for a queue slot or their latency */
+  auto GetTotalDelay() const -> std::chrono::microseconds { return std::chrono::microseconds(total_delay_us_); }
+
+ private:
+  /** @return a latency of the distribution */
+  auto Sample(const LatencyDistribution &distribution) -> std::chrono::microseconds;
+
+  /** @return the latency of a read or write of the page, sequential if it follows the previous I/O */
+  auto SamplePageIo(page_id_t page_id, bool is_write) -> std::chrono::microseconds;
+
+  /** Waits until count slots of the queue are free and takes them. */
+  void AcquireSlots(size_t count);
+
+  /** Frees count slots of the queue. */
+  void ReleaseSlots(size_t count);
+
+  /**
+   * Runs an I/O on count queue slots: waits for the slots, runs io, then waits until the latency has passed since
+   * the slots were taken.
+   */
+  template <typename IoFunc>
+  void Delay(size_t count, std::chrono::microseconds latency, IoFunc io);
+
+  /** Counts a read or write of the page. */
+  void CountPageIo(page_id_t page_id, bool is_write);
+
+  DiskManager *disk_manager_;
+  LatencyProfile profile_;
+
+  /** Protects rng_ and last_page_id_. */
+  std::mutex rng_latch_;
+  std::mt19937_64 rng_;
+  /** Page of the previous page I/O, to tell sequential I/Os from random ones. */
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+
+  /** Protects in_flight_. */
+  std::mutex queue_latch_;
+  /** Signalled whenever slots of the queue are freed. */
+  std::condition_variable queue_cv_;
+  size_t in_flight_{0};
+  std::atomic<size_t> max_in_flight_{0};
+
+  /** Protects page_io_counts_. */
+  std::mutex counts_latch_;
+  std::unordered_map<page_id_t, PageIoCounts> page_io_counts_;
+  std::atomic<uint64_t> num_reads_{0};
+  std::atomic<int64_t> total_delay_us_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager.h
+//
+// Identification: src/include/storage/disk/mmap_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/disk/posix_disk_manager.h"
+
+namespace bustub {
+
+/** How pages of a memory-mapped database file are expected to be accessed; passed on to madvise(). */
+enum class AccessPattern { NORMAL, SEQUENTIAL, RANDOM };
+
+/**
+ * MmapDiskManager maps the database file into memory, for read-mostly workloads. ReadPage() copies the page straight
+ * out of the mapping, so a read that hits the OS page cache costs one memcpy and no system call. Writes to pages
+ * inside the mapping are copied into it as well; they reach the file when the OS writes the mapping back, and are
+ * durable after Sync() or SyncRange(), which msync() the mapping.
+ *
+ * Writes past the end of the mapping extend the file with pwrite(). The mapping follows the file lazily: it is
+ * recreated, under an exclusive latch, the first time a page past its end is read. Only the database file itself is
+ * mapped; pages of other tablespaces are read and written like in PosixDiskManager.
+ */
+class MmapDiskManager : public PosixDiskManager {
+ public:
+  /**
+   * Creates a new disk manager that maps the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param access_pattern the madvise() hint for the mapping
+   * @param page_size page size of a new database, see DiskManager
+   */
+  explicit MmapDiskManager(const std::string &db_file, AccessPattern access_pattern = AccessPattern::NORMAL,
+                           size_t page_size = BUSTUB_PAGE_SIZE);
+
+  ~MmapDiskManager() override;
+
+  /**
+   * Unmap the database file and close all the file resources.
+   */
+  void ShutDown() override;
+
+  /**
+   * Write a page, into the mapping if the page lies inside it, or with pwrite() otherwise.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page by copying it out of the mapping. The part of the page that lies past the end of the file reads as
+   * zeros.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /** Write several pages with WritePage(), so that pages inside the mapping are copied into it. */
+  void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) override {
+    DiskManager::WritePages(pages);
+  }
+
+  /** Read several pages with ReadPage(); copying out of the mapping gains nothing from coalescing. */
+  void ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) override { DiskManager::ReadPages(pages); }
+
+  /** msync() the whole mapping, then fdatasync() the file for the pages written past it. */
+  void Sync() override;
+
+  /** msync() the range if it lies inside the mapping, or sync it like PosixDiskManager otherwise. */
+  void SyncRange(page_id_t first_page_id, size_t num_pages) override;
+
+  /**
+   * Change the madvise() hint for the mapping, e.g. to SEQUENTIAL before a scan, so that the OS reads ahead.
+   * @param access_pattern the new hint
+   */
+  void SetAccessPattern(AccessPattern access_pattern);
+
+  /** @return the number of pages currently mapped */
+  auto GetNumMappedPages() -> size_t;
+
+ private:
+  /** Maps all whole pages of the file, replacing the old mapping. The caller holds map_latch_ exclusively. */
+  void Remap();
+
+  /** Unmaps the file. The caller holds map_latch_ exclusively. */
+  void Unmap();
+
+  /** Applies access_pattern_ to the mapping. The caller holds map_latch_. */
+  void Advise();
+
+  /** Protects the mapping itself; held shared while copying from or into it. */
+  std::shared_mutex map_latch_;
+  /** Start of the mapping, or nullptr if nothing is mapped. */
+  char *map_{nullptr};
+  /** Number of whole pages mapped. */
+  size_t map_pages_{0};
+  /** The current madvise() hint. */
+  AccessPattern access_pattern_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posix_disk_manager.h
+//
+// Identification: src/include/storage/disk/posix_disk_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/tablespace.h"
+
+namespace bustub {
+
+/**
+ * PosixDiskManager reads and writes the pages of the database file with positional pread()/pwrite() calls on a file
+ * descriptor. There is no shared file cursor and no latch around page I/O, so reads and writes of different pages
+ * from several threads run in parallel. Offsets are 64 bits wide, so the database file can grow past 2 GB.
+ *
+ * With direct I/O the database file is opened with O_DIRECT, so pages bypass the OS page cache and are cached only
+ * once, in the buffer pool. Buffer pool frames are aligned for it; other buffers that are not aligned to
+ * BUSTUB_PAGE_SIZE go through an aligned bounce buffer. Every page size is a multiple of the O_DIRECT alignment.
+ *
+ * Pages of the DEFAULT_TABLESPACE live in the database file itself. Every other tablespace is a file of its own,
+ * named after the database file with the tablespace id appended ("test.db.3"), so that large scans and bulk loads
+ * of separate tables run as sequential I/O on separate files, and dropping a tablespace gives its space back.
+ * Tablespace files are opened on first use.
+ *
+ * The log and the free space map are handled by DiskManager as before.
+ */
+class PosixDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param direct_io whether to open the database file with O_DIRECT. Falls back to buffered I/O, with a warning,
+   * where the file system does not support it.
+   * @param page_size page size of a new database, see DiskManager
+   */
+  explicit PosixDiskManager(const std::string &db_file, bool direct_io = false, size_t page_size = BUSTUB_PAGE_SIZE);
+
+  ~PosixDiskManager() override;
+
+  /**
+   * Shut down the disk manager and close all the file resources.
+   */
+  void ShutDown() override;
+
+  /**
+   * Write a page to the database file.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @throws Exception if the page could not be written
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page from the database file. The part of the page that lies past the end of the file reads as zeros.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Write several pages. Runs of pages with consecutive ids in the same tablespace are written with one pwritev()
+   * each, so that writing back pages laid out contiguously, e.g. at a checkpoint, becomes a few large sequential
+   * writes.
+   * @param pages ids and raw data of the pages
+   * @throws Exception if a page could not be written; the pages before it may have been
+   */
+  void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) override;
+
+  /**
+   * Read several pages. Runs of pages with consecutive ids in the same tablespace are read with one preadv() each,
+   * so that a read-ahead of pages laid out contiguously costs one system call and one large device read.
+   * @param pages ids of the pages and their output buffers
+   */
+  void ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) override;
+
+  /** fdatasync() the database file and sync the free space map. */
+  void Sync() override;
+
+  /** Write out the range with sync_file_range() on Linux, or fall back to Sync() elsewhere. */
+  void SyncRange(page_id_t first_page_id, size_t num_pages) override;
+
+  /** @return true if the database file is opened with O_DIRECT */
+  auto UsesDirectIo() const -> bool { return direct_io_; }
+
+  /** Create the file of the lowest tablespace id that has none. Throws if all MAX_TABLESPACES are in use. */
+  auto CreateTablespace() -> tablespace_id_t override;
+
+  /** Close and delete the file of the tablespace. */
+  void DropTablespace(tablespace_id_t tablespace_id) override;
+
+  auto GetNumBlocks(tablespace_id_t tablespace_id) -> page_id_t override;
+
+  /** Allocate the blocks of the run with fallocate() (posix_fallocate() outside Linux), growing the file over them. */
+  void PreallocatePages(page_id_t first_page_id, size_t num_pages) override;
+
+ protected:
+  /** @return the byte offset of the page in the file of its tablespace */
+  auto PageOffset(page_id_t page_id) const -> int64_t {
+    return static_cast<int64_t>(BlockOf(page_id)) * static_cast<int64_t>(page_size_);
+  }
+
+  /**
+   * @param page_id id of a page
+   * @param create whether to create the file of the tablespace if it does not exist
+   * @return the file descriptor of the page's tablespace, or -1 if its file does not exist
+   */
+  auto FileOf(page_id_t page_id, bool create) -> int;
+
+  /**
+   * Write the rest of a page, starting at the given byte of the page, without counting the write. With direct I/O the
+   * whole page is written again, since O_DIRECT transfers must be aligned.
+   * @return false on an I/O error
+   */
+  auto PwritePage(page_id_t page_id, const char *page_data, size_t written = 0) -> bool;
+
+  /**
+   * Read the rest of a page, starting at the given byte of the page. The part past the end of the file reads as zeros.
+   * With direct I/O the whole page is read again.
+   * @return false on an I/O error
+   */
+  auto PreadPage(page_id_t page_id, char *page_data, size_t read_count = 0) -> bool;
+
+  /** File descriptor of the database file, or -1 after ShutDown(). */
+  int db_fd_{-1};
+  /** Whether db_fd_ was opened with O_DIRECT. Tablespace files are opened the same way. */
+  bool direct_io_{false};
+
+ private:
+  /** @return the name of the file of the tablespace */
+  auto TablespaceFileName(tablespace_id_t tablespace_id) const -> std::string;
+
+  /** Flags that all files of the database are opened with. */
+  int open_flags_;
+  /** File descriptors of the tablespaces other than the default one, or -1 where not open. */
+  std::array<std::atomic<int>, MAX_TABLESPACES> tablespace_fds_;
+  /** Serializes opening, creating and dropping tablespace files. */
+  std::mutex tablespace_latch_;
+};
+
+}  // namespace bustub
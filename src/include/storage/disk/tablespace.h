@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tablespace.h
+//
+// Identification: src/include/storage/disk/tablespace.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * A page id names a tablespace, i.e. a database file, and a block within it. The low TABLESPACE_BLOCK_BITS bits are
+ * the block number and the bits above them the tablespace id. Pages of the DEFAULT_TABLESPACE therefore have the same
+ * ids as before tablespaces existed, and every valid page id stays non-negative.
+ */
+static_assert(MAX_TABLESPACES <= (1 << (31 - TABLESPACE_BLOCK_BITS)), "tablespace ids must fit into a page id");
+
+/** Number of blocks a tablespace can hold. */
+static constexpr page_id_t BLOCKS_PER_TABLESPACE = 1 << TABLESPACE_BLOCK_BITS;
+
+/** @return the id of the page in the given block of the given tablespace */
+inline auto MakePageId(tablespace_id_t tablespace_id, page_id_t block_no) -> page_id_t {
+  return static_cast<page_id_t>(tablespace_id << TABLESPACE_BLOCK_BITS) | block_no;
+}
+
+/** @return the tablespace the page belongs to */
+inline auto TablespaceOf(page_id_t page_id) -> tablespace_id_t {
+  return static_cast<tablespace_id_t>(page_id) >> TABLESPACE_BLOCK_BITS;
+}
+
+/** @return the block number of the page within its tablespace */
+inline auto BlockOf(page_id_t page_id) -> page_id_t { return page_id & (BLOCKS_PER_TABLESPACE - 1); }
+
+}  // namespace bustub
@@ -13,6 +13,7 @@
 #include <string>
 #include <vector>
 
+#include "buffer/extent_allocator.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
@@ -39,7 +40,8 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     tablespace_id_t tablespace_id = DEFAULT_TABLESPACE);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -70,8 +72,21 @@ class BPlusTree {
   // pushup the delete
   void DeleteFromParent(page_id_t delete_page_id, Transaction *transaction);
 
-  // pushup the insert
-  void InsertInParent(page_id_t other_page_id, const KeyType &Key, Transaction *transaction);
+  // pushup the insert, taking the pages of the splits from new_pages
+  void InsertInParent(page_id_t other_page_id, const KeyType &Key, Transaction *transaction,
+                      std::vector<Page *> *new_pages);
+
+  // one attempt of Insert(); false if the buffer pool ran out of frames and the insert has to start over
+  auto TryInsert(const KeyType &key, const ValueType &value, Transaction *transaction, bool *inserted) -> bool;
+
+  // one attempt of Remove(); false if the buffer pool ran out of frames and the remove has to start over
+  auto TryRemove(const KeyType &key, Transaction *transaction) -> bool;
+
+  // create the pages an insert into the full leaf will split into; false if the buffer pool ran out of frames
+  auto NewSplitPages(LeafPage *leaf_page, Transaction *transaction, std::vector<Page *> *new_pages) -> bool;
+  auto TakeNewPage(std::vector<Page *> *new_pages, page_id_t *page_id) -> Page *;
+  // give the split pages that were not used back to the extent allocator
+  void ReleaseNewPages(std::vector<Page *> *new_pages);
 
   // find the pos which is belonged the key
   auto FindIndex(const KeyType &key, InternalPage *page_id) -> int;
@@ -116,6 +131,8 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  // creates the pages of the tree, in extents of contiguous pages of its tablespace
+  ExtentAllocator extent_allocator_;
   ReaderWriterLatch root_rwlatch_;
 };
 
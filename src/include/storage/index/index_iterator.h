@@ -13,6 +13,7 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include "buffer/read_ahead_tracker.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -40,6 +41,8 @@ class IndexIterator {
   int pos_;
   B_PLUS_TREE_LEAF_PAGE_TYPE *page_;
   BufferPoolManager *buffer_pool_manager_;
+  /** Issues read-ahead once the scan moves over the leaf pages with a regular stride. */
+  ReadAheadTracker read_ahead_;
   // add your own private member variables here
   auto GetPage(page_id_t page_id) -> B_PLUS_TREE_LEAF_PAGE_TYPE *;
 };
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_bitmap_page.h
+//
+// Identification: src/include/storage/page/free_page_bitmap_page.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * Free page bitmap of the page allocator. Bit i of the n-th bitmap page of a buffer pool instance is set if the i-th
+ * page id of that instance past the first n * SLOTS_PER_PAGE ones has been deallocated and can be handed out again.
+ * Bitmap pages live in the free space map file next to the database file, not in the database file itself.
+ *
+ * The first bitmap page of an instance also records the allocator's high-water mark, the number of page ids of the
+ * instance ever handed out. An all-zero page is a valid empty bitmap with a high-water mark of zero.
+ *
+ * Format (size in byte):
+ * -------------------------------------------------------------
+ * | HighWaterMark (4) | NumFree (4) | Bitmap (PAGE_SIZE - 8) |
+ * -------------------------------------------------------------
+ */
+class FreePageBitmapPage {
+ public:
+  /** Number of page ids tracked by one bitmap page. */
+  static constexpr uint32_t SLOTS_PER_PAGE = (BUSTUB_PAGE_SIZE - 2 * sizeof(uint32_t)) * 8;
+
+  /** Clears the bitmap and the high-water mark. */
+  void Init();
+
+  /** @return the high-water mark of the allocator; only meaningful in the first bitmap page */
+  auto GetHighWaterMark() const -> uint32_t { return high_water_mark_; }
+
+  /** @param high_water_mark the new high-water mark of the allocator */
+  void SetHighWaterMark(uint32_t high_water_mark) { high_water_mark_ = high_water_mark; }
+
+  /** @return the number of free slots in this page */
+  auto GetNumFree() const -> uint32_t { return num_free_; }
+
+  /** @return true if the page id in the given slot is free */
+  auto IsFree(uint32_t slot) const -> bool;
+
+  /**
+   * Marks the page id in the given slot free or allocated.
+   * @return false if the slot already was in that state
+   */
+  auto SetFree(uint32_t slot, bool free) -> bool;
+
+  /** @return the lowest free slot, or SLOTS_PER_PAGE if there is none */
+  auto FindFirstFree() const -> uint32_t;
+
+ private:
+  uint32_t high_water_mark_;
+  uint32_t num_free_;
+  uint8_t bitmap_[SLOTS_PER_PAGE / 8];
+};
+
+static_assert(sizeof(FreePageBitmapPage) == BUSTUB_PAGE_SIZE, "a free page bitmap must fill exactly one page");
+
+}  // namespace bustub
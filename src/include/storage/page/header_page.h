@@ -10,6 +10,7 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include "storage/page/page.h"
@@ -17,18 +18,40 @@
 namespace bustub {
 
 /**
- * Database use the first page (page_id = 0) as header page to store metadata, in
- * our case, we will contain information about table/index name (length less than
- * 32 bytes) and their corresponding root_id
+ * Database use the first page (page_id = 0) as header page to store metadata: the page size the database was created
+ * with, and information about table/index name (length less than 32 bytes) and their corresponding root_id. The
+ * magic number tells a header page from a page that was never formatted as one; the page LSN slot that every page has
+ * at offset 4 is left alone.
  *
  * Format (size in byte):
- *  -----------------------------------------------------------------
- * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
- *  -----------------------------------------------------------------
+ *  ------------------------------------------------------------------------------------------------------
+ * | Magic (4) | LSN (4) | PageSize (4) | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
+ *  ------------------------------------------------------------------------------------------------------
  */
 class HeaderPage : public Page {
  public:
-  void Init() { SetRecordCount(0); }
+  /** Size of the part of the header page in front of the records, which is enough to read the page size. */
+  static constexpr size_t DATABASE_HEADER_SIZE = 16;
+
+  /**
+   * Format the page as an empty header page.
+   * @param page_size the page size of the database
+   */
+  void Init(uint32_t page_size = BUSTUB_PAGE_SIZE) { InitData(GetData(), page_size); }
+
+  /**
+   * Format raw page data as an empty header page, e.g. before the buffer pool of a new database exists.
+   * @param[out] data at least DATABASE_HEADER_SIZE bytes
+   * @param page_size the page size of the database
+   */
+  static void InitData(char *data, uint32_t page_size);
+
+  /**
+   * @param data the first DATABASE_HEADER_SIZE bytes of the database file
+   * @return the page size recorded in the header page, or 0 if the data is not a header page
+   */
+  static auto ReadPageSize(const char *data) -> uint32_t;
+
   /**
    * Record related
    */
@@ -41,6 +64,13 @@ class HeaderPage : public Page {
   auto GetRecordCount() -> int;
 
  private:
+  static constexpr uint32_t MAGIC = 0x62757374;  // "bust"
+  static constexpr size_t OFFSET_MAGIC = 0;
+  static constexpr size_t OFFSET_PAGE_SIZE = 8;
+  static constexpr size_t OFFSET_RECORD_COUNT = 12;
+  static constexpr size_t OFFSET_RECORDS = DATABASE_HEADER_SIZE;
+  static constexpr size_t RECORD_SIZE = 36;
+
   /**
    * helper functions
    */
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
 #include <cstring>
 #include <iostream>
 
@@ -20,6 +21,19 @@
 
 namespace bustub {
 
+/**
+ * The I/O state of a buffer pool frame. Disk I/O is done without holding the buffer pool latch, so a frame whose
+ * contents are still being written back or read in stays pinned and is marked as in flight until the I/O completes.
+ */
+enum class PageIOState {
+  /** The frame holds the contents of its page and can be used. */
+  READY,
+  /** The frame is being filled with its page from disk. */
+  READING,
+  /** The previous contents of the frame are being written back to disk before the frame is reused. */
+  WRITING
+};
+
 /**
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
@@ -28,10 +42,11 @@ namespace bustub {
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
+  friend class FrameChunk;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The page data is attached by the FrameChunk that owns the frame, zeroed. */
+  Page() = default;
 
   /** Default destructor. */
   ~Page() = default;
@@ -39,6 +54,9 @@ class Page {
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
 
+  /** @return the size of the page data, the page size of the database */
+  inline auto GetPageSize() const -> size_t { return page_size_; }
+
   /** @return the page id of this page */
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
@@ -76,16 +94,22 @@ class Page {
 
  private:
   /** Zeroes out the data that is held within the page. */
-  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, BUSTUB_PAGE_SIZE); }
+  inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, page_size_); }
 
-  /** The actual data that is stored within a page. */
-  char data_[BUSTUB_PAGE_SIZE]{};
+  /** The actual data that is stored within a page. Points into the aligned frame memory of a FrameChunk. */
+  char *data_{nullptr};
+  /** The size of data_. */
+  size_t page_size_{BUSTUB_PAGE_SIZE};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
   int pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
+  /** The I/O state of the frame holding this page. Protected by the buffer pool latch. */
+  PageIOState io_state_ = PageIOState::READY;
+  /** Signaled whenever the I/O on this frame completes. Waited on together with the buffer pool latch. */
+  std::condition_variable io_cv_;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
@@ -113,6 +113,15 @@ class TablePage : public Page {
   /** To be called on abort. Rollback a delete, i.e. this reverses a MarkDelete. */
   void RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
 
+  /**
+   * Put a tuple back into the empty slot it was deleted from. Recovery undoes ApplyDelete() with this; it is not
+   * logged.
+   * @param tuple the deleted tuple
+   * @param rid rid the tuple had
+   * @return false if the slot is in use again or the page lacks the space
+   */
+  auto RestoreTuple(const Tuple &tuple, const RID &rid) -> bool;
+
   /**
    * Read a tuple from a table.
    * @param rid rid of the tuple to read
@@ -12,7 +12,11 @@
 
 #pragma once
 
+#include <atomic>
+
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/extent_allocator.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
@@ -22,7 +26,8 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages. All pages live in the tablespace of the first page, and are created in
+ * extents of contiguous pages, so that the list mostly runs forward through the file.
  */
 class TableHeap {
   friend class TableIterator;
@@ -46,18 +51,20 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param tablespace_id the tablespace to allocate the pages of the table in
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, tablespace_id_t tablespace_id = DEFAULT_TABLESPACE);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy the buffer access strategy of a bulk insert, or nullptr to use the whole buffer pool
    * @return true iff the insert is successful
    */
-  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr) -> bool;
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -99,8 +106,12 @@ class TableHeap {
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
 
-  /** @return the begin iterator of this table */
-  auto Begin(Transaction *txn) -> TableIterator;
+  /**
+   * @param txn the transaction performing the scan
+   * @param strategy the buffer access strategy of a bulk scan, or nullptr to use the whole buffer pool
+   * @return the begin iterator of this table
+   */
+  auto Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr) -> TableIterator;
 
   /** @return the end iterator of this table */
   auto End() -> TableIterator;
@@ -108,11 +119,17 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return the number of pages this table heap has created; 0 for a table heap opened on existing pages */
+  inline auto GetNumPages() const -> size_t { return num_pages_; }
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  std::atomic<size_t> num_pages_{0};
+  /** Creates the pages of the table. */
+  ExtentAllocator extent_allocator_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,8 @@
 
 #include <cassert>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/read_ahead_tracker.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -29,10 +31,14 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_),
+        read_ahead_(other.read_ahead_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -54,6 +60,8 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
+    read_ahead_ = other.read_ahead_;
     return *this;
   }
 
@@ -61,6 +69,10 @@ class TableIterator {
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** The buffer access strategy of a bulk scan, or nullptr if the scan uses the whole buffer pool. */
+  BufferAccessStrategy *strategy_;
+  /** Issues read-ahead once the scan moves over the table pages with a regular stride. */
+  ReadAheadTracker read_ahead_;
 };
 
 }  // namespace bustub
@@ -12,16 +12,94 @@
 
 #include "recovery/checkpoint_manager.h"
 
+#include <algorithm>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
 namespace bustub {
 
+CheckpointManager::~CheckpointManager() {
+  if (flush_thread_.joinable()) {
+    flush_thread_.join();
+  }
+}
+
 void CheckpointManager::BeginCheckpoint() {
-  // Block all the transactions and ensure that both the WAL and all dirty buffer pool pages are persisted to disk,
-  // creating a consistent checkpoint. Do NOT allow transactions to resume at the end of this method, resume them
-  // in CheckpointManager::EndCheckpoint() instead. This is for grading purposes.
+  BUSTUB_ASSERT(enable_logging, "A checkpoint needs logging.");
+  BUSTUB_ASSERT(!flush_thread_.joinable(), "The previous checkpoint did not end.");
+  LogRecord begin(INVALID_TXN_ID, INVALID_LSN, LogRecordType::BEGIN_CHECKPOINT);
+  begin_lsn_ = log_manager_->AppendLogRecord(&begin);
+  begin_log_offset_ = begin.GetLogOffset();
+  // Every change logged before the record is done, or in progress on a page that is pinned, so it is on one of these
+  // pages, or on disk already.
+  flush_thread_ = std::thread(&CheckpointManager::FlushPages, this, buffer_pool_manager_->GetDirtyPages());
 }
 
 void CheckpointManager::EndCheckpoint() {
-  // Allow transactions to resume, completing the checkpoint.
+  BUSTUB_ASSERT(flush_thread_.joinable(), "No checkpoint was begun.");
+  flush_thread_.join();
+  if (flush_error_ != nullptr) {
+    // The pages may not be durable, so the checkpoint must not become the start of recovery.
+    auto error = std::exchange(flush_error_, nullptr);
+    std::rethrow_exception(error);
+  }
+
+  // Every page dirty now was changed after BEGIN_CHECKPOINT or written back and changed again since.
+  std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+  for (auto page_id : buffer_pool_manager_->GetDirtyPages()) {
+    dirty_pages.emplace_back(page_id, begin_lsn_);
+  }
+  std::vector<std::pair<txn_id_t, lsn_t>> active_txns;
+  int64_t log_offset = begin_log_offset_;
+  for (const auto &txn : transaction_manager_->GetActiveTransactions()) {
+    active_txns.emplace_back(txn.txn_id_, txn.last_lsn_);
+    log_offset = std::min(log_offset, txn.begin_log_offset_);
+  }
+
+  // Split the tables over as many records as it takes for each to fit into the log buffer.
+  const size_t entry_size = sizeof(int32_t) + sizeof(lsn_t);
+  const size_t max_entries =
+      (log_manager_->GetLogBufferSize() - LogRecord::HEADER_SIZE - 2 * sizeof(int32_t)) / entry_size;
+  size_t next_txn = 0;
+  size_t next_page = 0;
+  lsn_t end_lsn = INVALID_LSN;
+  do {
+    const size_t num_txns = std::min(max_entries, active_txns.size() - next_txn);
+    const size_t num_pages = std::min(max_entries - num_txns, dirty_pages.size() - next_page);
+    LogRecord end(begin_lsn_, LogRecordType::END_CHECKPOINT,
+                  {active_txns.begin() + next_txn, active_txns.begin() + next_txn + num_txns},
+                  {dirty_pages.begin() + next_page, dirty_pages.begin() + next_page + num_pages});
+    end_lsn = log_manager_->AppendLogRecord(&end);
+    next_txn += num_txns;
+    next_page += num_pages;
+  } while (next_txn < active_txns.size() || next_page < dirty_pages.size());
+  log_manager_->Flush(end_lsn);
+
+  // Only now that all of it is durable does recovery start from this checkpoint.
+  MasterRecord master_record;
+  master_record.checkpoint_lsn_ = begin_lsn_;
+  master_record.log_offset_ = log_offset;
+  disk_manager_->WriteMasterRecord(master_record);
+}
+
+void CheckpointManager::FlushPages(std::vector<page_id_t> page_ids) {
+  // The writes of a batch go out sorted by page id; batches in page id order keep them close to sequential.
+  std::sort(page_ids.begin(), page_ids.end());
+  size_t begin = 0;
+  try {
+    do {
+      const size_t end = std::min(page_ids.size(), begin + CHECKPOINT_FLUSH_BATCH);
+      // Even an empty batch syncs, which makes the writes of pages evicted in the meantime durable as well.
+      buffer_pool_manager_->FlushPages(std::vector<page_id_t>(page_ids.begin() + begin, page_ids.begin() + end));
+      begin = end;
+      // leave the disk and the buffer pool latch to the transactions for a moment
+      std::this_thread::yield();
+    } while (begin < page_ids.size());
+  } catch (const Exception &) {
+    flush_error_ = std::current_exception();
+  }
 }
 
 }  // namespace bustub
@@ -12,7 +12,45 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
 namespace bustub {
+
+namespace {
+/** @return the smallest power of two that is at least n */
+auto RoundUpToPowerOfTwo(size_t n) -> size_t {
+  size_t power = 1;
+  while (power < n) {
+    power <<= 1;
+  }
+  return power;
+}
+}  // namespace
+
+LogManager::LogManager(DiskManager *disk_manager)
+    : persistent_lsn_(INVALID_LSN),
+      log_file_offset_(disk_manager == nullptr ? 0 : disk_manager->GetLogSize()),
+      // the ring must hold the largest record: an update of a tuple that fills a page
+      log_buffer_size_(RoundUpToPowerOfTwo(std::max<size_t>(
+          LOG_BUFFER_SIZE, disk_manager == nullptr ? 0 : 2 * disk_manager->GetPageSize() + MAX_RECORD_OVERHEAD))),
+      disk_manager_(disk_manager) {
+  log_buffer_ = new char[log_buffer_size_];
+  flush_buffer_ = new char[log_buffer_size_];
+}
+
+LogManager::~LogManager() {
+  StopFlushThread();
+  delete[] log_buffer_;
+  delete[] flush_buffer_;
+  log_buffer_ = nullptr;
+  flush_buffer_ = nullptr;
+}
+
 /*
  * set enable_logging = true
  * Start a separate thread to execute flush to disk operation periodically
@@ -22,33 +60,318 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock lock(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  stop_flush_thread_ = false;
+  enable_logging = true;
+  flush_thread_ = new std::thread(&LogManager::FlushLoop, this);
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  {
+    std::scoped_lock lock(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    stop_flush_thread_ = true;
+  }
+  cv_.notify_one();
+  flush_thread_->join();
+  delete flush_thread_;
+  enable_logging = false;
+  std::scoped_lock lock(latch_);
+  flush_thread_ = nullptr;
+  // wake up appenders that waited for the thread while it was exiting; they flush on their own now
+  flushed_cv_.notify_all();
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t { return INVALID_LSN; }
+auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t {
+  const auto size = static_cast<size_t>(log_record->size_);
+  if (size > log_buffer_size_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "log record does not fit into the log buffer");
+  }
+  auto &slot = AcquireSlot();
+  // Claim the LSN and the bytes of the record at once, so that records are in LSN order in the log.
+  const uint64_t insert_point = insert_point_.fetch_add((static_cast<uint64_t>(size) << 32) + 1);
+  slot.insert_point_ = insert_point;
+  log_record->lsn_ = LsnOf(insert_point);
+  const uint32_t pos = PosOf(insert_point);
+  log_record->log_offset_ = log_file_offset_ + static_cast<int64_t>(ToLogPosition(pos));
+  WaitForSpace(pos, size);
+
+  const size_t offset = pos & (log_buffer_size_ - 1);
+  if (offset + size <= log_buffer_size_) {
+    SerializeLogRecord(*log_record, log_buffer_ + offset);
+  } else {
+    // the record wraps around the end of the ring
+    thread_local std::vector<char> record;
+    record.resize(size);
+    SerializeLogRecord(*log_record, record.data());
+    const size_t head = log_buffer_size_ - offset;
+    memcpy(log_buffer_ + offset, record.data(), head);
+    memcpy(log_buffer_, record.data() + head, size - head);
+  }
+  slot.insert_point_ = IDLE_SLOT;
+  return log_record->lsn_;
+}
+
+void LogManager::SetNextLSN(lsn_t lsn) {
+  std::scoped_lock lock(latch_);
+  BUSTUB_ASSERT(insert_point_ == 0, "the LSNs can only be set before the first record");
+  insert_point_ = static_cast<uint64_t>(lsn);
+  persistent_lsn_ = lsn - 1;
+}
+
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock lock(latch_);
+  lsn = std::min<lsn_t>(lsn, GetNextLSN() - 1);
+  while (persistent_lsn_ < lsn) {
+    RequestFlush(lock);
+  }
+}
+
+void LogManager::FlushAsync(lsn_t lsn) {
+  lsn = std::min<lsn_t>(lsn, GetNextLSN() - 1);
+  if (lsn <= persistent_lsn_) {
+    return;
+  }
+  lsn_t scheduled = async_flush_lsn_;
+  while (scheduled < lsn && !async_flush_lsn_.compare_exchange_weak(scheduled, lsn)) {
+  }
+  // Only the first request past the persistent LSN wakes the flush thread; it flushes the later ones along with it.
+  if (enable_logging && scheduled > persistent_lsn_) {
+    return;
+  }
+  std::unique_lock lock(latch_);
+  if (flush_thread_ == nullptr || stop_flush_thread_) {
+    while (persistent_lsn_ < lsn) {
+      FlushLogBuffer(lock);
+    }
+    return;
+  }
+  cv_.notify_one();
+}
+
+void LogManager::WaitForLSN(lsn_t lsn) {
+  std::unique_lock lock(latch_);
+  lsn = std::min<lsn_t>(lsn, GetNextLSN() - 1);
+  while (persistent_lsn_ < lsn) {
+    if (write_error_ != nullptr) {
+      std::rethrow_exception(write_error_);
+    }
+    if (flush_thread_ == nullptr || stop_flush_thread_) {
+      FlushLogBuffer(lock);
+    } else {
+      flushed_cv_.wait(lock);
+    }
+  }
+}
+
+auto LogManager::AcquireSlot() -> InsertSlot & {
+  const size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+  while (true) {
+    for (size_t i = 0; i < slots_.size(); i++) {
+      auto &slot = slots_[(start + i) % slots_.size()];
+      // The current insertion point is a lower bound of where the record will start, so the flush can't pass the
+      // record between taking the slot and claiming the bytes.
+      uint64_t expected = IDLE_SLOT;
+      if (slot.insert_point_.compare_exchange_strong(expected, insert_point_.load())) {
+        return slot;
+      }
+    }
+    std::this_thread::yield();
+  }
+}
+
+void LogManager::WaitForSpace(uint32_t pos, size_t size) {
+  auto fits = [&] {
+    return static_cast<size_t>(pos - static_cast<uint32_t>(flushed_pos_.load())) + size <= log_buffer_size_;
+  };
+  if (fits()) {
+    return;
+  }
+  std::unique_lock lock(latch_);
+  while (!fits()) {
+    RequestFlush(lock);
+  }
+}
+
+void LogManager::FlushLoop() {
+  std::unique_lock lock(latch_);
+  try {
+    while (!stop_flush_thread_) {
+      auto async_pending = [&] { return async_flush_lsn_ > persistent_lsn_; };
+      cv_.wait_for(lock, log_timeout, [&] { return stop_flush_thread_ || flush_requested_ || async_pending(); });
+      if (async_pending()) {
+        // let the asynchronous commits of the next async_commit_lag share the sync
+        cv_.wait_for(lock, async_commit_lag, [&] { return stop_flush_thread_ || flush_requested_; });
+      }
+      // A record still being copied in may hold the flush back; the LSNs due by now must not wait for the next round.
+      const lsn_t due = async_flush_lsn_;
+      do {
+        FlushLogBuffer(lock);
+      } while (persistent_lsn_ < due);
+    }
+    // write out what is left
+    FlushLogBuffer(lock);
+  } catch (const Exception &) {
+    // write_error_ is set and the waiters are woken up; they rethrow it.
+  }
+}
+
+void LogManager::FlushLogBuffer(std::unique_lock<std::mutex> &lock) {
+  // one write at a time, in log order
+  flushed_cv_.wait(lock, [&] { return !flushing_; });
+  if (write_error_ != nullptr) {
+    std::rethrow_exception(write_error_);
+  }
+  flush_requested_ = false;
+
+  // The log is complete up to the insertion point, except past the first record still being copied in.
+  const uint64_t flushed_pos = flushed_pos_;
+  const auto flushed = static_cast<uint32_t>(flushed_pos);
+  uint64_t end = insert_point_.load();
+  for (auto &slot : slots_) {
+    const uint64_t slot_insert_point = slot.insert_point_.load();
+    if (slot_insert_point == IDLE_SLOT) {
+      continue;
+    }
+    // A stale lower bound from before the last flush means the appender has not claimed its bytes yet; it may get
+    // any of them, so nothing can be written.
+    const auto distance = static_cast<int32_t>(PosOf(slot_insert_point) - flushed);
+    if (distance <= 0) {
+      end = static_cast<uint64_t>(flushed) << 32;
+      break;
+    }
+    if (static_cast<uint32_t>(distance) < PosOf(end) - flushed) {
+      end = slot_insert_point;
+    }
+  }
+  const size_t size = PosOf(end) - flushed;
+  if (size == 0) {
+    // let the records in progress complete
+    lock.unlock();
+    std::this_thread::yield();
+    lock.lock();
+    flushed_cv_.notify_all();
+    return;
+  }
+  flushing_ = true;
+  lock.unlock();
+
+  const size_t offset = flushed_pos & (log_buffer_size_ - 1);
+  char *data = log_buffer_ + offset;
+  if (offset + size > log_buffer_size_) {
+    const size_t head = log_buffer_size_ - offset;
+    memcpy(flush_buffer_, data, head);
+    memcpy(flush_buffer_ + head, log_buffer_, size - head);
+    data = flush_buffer_;
+  }
+  // one write and one sync for every record of the batch
+  try {
+    disk_manager_->WriteLog(data, static_cast<int>(size));
+  } catch (const Exception &) {
+    // The records are not durable, and neither is anything after them: fail every flush from now on.
+    lock.lock();
+    write_error_ = std::current_exception();
+    flushing_ = false;
+    flushed_cv_.notify_all();
+    throw;
+  }
+
+  lock.lock();
+  flushed_pos_ = flushed_pos + size;
+  persistent_lsn_ = LsnOf(end) - 1;
+  flushing_ = false;
+  flushed_cv_.notify_all();
+}
+
+void LogManager::RequestFlush(std::unique_lock<std::mutex> &lock) {
+  if (write_error_ != nullptr) {
+    std::rethrow_exception(write_error_);
+  }
+  if (flush_thread_ != nullptr && !stop_flush_thread_) {
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+    return;
+  }
+  FlushLogBuffer(lock);
+}
+
+void LogManager::SerializeLogRecord(const LogRecord &log_record, char *data) {
+  // the header: size, LSN, transaction id, previous LSN and type
+  const auto log_record_type = static_cast<int32_t>(log_record.log_record_type_);
+  memcpy(data, &log_record.size_, sizeof(int32_t));
+  memcpy(data + 4, &log_record.lsn_, sizeof(lsn_t));
+  memcpy(data + 8, &log_record.txn_id_, sizeof(txn_id_t));
+  memcpy(data + 12, &log_record.prev_lsn_, sizeof(lsn_t));
+  memcpy(data + 16, &log_record_type, sizeof(int32_t));
+  char *pos = data + LogRecord::HEADER_SIZE;
+  LogRecordType body_type = log_record.log_record_type_;
+  if (body_type == LogRecordType::CLR) {
+    // the undo-next LSN and the type of the undone record, followed by its body
+    const auto undone_type = static_cast<int32_t>(log_record.undone_type_);
+    memcpy(pos, &log_record.undo_next_lsn_, sizeof(lsn_t));
+    memcpy(pos + sizeof(lsn_t), &undone_type, sizeof(int32_t));
+    pos += sizeof(lsn_t) + sizeof(int32_t);
+    body_type = log_record.undone_type_;
+  }
+  switch (body_type) {
+    case LogRecordType::INSERT:
+      memcpy(pos, &log_record.insert_rid_, sizeof(RID));
+      log_record.insert_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(pos, &log_record.delete_rid_, sizeof(RID));
+      log_record.delete_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(pos, &log_record.update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record.old_tuple_.SerializeTo(pos);
+      pos += sizeof(int32_t) + log_record.old_tuple_.GetLength();
+      log_record.new_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record.prev_page_id_, sizeof(page_id_t));
+      memcpy(pos + sizeof(page_id_t), &log_record.page_id_, sizeof(page_id_t));
+      break;
+    case LogRecordType::END_CHECKPOINT: {
+      const auto txn_count = static_cast<int32_t>(log_record.active_txns_.size());
+      memcpy(pos, &txn_count, sizeof(int32_t));
+      pos += sizeof(int32_t);
+      for (const auto &[txn_id, last_lsn] : log_record.active_txns_) {
+        memcpy(pos, &txn_id, sizeof(txn_id_t));
+        memcpy(pos + sizeof(txn_id_t), &last_lsn, sizeof(lsn_t));
+        pos += sizeof(txn_id_t) + sizeof(lsn_t);
+      }
+      const auto page_count = static_cast<int32_t>(log_record.dirty_pages_.size());
+      memcpy(pos, &page_count, sizeof(int32_t));
+      pos += sizeof(int32_t);
+      for (const auto &[page_id, rec_lsn] : log_record.dirty_pages_) {
+        memcpy(pos, &page_id, sizeof(page_id_t));
+        memcpy(pos + sizeof(page_id_t), &rec_lsn, sizeof(lsn_t));
+        pos += sizeof(page_id_t) + sizeof(lsn_t);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
 
 }  // namespace bustub
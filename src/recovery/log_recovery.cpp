@@ -12,6 +12,14 @@
 
 #include "recovery/log_recovery.h"
 
+#include <atomic>
+#include <cstring>
+#include <future>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+
+#include "common/macros.h"
 #include "storage/page/table_page.h"
 
 namespace bustub {
@@ -20,7 +28,89 @@ namespace bustub {
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-auto LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) -> bool { return false; }
+auto LogRecovery::DeserializeLogRecord(const char *data, size_t size, LogRecord *log_record) -> bool {
+  if (size < static_cast<size_t>(LogRecord::HEADER_SIZE)) {
+    return false;
+  }
+  int32_t log_record_type;
+  memcpy(&log_record->size_, data, sizeof(int32_t));
+  memcpy(&log_record->lsn_, data + 4, sizeof(lsn_t));
+  memcpy(&log_record->txn_id_, data + 8, sizeof(txn_id_t));
+  memcpy(&log_record->prev_lsn_, data + 12, sizeof(lsn_t));
+  memcpy(&log_record_type, data + 16, sizeof(int32_t));
+  // The log ends at a record of size 0, where the log file is read past its end.
+  if (log_record->size_ < LogRecord::HEADER_SIZE || size < static_cast<size_t>(log_record->size_) ||
+      log_record_type <= static_cast<int32_t>(LogRecordType::INVALID) ||
+      log_record_type > static_cast<int32_t>(LogRecordType::CLR)) {
+    return false;
+  }
+  log_record->log_record_type_ = static_cast<LogRecordType>(log_record_type);
+
+  const char *pos = data + LogRecord::HEADER_SIZE;
+  LogRecordType body_type = log_record->log_record_type_;
+  if (body_type == LogRecordType::CLR) {
+    int32_t undone_type;
+    memcpy(&log_record->undo_next_lsn_, pos, sizeof(lsn_t));
+    memcpy(&undone_type, pos + sizeof(lsn_t), sizeof(int32_t));
+    if (undone_type < static_cast<int32_t>(LogRecordType::INSERT) ||
+        undone_type > static_cast<int32_t>(LogRecordType::UPDATE)) {
+      return false;
+    }
+    pos += sizeof(lsn_t) + sizeof(int32_t);
+    log_record->undone_type_ = static_cast<LogRecordType>(undone_type);
+    body_type = log_record->undone_type_;
+  }
+  switch (body_type) {
+    case LogRecordType::INSERT:
+      memcpy(&log_record->insert_rid_, pos, sizeof(RID));
+      log_record->insert_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(&log_record->delete_rid_, pos, sizeof(RID));
+      log_record->delete_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(&log_record->update_rid_, pos, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.DeserializeFrom(pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.DeserializeFrom(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(&log_record->prev_page_id_, pos, sizeof(page_id_t));
+      memcpy(&log_record->page_id_, pos + sizeof(page_id_t), sizeof(page_id_t));
+      break;
+    case LogRecordType::END_CHECKPOINT: {
+      const char *end = data + log_record->size_;
+      const size_t entry_size = sizeof(int32_t) + sizeof(lsn_t);
+      int32_t count;
+      log_record->active_txns_.clear();
+      log_record->dirty_pages_.clear();
+      for (auto *table : {&log_record->active_txns_, &log_record->dirty_pages_}) {
+        if (end - pos < static_cast<int64_t>(sizeof(int32_t))) {
+          return false;
+        }
+        memcpy(&count, pos, sizeof(int32_t));
+        pos += sizeof(int32_t);
+        if (count < 0 || static_cast<size_t>(end - pos) < count * entry_size) {
+          return false;
+        }
+        table->resize(count);
+        for (auto &[id, lsn] : *table) {
+          memcpy(&id, pos, sizeof(int32_t));
+          memcpy(&lsn, pos + sizeof(int32_t), sizeof(lsn_t));
+          pos += entry_size;
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return true;
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
@@ -29,12 +119,378 @@ auto LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record)
  *LSN with log_record's sequence number, and also build active_txn_ table &
  *lsn_mapping_ table
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  BUSTUB_ASSERT(!enable_logging, "Recovery must not write log records.");
+  ReadLog();
+  // New records must be newer than the page LSNs, or the next recovery would take them to be on the pages already.
+  log_manager_->SetNextLSN(next_lsn_);
+
+  // Partition the records by page; a record that changes two pages goes to both of their partitions.
+  std::vector<std::vector<std::pair<page_id_t, size_t>>> partitions(num_threads_);
+  auto add = [&](page_id_t page_id, size_t index) {
+    if (page_id != INVALID_PAGE_ID) {
+      partitions[static_cast<size_t>(page_id) % num_threads_].emplace_back(page_id, index);
+    }
+  };
+  for (size_t i = 0; i < records_.size(); i++) {
+    auto &log_record = records_[i];
+    if (log_record.lsn_ < redo_lsn_) {
+      continue;
+    }
+    switch (log_record.log_record_type_) {
+      case LogRecordType::INSERT:
+        add(log_record.insert_rid_.GetPageId(), i);
+        break;
+      case LogRecordType::MARKDELETE:
+      case LogRecordType::APPLYDELETE:
+      case LogRecordType::ROLLBACKDELETE:
+        add(log_record.delete_rid_.GetPageId(), i);
+        break;
+      case LogRecordType::UPDATE:
+        add(log_record.update_rid_.GetPageId(), i);
+        break;
+      case LogRecordType::NEWPAGE:
+        add(log_record.page_id_, i);
+        add(log_record.prev_page_id_, i);
+        break;
+      case LogRecordType::CLR:
+        add(RIDOf(log_record, log_record.undone_type_).GetPageId(), i);
+        break;
+      default:
+        break;
+    }
+  }
+
+  std::vector<std::thread> workers;
+  for (auto &partition : partitions) {
+    if (!partition.empty()) {
+      workers.emplace_back(&LogRecovery::RedoPages, this, &partition);
+    }
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
  *iterate through active txn map and undo each operation
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  BUSTUB_ASSERT(!enable_logging, "Recovery must not write log records.");
+  std::vector<std::pair<txn_id_t, lsn_t>> losers(active_txn_.begin(), active_txn_.end());
+  // The losers held their locks until the crash, so they changed different tuples and can be undone in parallel.
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < std::min(num_threads_, losers.size()); i++) {
+    workers.emplace_back([&] {
+      for (size_t loser = next++; loser < losers.size(); loser = next++) {
+        UndoTransaction(losers[loser].first, losers[loser].second);
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  active_txn_.clear();
+  // The CLRs and ABORT records spare the next recovery from undoing the losers again.
+  log_manager_->Flush(log_manager_->GetNextLSN() - 1);
+}
+
+void LogRecovery::ReadLog() {
+  // A chunk holds at least the largest record, a tuple update of a page-sized tuple.
+  const size_t chunk_size =
+      std::max<size_t>(RECOVERY_LOG_READ_SIZE, 2 * buffer_pool_manager_->GetPageSize() + LogRecord::HEADER_SIZE * 4);
+  // the record cut off at the end of the previous chunk, followed by the current chunk
+  std::vector<char> buffer(2 * chunk_size);
+  std::vector<char> chunk(chunk_size);
+  auto read_chunk = [&](int64_t offset) {
+    return disk_manager_->ReadLog(chunk.data(), static_cast<int>(chunk_size), offset);
+  };
+
+  records_.clear();
+  active_txn_.clear();
+  lsn_mapping_.clear();
+  const MasterRecord master_record = disk_manager_->ReadMasterRecord();
+  redo_lsn_ = master_record.checkpoint_lsn_;
+  next_lsn_ = 0;
+  // Transactions the log shows to have finished; the active transaction table may still list them.
+  std::unordered_set<txn_id_t> finished_txns;
+  int64_t offset = master_record.log_offset_;
+  size_t carry = 0;
+  bool end_of_log = false;
+  auto next_chunk = std::async(std::launch::async, read_chunk, offset);
+  while (!end_of_log && next_chunk.get()) {
+    memcpy(buffer.data() + carry, chunk.data(), chunk_size);
+    offset += static_cast<int64_t>(chunk_size);
+    // read the next chunk while this one is parsed
+    next_chunk = std::async(std::launch::async, read_chunk, offset);
+
+    const size_t size = carry + chunk_size;
+    size_t pos = 0;
+    while (true) {
+      auto &log_record = records_.emplace_back();
+      if (!DeserializeLogRecord(buffer.data() + pos, size - pos, &log_record)) {
+        // Either the record continues in the next chunk, or the log ends here and the rest is zeros.
+        end_of_log = size - pos >= static_cast<size_t>(LogRecord::HEADER_SIZE) &&
+                     log_record.size_ <= static_cast<int32_t>(size - pos);
+        records_.pop_back();
+        break;
+      }
+      pos += log_record.size_;
+      lsn_mapping_[log_record.lsn_] = records_.size() - 1;
+      next_lsn_ = std::max(next_lsn_, log_record.lsn_ + 1);
+      switch (log_record.log_record_type_) {
+        case LogRecordType::COMMIT:
+        case LogRecordType::ABORT:
+          active_txn_.erase(log_record.txn_id_);
+          finished_txns.insert(log_record.txn_id_);
+          break;
+        case LogRecordType::BEGIN_CHECKPOINT:
+          break;
+        case LogRecordType::END_CHECKPOINT:
+          // Only the checkpoint of the master record is complete; a later one may lack some of its records.
+          if (log_record.prev_lsn_ != master_record.checkpoint_lsn_) {
+            break;
+          }
+          for (const auto &[txn_id, last_lsn] : log_record.active_txns_) {
+            if (finished_txns.count(txn_id) == 0) {
+              auto [it, inserted] = active_txn_.try_emplace(txn_id, last_lsn);
+              it->second = std::max(it->second, last_lsn);
+            }
+          }
+          for (const auto &dirty_page : log_record.dirty_pages_) {
+            redo_lsn_ = std::min(redo_lsn_, dirty_page.second);
+          }
+          break;
+        default:
+          active_txn_[log_record.txn_id_] = log_record.lsn_;
+          break;
+      }
+    }
+    carry = size - pos;
+    memmove(buffer.data(), buffer.data() + pos, carry);
+  }
+  if (next_chunk.valid()) {
+    next_chunk.wait();
+  }
+}
+
+void LogRecovery::RedoPages(std::vector<std::pair<page_id_t, size_t>> *records) {
+  // Group the records by page, keeping the LSN order within a page.
+  std::stable_sort(records->begin(), records->end(),
+                   [](const auto &a, const auto &b) { return a.first < b.first; });
+  std::vector<page_id_t> page_ids;
+  std::vector<size_t> page_starts;
+  for (size_t i = 0; i < records->size(); i++) {
+    if (page_ids.empty() || page_ids.back() != (*records)[i].first) {
+      page_ids.push_back((*records)[i].first);
+      page_starts.push_back(i);
+    }
+  }
+  page_starts.push_back(records->size());
+
+  const size_t window = READ_AHEAD_PAGES;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    // read the pages of the next window while the ones of this window are redone
+    if (i % window == 0) {
+      auto begin = page_ids.begin() + static_cast<int64_t>(std::min(page_ids.size(), i == 0 ? 0 : i + window));
+      auto end = page_ids.begin() + static_cast<int64_t>(std::min(page_ids.size(), i + 2 * window));
+      if (begin < end) {
+        buffer_pool_manager_->PrefetchPages(std::vector<page_id_t>(begin, end));
+      }
+    }
+    auto *page = FetchTablePage(page_ids[i]);
+    bool is_dirty = false;
+    page->WLatch();
+    for (size_t j = page_starts[i]; j < page_starts[i + 1]; j++) {
+      is_dirty = RedoRecord(page, &records_[(*records)[j].second]) || is_dirty;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_ids[i], is_dirty);
+  }
+}
+
+auto LogRecovery::RedoRecord(TablePage *page, LogRecord *log_record) -> bool {
+  const page_id_t page_id = page->GetPageId();
+  if (log_record->log_record_type_ == LogRecordType::NEWPAGE) {
+    if (page_id != log_record->page_id_) {
+      // The previous page of the new one: link it. The page LSN does not cover this, but linking is idempotent.
+      if (page->GetNextPageId() == log_record->page_id_) {
+        return false;
+      }
+      page->SetNextPageId(log_record->page_id_);
+      return true;
+    }
+    // A new page may never have been written, in which case it holds zeros and no LSN yet.
+    if (page->GetTablePageId() == page_id && page->GetLSN() >= log_record->lsn_) {
+      return false;
+    }
+    page->Init(page_id, buffer_pool_manager_->GetPageSize(), log_record->prev_page_id_, nullptr, nullptr);
+    page->SetLSN(log_record->lsn_);
+    return true;
+  }
+
+  if (page->GetLSN() >= log_record->lsn_) {
+    return false;
+  }
+  if (log_record->log_record_type_ == LogRecordType::CLR) {
+    if (log_record->undone_type_ == LogRecordType::APPLYDELETE) {
+      // The CLR has the slot the undo put the tuple into, and the page is as it was then: the slot is free again, or
+      // the undo added it.
+      const Tuple &tuple = log_record->delete_tuple_;
+      const RID &rid = log_record->delete_rid_;
+      RID new_rid;
+      const bool restored = page->RestoreTuple(tuple, rid) ||
+                            (page->InsertTuple(tuple, &new_rid, nullptr, nullptr, nullptr) && new_rid == rid);
+      BUSTUB_ASSERT(restored, "redo of an undone delete must put the tuple into the slot the undo did");
+    } else {
+      UndoRecord(page, log_record, log_record->undone_type_);
+    }
+    page->SetLSN(log_record->lsn_);
+    return true;
+  }
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT: {
+      // The page is as it was before the insert, so the tuple goes into the same slot again.
+      RID rid;
+      const bool inserted = page->InsertTuple(log_record->insert_tuple_, &rid, nullptr, nullptr, nullptr);
+      BUSTUB_ASSERT(inserted && rid == log_record->insert_rid_, "redo of an insert must put the tuple into its slot");
+      break;
+    }
+    case LogRecordType::MARKDELETE:
+      page->MarkDelete(log_record->delete_rid_, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE:
+      page->ApplyDelete(log_record->delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE: {
+      Tuple old_tuple;
+      page->UpdateTuple(log_record->new_tuple_, &old_tuple, log_record->update_rid_, nullptr, nullptr, nullptr);
+      break;
+    }
+    default:
+      break;
+  }
+  page->SetLSN(log_record->lsn_);
+  return true;
+}
+
+void LogRecovery::UndoTransaction(txn_id_t txn_id, lsn_t last_lsn) {
+  lsn_t prev_lsn = last_lsn;
+  // Tuples whose undone delete put them into another slot, by the RID the earlier records of the transaction have.
+  std::unordered_map<RID, RID> moved;
+  for (lsn_t lsn = last_lsn; lsn != INVALID_LSN;) {
+    auto it = lsn_mapping_.find(lsn);
+    if (it == lsn_mapping_.end()) {
+      break;
+    }
+    auto &log_record = records_[it->second];
+    if (log_record.log_record_type_ == LogRecordType::CLR) {
+      // An earlier recovery undid the records up to here already.
+      lsn = log_record.undo_next_lsn_;
+      continue;
+    }
+    lsn = log_record.prev_lsn_;
+
+    const LogRecordType type = log_record.log_record_type_;
+    const RID rid = RIDOf(log_record, type);
+    if (rid.GetPageId() == INVALID_PAGE_ID) {
+      // BEGIN has nothing to undo, and a new page stays linked into the table, empty.
+      continue;
+    }
+    // The undo works on the body of the CLR, so that the CLR has the slot the tuple is in at the time of the undo.
+    LogRecord clr(txn_id, prev_lsn, log_record);
+    if (auto it = moved.find(rid); it != moved.end()) {
+      SetRIDOf(&clr, type, it->second);
+    }
+    auto *page = FetchTablePage(rid.GetPageId());
+    page->WLatch();
+    UndoRecord(page, &clr, type);
+    if (type == LogRecordType::APPLYDELETE && !(clr.delete_rid_ == RIDOf(log_record, type))) {
+      moved[rid] = clr.delete_rid_;
+    }
+    prev_lsn = log_manager_->AppendLogRecord(&clr);
+    page->SetLSN(prev_lsn);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+  }
+  LogRecord abort(txn_id, prev_lsn, LogRecordType::ABORT);
+  log_manager_->AppendLogRecord(&abort);
+}
+
+void LogRecovery::UndoRecord(TablePage *page, LogRecord *log_record, LogRecordType type) {
+  switch (type) {
+    case LogRecordType::INSERT:
+      page->ApplyDelete(log_record->insert_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::MARKDELETE:
+      page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE:
+      if (!page->RestoreTuple(log_record->delete_tuple_, log_record->delete_rid_)) {
+        // Another transaction took the slot after the delete was applied; the tuple goes into another one, which the
+        // CLR records for the redo and the earlier records of the transaction.
+        const bool inserted =
+            page->InsertTuple(log_record->delete_tuple_, &log_record->delete_rid_, nullptr, nullptr, nullptr);
+        BUSTUB_ASSERT(inserted, "the page of a deleted tuple must have the space to take it back");
+      }
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      page->MarkDelete(log_record->delete_rid_, nullptr, nullptr, nullptr);
+      break;
+    case LogRecordType::UPDATE: {
+      Tuple new_tuple;
+      page->UpdateTuple(log_record->old_tuple_, &new_tuple, log_record->update_rid_, nullptr, nullptr, nullptr);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+auto LogRecovery::RIDOf(const LogRecord &log_record, LogRecordType type) -> RID {
+  switch (type) {
+    case LogRecordType::INSERT:
+      return log_record.insert_rid_;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      return log_record.delete_rid_;
+    case LogRecordType::UPDATE:
+      return log_record.update_rid_;
+    default:
+      return RID{};
+  }
+}
+
+void LogRecovery::SetRIDOf(LogRecord *log_record, LogRecordType type, const RID &rid) {
+  switch (type) {
+    case LogRecordType::INSERT:
+      log_record->insert_rid_ = rid;
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      log_record->delete_rid_ = rid;
+      break;
+    case LogRecordType::UPDATE:
+      log_record->update_rid_ = rid;
+      break;
+    default:
+      break;
+  }
+}
+
+auto LogRecovery::FetchTablePage(page_id_t page_id) -> TablePage * {
+  Page *page;
+  while ((page = buffer_pool_manager_->FetchPage(page_id)) == nullptr) {
+    std::this_thread::yield();
+  }
+  return reinterpret_cast<TablePage *>(page);
+}
 
 }  // namespace bustub
@@ -0,0 +1,404 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.cpp
+//
+// Identification: src/storage/disk/async_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "fmt/format.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define BUSTUB_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bustub {
+
+/** One I/O for IoUring::Submit(). */
+struct IoUringOp {
+  bool is_write_;
+  int fd_;
+  char *addr_;
+  uint32_t len_;
+  int64_t offset_;
+  uint64_t user_data_;
+};
+
+#ifdef BUSTUB_HAS_IO_URING
+
+/**
+ * IoUring is a minimal io_uring: a submission and a completion queue shared with the kernel, used through the raw
+ * system calls, so that no liburing is needed. Submit() must not be called concurrently, and neither must Reap().
+ */
+class IoUring {
+ public:
+  /** @return a ring with the given number of entries, or nullptr if the kernel does not offer io_uring */
+  static auto Create(unsigned entries) -> std::unique_ptr<IoUring> {
+    io_uring_params params{};
+    const int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+      return nullptr;
+    }
+    auto ring = std::unique_ptr<IoUring>(new IoUring(fd));
+    if (!ring->Map(params)) {
+      return nullptr;
+    }
+    return ring;
+  }
+
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+      munmap(cq_ptr_, cq_size_);
+    }
+    if (sq_ptr_ != MAP_FAILED) {
+      munmap(sq_ptr_, sq_size_);
+    }
+    close(fd_);
+  }
+
+  IoUring(const IoUring &) = delete;
+  auto operator=(const IoUring &) -> IoUring & = delete;
+
+  /** Queues the operations and submits them with as few system calls as possible. */
+  void Submit(const std::vector<IoUringOp> &ops) {
+    unsigned tail = *sq_tail_;
+    for (const auto &op : ops) {
+      const unsigned index = tail & *sq_mask_;
+      io_uring_sqe *sqe = &sqes_[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = op.addr_ == nullptr ? IORING_OP_NOP : (op.is_write_ ? IORING_OP_WRITE : IORING_OP_READ);
+      sqe->fd = op.fd_;
+      sqe->addr = reinterpret_cast<uint64_t>(op.addr_);
+      sqe->len = op.len_;
+      sqe->off = static_cast<uint64_t>(op.offset_);
+      sqe->user_data = op.user_data_;
+      sq_array_[index] = index;
+      tail++;
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    size_t submitted = 0;
+    while (submitted < ops.size()) {
+      const auto ret = syscall(__NR_io_uring_enter, fd_, ops.size() - submitted, 0, 0, nullptr, 0);
+      if (ret < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+          std::this_thread::yield();
+          continue;
+        }
+        // The entries stay queued and reference caller memory; there is no way to take them back.
+        throw Exception(fmt::format("io_uring submission failed: {}", strerror(errno)));
+      }
+      submitted += static_cast<size_t>(ret);
+    }
+  }
+
+  /** Waits until at least one operation has completed, and appends all completed ones as (user data, result). */
+  void Reap(std::vector<std::pair<uint64_t, int32_t>> *completions) {
+    while (true) {
+      unsigned head = *cq_head_;
+      const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      if (head != tail) {
+        for (; head != tail; head++) {
+          const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+          completions->emplace_back(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return;
+      }
+      syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+    }
+  }
+
+ private:
+  explicit IoUring(int fd) : fd_(fd) {}
+
+  auto Map(const io_uring_params &params) -> bool {
+    sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+    }
+    sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+      return false;
+    }
+    cq_ptr_ = single_mmap ? sq_ptr_
+                          : mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                                 IORING_OFF_CQ_RING);
+    if (cq_ptr_ == MAP_FAILED) {
+      return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(
+        mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+      return false;
+    }
+
+    auto *sq = static_cast<char *>(sq_ptr_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  int fd_;
+  void *sq_ptr_{MAP_FAILED};
+  void *cq_ptr_{MAP_FAILED};
+  io_uring_sqe *sqes_{static_cast<io_uring_sqe *>(MAP_FAILED)};
+  size_t sq_size_{0};
+  size_t cq_size_{0};
+  size_t sqes_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+#else
+
+/** Stand-in for systems without io_uring: Create() always fails, so the thread pool is used. */
+class IoUring {
+ public:
+  static auto Create([[maybe_unused]] unsigned entries) -> std::unique_ptr<IoUring> { return nullptr; }
+  void Submit([[maybe_unused]] const std::vector<IoUringOp> &ops) {}
+  void Reap([[maybe_unused]] std::vector<std::pair<uint64_t, int32_t>> *completions) {}
+};
+
+#endif
+
+/** User data of the operation that stops the completion thread. */
+static constexpr uint64_t STOP_USER_DATA = 0;
+
+AsyncDiskManager::AsyncDiskManager(const std::string &db_file, bool use_io_uring, bool direct_io, size_t page_size)
+    : PosixDiskManager(db_file, direct_io, page_size) {
+  if (use_io_uring) {
+    ring_ = IoUring::Create(ASYNC_IO_QUEUE_DEPTH);
+  }
+  if (ring_ != nullptr) {
+    threads_.emplace_back(&AsyncDiskManager::CompletionLoop, this);
+  } else {
+    for (int i = 0; i < ASYNC_IO_FALLBACK_THREADS; i++) {
+      threads_.emplace_back(&AsyncDiskManager::WorkerLoop, this);
+    }
+  }
+}
+
+AsyncDiskManager::~AsyncDiskManager() { Stop(); }
+
+void AsyncDiskManager::ShutDown() {
+  Stop();
+  PosixDiskManager::ShutDown();
+}
+
+auto AsyncDiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool> {
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  std::vector<Request> requests;
+  requests.push_back({false, page_id, page_data, [promise](bool success) { promise->set_value(success); }});
+  SubmitBatch(std::move(requests));
+  return future;
+}
+
+auto AsyncDiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool> {
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  std::vector<Request> requests;
+  // The buffer is only read from; Request uses one pointer type for both directions.
+  requests.push_back(
+      {true, page_id, const_cast<char *>(page_data), [promise](bool success) { promise->set_value(success); }});
+  SubmitBatch(std::move(requests));
+  return future;
+}
+
+void AsyncDiskManager::SubmitBatch(std::vector<Request> requests) {
+  size_t next = 0;
+  while (next < requests.size()) {
+    // Take as many queue slots as are free, at least one.
+    size_t count;
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      cv_.wait(lock, [this] { return in_flight_ < static_cast<size_t>(ASYNC_IO_QUEUE_DEPTH); });
+      count = std::min(requests.size() - next, ASYNC_IO_QUEUE_DEPTH - in_flight_);
+      in_flight_ += count;
+    }
+
+    std::vector<std::unique_ptr<Request>> batch;
+    for (size_t i = next; i < next + count; i++) {
+      if (requests[i].is_write_) {
+        num_writes_ += 1;
+      }
+      batch.push_back(std::make_unique<Request>(std::move(requests[i])));
+    }
+    next += count;
+
+    if (ring_ != nullptr) {
+      SubmitToRing(std::move(batch));
+    } else {
+      {
+        std::scoped_lock<std::mutex> lock(latch_);
+        for (auto &request : batch) {
+          queue_.push_back(std::move(request));
+        }
+      }
+      cv_.notify_all();
+    }
+  }
+}
+
+void AsyncDiskManager::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  std::vector<Request> requests;
+  for (const auto &[page_id, page_data] : pages) {
+    requests.push_back({true, page_id, const_cast<char *>(page_data), nullptr});
+  }
+  SubmitAndWait(std::move(requests));
+}
+
+void AsyncDiskManager::ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  std::vector<Request> requests;
+  for (const auto &[page_id, page_data] : pages) {
+    requests.push_back({false, page_id, page_data, nullptr});
+  }
+  SubmitAndWait(std::move(requests));
+}
+
+void AsyncDiskManager::SubmitAndWait(std::vector<Request> requests) {
+  std::mutex latch;
+  std::condition_variable cv;
+  size_t remaining = requests.size();
+  page_id_t failed_write = INVALID_PAGE_ID;
+  for (auto &request : requests) {
+    request.callback_ = [&, is_write = request.is_write_, page_id = request.page_id_](bool success) {
+      std::scoped_lock<std::mutex> lock(latch);
+      if (is_write && !success) {
+        failed_write = page_id;
+      }
+      if (--remaining == 0) {
+        cv.notify_one();
+      }
+    };
+  }
+  SubmitBatch(std::move(requests));
+  std::unique_lock<std::mutex> lock(latch);
+  cv.wait(lock, [&] { return remaining == 0; });
+  if (failed_write != INVALID_PAGE_ID) {
+    throw Exception(fmt::format("I/O error while writing page {}", failed_write));
+  }
+}
+
+void AsyncDiskManager::SubmitToRing(std::vector<std::unique_ptr<Request>> requests) {
+  std::vector<IoUringOp> ops;
+  ops.reserve(requests.size());
+  for (auto &request : requests) {
+    // The request is owned by the ring until its completion comes back with the pointer as user data.
+    auto *raw = request.release();
+    ops.push_back({raw->is_write_, FileOf(raw->page_id_, raw->is_write_), raw->data_,
+                   static_cast<uint32_t>(page_size_), PageOffset(raw->page_id_), reinterpret_cast<uint64_t>(raw)});
+  }
+  std::scoped_lock<std::mutex> lock(submit_latch_);
+  ring_->Submit(ops);
+}
+
+void AsyncDiskManager::CompletionLoop() {
+  std::vector<std::pair<uint64_t, int32_t>> completions;
+  while (true) {
+    completions.clear();
+    ring_->Reap(&completions);
+    for (auto [user_data, result] : completions) {
+      if (user_data == STOP_USER_DATA) {
+        return;
+      }
+      auto request = std::unique_ptr<Request>(reinterpret_cast<Request *>(user_data));
+      if (result > 0 && static_cast<size_t>(result) == page_size_) {
+        Complete(std::move(request), true);
+      } else {
+        FinishSynchronously(std::move(request), result > 0 ? static_cast<size_t>(result) : 0);
+      }
+    }
+  }
+}
+
+void AsyncDiskManager::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    auto request = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    FinishSynchronously(std::move(request), 0);
+    lock.lock();
+  }
+}
+
+void AsyncDiskManager::FinishSynchronously(std::unique_ptr<Request> request, size_t done) {
+  const bool success = request->is_write_ ? PwritePage(request->page_id_, request->data_, done)
+                                          : PreadPage(request->page_id_, request->data_, done);
+  Complete(std::move(request), success);
+}
+
+void AsyncDiskManager::Complete(std::unique_ptr<Request> request, bool success) {
+  if (request->callback_) {
+    request->callback_(success);
+  }
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    in_flight_--;
+  }
+  cv_.notify_all();
+}
+
+void AsyncDiskManager::Stop() {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    cv_.wait(lock, [this] { return in_flight_ == 0; });
+    if (stopping_) {
+      return;
+    }
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  if (ring_ != nullptr) {
+    std::scoped_lock<std::mutex> lock(submit_latch_);
+    ring_->Submit({{false, -1, nullptr, 0, 0, STOP_USER_DATA}});
+  }
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+}  // namespace bustub
@@ -10,8 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
@@ -21,22 +25,25 @@
 #include "common/exception.h"
 #include "common/logger.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/page/header_page.h"
 
 namespace bustub {
 
-static char *buffer_used;
-
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
+ * @input page_size: page size of a new database
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, size_t page_size) : file_name_(db_file) {
+  CheckPageSize(page_size);
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
+  master_name_ = file_name_.substr(0, n) + ".ckpt";
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -51,6 +58,8 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
 
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  // A free space map left behind by an earlier database of the same name does not describe a new database file.
+  auto fsm_mode = std::ios::binary | std::ios::in | std::ios::out;
   // directory or file does not exist
   if (!db_io_.is_open()) {
     db_io_.clear();
@@ -59,8 +68,53 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     if (!db_io_.is_open()) {
       throw Exception("can't open db file");
     }
+    fsm_mode |= std::ios::trunc;
+    // neither does its master record
+    std::remove(master_name_.c_str());
+  }
+
+  char header[HeaderPage::DATABASE_HEADER_SIZE] = {0};
+  db_io_.seekg(0);
+  db_io_.read(header, sizeof(header));
+  const auto header_bytes = db_io_.gcount();
+  db_io_.clear();
+  if (header_bytes > 0) {
+    // an existing database keeps its page size; one without a header page uses the default
+    auto stored_page_size = HeaderPage::ReadPageSize(header);
+    page_size_ = stored_page_size == 0 ? BUSTUB_PAGE_SIZE : stored_page_size;
+    CheckPageSize(page_size_);
+    // a torn last page counts as well
+    const auto file_size = static_cast<size_t>(std::max<int64_t>(GetFileSize(file_name_), 0));
+    num_pages_ = static_cast<page_id_t>((file_size + page_size_ - 1) / page_size_);
+  } else {
+    page_size_ = page_size;
+    if (page_size_ != BUSTUB_PAGE_SIZE) {
+      // write the header page right away, so that reopening the database before the first flush finds the page size
+      std::vector<char> header_page(page_size_, 0);
+      HeaderPage::InitData(header_page.data(), page_size_);
+      db_io_.write(header_page.data(), static_cast<std::streamsize>(page_size_));
+      db_io_.flush();
+    }
+  }
+
+  fsm_io_.open(fsm_name_, fsm_mode);
+  if (!fsm_io_.is_open()) {
+    fsm_io_.clear();
+    fsm_io_.open(fsm_name_, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
+    if (!fsm_io_.is_open()) {
+      throw Exception("can't open free space map file");
+    }
+  }
+}
+
+auto DiskManager::IsValidPageSize(size_t page_size) -> bool {
+  return page_size >= BUSTUB_PAGE_SIZE && page_size <= BUSTUB_MAX_PAGE_SIZE && (page_size & (page_size - 1)) == 0;
+}
+
+void DiskManager::CheckPageSize(size_t page_size) {
+  if (!IsValidPageSize(page_size)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "invalid page size " + std::to_string(page_size));
   }
-  buffer_used = nullptr;
 }
 
 /**
@@ -71,6 +125,10 @@ void DiskManager::ShutDown() {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
     db_io_.close();
   }
+  {
+    std::scoped_lock scoped_fsm_latch(fsm_latch_);
+    fsm_io_.close();
+  }
   log_io_.close();
 }
 
@@ -79,18 +137,17 @@ void DiskManager::ShutDown() {
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  size_t offset = static_cast<size_t>(page_id) * page_size_;
   // set write cursor to offset
   num_writes_ += 1;
   db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
+  db_io_.write(page_data, static_cast<std::streamsize>(page_size_));
   // check for I/O error
   if (db_io_.bad()) {
     LOG_DEBUG("I/O error while writing");
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  // no flush here: the stream buffers the write, and Sync() makes it durable
 }
 
 /**
@@ -98,28 +155,135 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
+  auto offset = static_cast<std::streamoff>(page_id) * static_cast<std::streamoff>(page_size_);
+  // The file size on disk does not include writes still buffered in the stream, so read through the stream and treat
+  // a short read as the end of the file.
+  db_io_.seekp(offset);
+  db_io_.read(page_data, static_cast<std::streamsize>(page_size_));
+  if (db_io_.bad()) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  // if file ends before reading a page
+  auto read_count = static_cast<size_t>(db_io_.gcount());
+  if (read_count < page_size_) {
+    LOG_DEBUG("Read less than a page");
+    db_io_.clear();
+    // std::cerr << "Read less than a page" << std::endl;
+    memset(page_data + read_count, 0, page_size_ - read_count);
+  }
+}
+
+/**
+ * Flush the stream buffers and fdatasync the database file and the free space map
+ */
+void DiskManager::Sync() {
+  num_syncs_ += 1;
+  {
+    std::scoped_lock scoped_db_io_latch(db_io_latch_);
+    if (db_io_.is_open()) {
+      db_io_.flush();
+      if (db_io_.bad()) {
+        throw Exception("I/O error while writing the db file");
+      }
+      SyncFile(file_name_);
+    }
+  }
+  SyncFreeSpaceMap();
+}
+
+/**
+ * Without a file descriptor of its own, the stream-based disk manager cannot sync a part of the file
+ */
+void DiskManager::SyncRange([[maybe_unused]] page_id_t first_page_id, [[maybe_unused]] size_t num_pages) { Sync(); }
+
+void DiskManager::SyncFreeSpaceMap() {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  if (fsm_io_.is_open()) {
+    fsm_io_.flush();
+    if (fsm_io_.bad()) {
+      throw Exception("I/O error while writing free space map");
+    }
+    SyncFile(fsm_name_);
+  }
+}
+
+void DiskManager::SyncFile(const std::string &file_name) {
+  // fdatasync() through any descriptor of a file writes back the dirty pages of the whole file.
+  const int fd = open(file_name.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw Exception("can't open " + file_name + " to sync it");
+  }
+  // A failed fdatasync() may have dropped the dirty pages, so the writes it was to cover are lost.
+  const bool synced = fdatasync(fd) == 0;
+  close(fd);
+  if (!synced) {
+    throw Exception("I/O error while syncing " + file_name);
+  }
+}
+
+/**
+ * Write several pages one after the other
+ */
+void DiskManager::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  for (const auto &[page_id, page_data] : pages) {
+    WritePage(page_id, page_data);
+  }
+}
+
+/**
+ * Read several pages one after the other
+ */
+void DiskManager::ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  for (const auto &[page_id, page_data] : pages) {
+    ReadPage(page_id, page_data);
+  }
+}
+
+/**
+ * Write a page of the free space map into its file, or into memory if there is no database file
+ */
+void DiskManager::WriteFreeSpaceMapPage(uint32_t fsm_page_no, const char *page_data) {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  if (!fsm_io_.is_open()) {
+    if (fsm_page_no >= fsm_pages_.size()) {
+      fsm_pages_.resize(fsm_page_no + 1);
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+    memcpy(fsm_pages_[fsm_page_no].data(), page_data, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  fsm_io_.seekp(static_cast<std::streamoff>(fsm_page_no) * BUSTUB_PAGE_SIZE);
+  fsm_io_.write(page_data, BUSTUB_PAGE_SIZE);
+  if (fsm_io_.bad()) {
+    LOG_DEBUG("I/O error while writing free space map");
+    return;
+  }
+  fsm_io_.flush();
+}
+
+/**
+ * Read a page of the free space map; pages past its end do not exist yet
+ */
+auto DiskManager::ReadFreeSpaceMapPage(uint32_t fsm_page_no, char *page_data) -> bool {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  if (!fsm_io_.is_open()) {
+    if (fsm_page_no >= fsm_pages_.size()) {
+      return false;
     }
+    memcpy(page_data, fsm_pages_[fsm_page_no].data(), BUSTUB_PAGE_SIZE);
+    return true;
   }
+  const auto offset = static_cast<int64_t>(fsm_page_no) * BUSTUB_PAGE_SIZE;
+  if (offset + BUSTUB_PAGE_SIZE > GetFileSize(fsm_name_)) {
+    return false;
+  }
+  fsm_io_.seekg(offset);
+  fsm_io_.read(page_data, BUSTUB_PAGE_SIZE);
+  if (fsm_io_.bad()) {
+    LOG_DEBUG("I/O error while reading free space map");
+    return false;
+  }
+  return true;
 }
 
 /**
@@ -127,10 +291,6 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
  * Only return when sync is done, and only perform sequence write
  */
 void DiskManager::WriteLog(char *log_data, int size) {
-  // enforce swap log buffer
-  assert(log_data != buffer_used);
-  buffer_used = log_data;
-
   if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
     return;
   }
@@ -143,16 +303,22 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
+  if (!log_io_.is_open()) {
+    // disk managers without a database file keep no log
+    flush_log_ = false;
+    return;
+  }
   // sequence write
   log_io_.write(log_data, size);
 
+  // needs to flush and sync to make the log durable
+  log_io_.flush();
   // check for I/O error
   if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+    flush_log_ = false;
+    throw Exception("I/O error while writing log");
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+  SyncFile(log_name_);
   flush_log_ = false;
 }
 
@@ -161,7 +327,7 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * Always read from the beginning and perform sequence read
  * @return: false means already reach the end
  */
-auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
+auto DiskManager::ReadLog(char *log_data, int size, int64_t offset) -> bool {
   if (offset >= GetFileSize(log_name_)) {
     // LOG_DEBUG("end of log file");
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
@@ -184,6 +350,56 @@ auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
   return true;
 }
 
+/**
+ * Returns the size of the log file, 0 if there is none
+ */
+auto DiskManager::GetLogSize() -> int64_t {
+  if (!log_io_.is_open()) {
+    return 0;
+  }
+  return std::max<int64_t>(GetFileSize(log_name_), 0);
+}
+
+/**
+ * Write the master record into a new file and move it over the old one, so that the replacement is atomic
+ */
+void DiskManager::WriteMasterRecord(const MasterRecord &master_record) {
+  std::scoped_lock scoped_master_latch(master_latch_);
+  if (master_name_.empty()) {
+    master_record_ = master_record;
+    return;
+  }
+  const std::string temp_name = master_name_ + ".tmp";
+  {
+    std::ofstream master_io(temp_name, std::ios::binary | std::ios::trunc | std::ios::out);
+    master_io.write(reinterpret_cast<const char *>(&master_record), sizeof(MasterRecord));
+    master_io.flush();
+    if (master_io.bad()) {
+      throw Exception("I/O error while writing the master record");
+    }
+  }
+  SyncFile(temp_name);
+  if (rename(temp_name.c_str(), master_name_.c_str()) != 0) {
+    throw Exception("can't replace the master record");
+  }
+}
+
+/**
+ * Read the master record; without one, recovery reads the whole log
+ */
+auto DiskManager::ReadMasterRecord() -> MasterRecord {
+  std::scoped_lock scoped_master_latch(master_latch_);
+  if (master_name_.empty()) {
+    return master_record_;
+  }
+  MasterRecord master_record;
+  std::ifstream master_io(master_name_, std::ios::binary | std::ios::in);
+  if (!master_io.read(reinterpret_cast<char *>(&master_record), sizeof(MasterRecord))) {
+    return {};
+  }
+  return master_record;
+}
+
 /**
  * Returns number of flushes made so far
  */
@@ -194,6 +410,11 @@ auto DiskManager::GetNumFlushes() const -> int { return num_flushes_; }
  */
 auto DiskManager::GetNumWrites() const -> int { return num_writes_; }
 
+/**
+ * Returns number of syncs made so far
+ */
+auto DiskManager::GetNumSyncs() const -> int { return num_syncs_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -202,10 +423,10 @@ auto DiskManager::GetFlushState() const -> bool { return flush_log_; }
 /**
  * Private helper function to get disk file size
  */
-auto DiskManager::GetFileSize(const std::string &file_name) -> int {
+auto DiskManager::GetFileSize(const std::string &file_name) -> int64_t {
   struct stat stat_buf;
   int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
+  return rc == 0 ? static_cast<int64_t>(stat_buf.st_size) : -1;
 }
 
 }  // namespace bustub
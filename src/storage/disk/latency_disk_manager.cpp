@@ -0,0 +1,249 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_disk_manager.cpp
+//
+// Identification: src/storage/disk/latency_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/latency_disk_manager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>  // NOLINT
+
+#include "common/exception.h"
+
+namespace bustub {
+
+/** z-score of the 99th percentile of the standard normal distribution. */
+static constexpr double Z_P99 = 2.3263;
+
+auto LatencyProfile::None() -> LatencyProfile {
+  LatencyProfile profile;
+  profile.queue_depth_ = std::numeric_limits<uint32_t>::max();
+  return profile;
+}
+
+auto LatencyProfile::Ssd() -> LatencyProfile {
+  using std::chrono::microseconds;
+  LatencyProfile profile;
+  profile.read_ = {microseconds(80), microseconds(250)};
+  profile.write_ = {microseconds(25), microseconds(150)};
+  profile.sequential_ = {microseconds(50), microseconds(150)};
+  profile.sync_ = {microseconds(500), microseconds(2000)};
+  profile.queue_depth_ = 32;
+  return profile;
+}
+
+auto LatencyProfile::Hdd() -> LatencyProfile {
+  using std::chrono::microseconds;
+  LatencyProfile profile;
+  profile.read_ = {microseconds(8000), microseconds(16000)};
+  profile.write_ = {microseconds(8000), microseconds(16000)};
+  profile.sequential_ = {microseconds(40), microseconds(100)};
+  profile.sync_ = {microseconds(10000), microseconds(25000)};
+  profile.queue_depth_ = 1;
+  return profile;
+}
+
+LatencyDiskManager::LatencyDiskManager(DiskManager *disk_manager, const LatencyProfile &profile)
+    : disk_manager_(disk_manager), profile_(profile), rng_(profile.seed_) {
+  profile_.queue_depth_ = std::max<size_t>(profile_.queue_depth_, 1);
+  page_size_ = disk_manager_->GetPageSize();
+}
+
+void LatencyDiskManager::ShutDown() { disk_manager_->ShutDown(); }
+
+void LatencyDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  CountPageIo(page_id, true);
+  Delay(1, SamplePageIo(page_id, true), [&] { disk_manager_->WritePage(page_id, page_data); });
+}
+
+void LatencyDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  CountPageIo(page_id, false);
+  Delay(1, SamplePageIo(page_id, false), [&] { disk_manager_->ReadPage(page_id, page_data); });
+}
+
+void LatencyDiskManager::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  for (size_t begin = 0; begin < pages.size(); begin += profile_.queue_depth_) {
+    const size_t end = std::min(pages.size(), begin + profile_.queue_depth_);
+    std::vector<std::pair<page_id_t, const char *>> group(pages.begin() + begin, pages.begin() + end);
+    auto latency = std::chrono::microseconds(0);
+    for (const auto &[page_id, page_data] : group) {
+      CountPageIo(page_id, true);
+      latency = std::max(latency, SamplePageIo(page_id, true));
+    }
+    Delay(group.size(), latency, [&] { disk_manager_->WritePages(group); });
+  }
+}
+
+void LatencyDiskManager::ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  for (size_t begin = 0; begin < pages.size(); begin += profile_.queue_depth_) {
+    const size_t end = std::min(pages.size(), begin + profile_.queue_depth_);
+    std::vector<std::pair<page_id_t, char *>> group(pages.begin() + begin, pages.begin() + end);
+    auto latency = std::chrono::microseconds(0);
+    for (const auto &[page_id, page_data] : group) {
+      CountPageIo(page_id, false);
+      latency = std::max(latency, SamplePageIo(page_id, false));
+    }
+    Delay(group.size(), latency, [&] { disk_manager_->ReadPages(group); });
+  }
+}
+
+void LatencyDiskManager::Sync() {
+  num_syncs_++;
+  Delay(1, Sample(profile_.sync_), [&] { disk_manager_->Sync(); });
+}
+
+void LatencyDiskManager::SyncRange(page_id_t first_page_id, size_t num_pages) {
+  num_syncs_++;
+  Delay(1, Sample(profile_.sync_), [&] { disk_manager_->SyncRange(first_page_id, num_pages); });
+}
+
+void LatencyDiskManager::PreallocatePages(page_id_t first_page_id, size_t num_pages) {
+  disk_manager_->PreallocatePages(first_page_id, num_pages);
+}
+
+auto LatencyDiskManager::CreateTablespace() -> tablespace_id_t { return disk_manager_->CreateTablespace(); }
+
+void LatencyDiskManager::DropTablespace(tablespace_id_t tablespace_id) {
+  disk_manager_->DropTablespace(tablespace_id);
+}
+
+auto LatencyDiskManager::GetNumBlocks(tablespace_id_t tablespace_id) -> page_id_t {
+  return disk_manager_->GetNumBlocks(tablespace_id);
+}
+
+auto LatencyDiskManager::GetNumPages() -> page_id_t { return disk_manager_->GetNumPages(); }
+
+void LatencyDiskManager::WriteFreeSpaceMapPage(uint32_t fsm_page_no, const char *page_data) {
+  disk_manager_->WriteFreeSpaceMapPage(fsm_page_no, page_data);
+}
+
+auto LatencyDiskManager::ReadFreeSpaceMapPage(uint32_t fsm_page_no, char *page_data) -> bool {
+  return disk_manager_->ReadFreeSpaceMapPage(fsm_page_no, page_data);
+}
+
+void LatencyDiskManager::WriteLog(char *log_data, int size) {
+  if (size == 0) {
+    return;
+  }
+  num_flushes_ += 1;
+  Delay(1, Sample(profile_.sync_), [&] { disk_manager_->WriteLog(log_data, size); });
+}
+
+auto LatencyDiskManager::ReadLog(char *log_data, int size, int64_t offset) -> bool {
+  bool result = false;
+  Delay(1, Sample(profile_.sequential_), [&] { result = disk_manager_->ReadLog(log_data, size, offset); });
+  return result;
+}
+
+auto LatencyDiskManager::GetLogSize() -> int64_t { return disk_manager_->GetLogSize(); }
+
+void LatencyDiskManager::WriteMasterRecord(const MasterRecord &master_record) {
+  disk_manager_->WriteMasterRecord(master_record);
+}
+
+auto LatencyDiskManager::ReadMasterRecord() -> MasterRecord { return disk_manager_->ReadMasterRecord(); }
+
+auto LatencyDiskManager::GetPageIoCounts(page_id_t page_id) -> PageIoCounts {
+  std::scoped_lock lock(counts_latch_);
+  auto it = page_io_counts_.find(page_id);
+  return it == page_io_counts_.end() ? PageIoCounts{} : it->second;
+}
+
+auto LatencyDiskManager::GetAllPageIoCounts() -> std::unordered_map<page_id_t, PageIoCounts> {
+  std::scoped_lock lock(counts_latch_);
+  return page_io_counts_;
+}
+
+void LatencyDiskManager::ResetPageIoCounts() {
+  std::scoped_lock lock(counts_latch_);
+  page_io_counts_.clear();
+}
+
+auto LatencyDiskManager::Sample(const LatencyDistribution &distribution) -> std::chrono::microseconds {
+  if (distribution.median_.count() <= 0) {
+    return std::chrono::microseconds(0);
+  }
+  if (distribution.p99_ <= distribution.median_) {
+    return distribution.median_;
+  }
+  const double mu = std::log(static_cast<double>(distribution.median_.count()));
+  const double sigma =
+      std::log(static_cast<double>(distribution.p99_.count()) / static_cast<double>(distribution.median_.count())) /
+      Z_P99;
+  std::lognormal_distribution<double> lognormal(mu, sigma);
+  std::scoped_lock lock(rng_latch_);
+  return std::chrono::microseconds(static_cast<int64_t>(lognormal(rng_)));
+}
+
+auto LatencyDiskManager::SamplePageIo(page_id_t page_id, bool is_write) -> std::chrono::microseconds {
+  bool sequential;
+  {
+    std::scoped_lock lock(rng_latch_);
+    sequential = last_page_id_ != INVALID_PAGE_ID && page_id == last_page_id_ + 1;
+    last_page_id_ = page_id;
+  }
+  if (sequential) {
+    return Sample(profile_.sequential_);
+  }
+  return Sample(is_write ? profile_.write_ : profile_.read_);
+}
+
+void LatencyDiskManager::AcquireSlots(size_t count) {
+  std::unique_lock lock(queue_latch_);
+  queue_cv_.wait(lock, [&] { return in_flight_ + count <= profile_.queue_depth_; });
+  in_flight_ += count;
+  if (in_flight_ > max_in_flight_) {
+    max_in_flight_ = in_flight_;
+  }
+}
+
+void LatencyDiskManager::ReleaseSlots(size_t count) {
+  {
+    std::scoped_lock lock(queue_latch_);
+    in_flight_ -= count;
+  }
+  queue_cv_.notify_all();
+}
+
+template <typename IoFunc>
+void LatencyDiskManager::Delay(size_t count, std::chrono::microseconds latency, IoFunc io) {
+  const auto start = std::chrono::steady_clock::now();
+  AcquireSlots(count);
+  const auto deadline = std::chrono::steady_clock::now() + latency;
+  try {
+    io();
+  } catch (const Exception &) {
+    ReleaseSlots(count);
+    throw;
+  }
+  std::this_thread::sleep_until(deadline);
+  ReleaseSlots(count);
+  total_delay_us_ +=
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void LatencyDiskManager::CountPageIo(page_id_t page_id, bool is_write) {
+  if (is_write) {
+    num_writes_++;
+  } else {
+    num_reads_++;
+  }
+  std::scoped_lock lock(counts_latch_);
+  auto &counts = page_io_counts_[page_id];
+  if (is_write) {
+    counts.writes_++;
+  } else {
+    counts.reads_++;
+  }
+}
+
+}  // namespace bustub
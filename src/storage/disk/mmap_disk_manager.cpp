@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager.cpp
+//
+// Identification: src/storage/disk/mmap_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/mmap_disk_manager.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+MmapDiskManager::MmapDiskManager(const std::string &db_file, AccessPattern access_pattern, size_t page_size)
+    : PosixDiskManager(db_file, false, page_size), access_pattern_(access_pattern) {
+  std::unique_lock lock(map_latch_);
+  Remap();
+}
+
+MmapDiskManager::~MmapDiskManager() {
+  std::unique_lock lock(map_latch_);
+  Unmap();
+}
+
+void MmapDiskManager::ShutDown() {
+  {
+    std::unique_lock lock(map_latch_);
+    Unmap();
+  }
+  PosixDiskManager::ShutDown();
+}
+
+void MmapDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  {
+    std::shared_lock lock(map_latch_);
+    if (page_id >= 0 && static_cast<size_t>(page_id) < map_pages_) {
+      num_writes_ += 1;
+      memcpy(map_ + PageOffset(page_id), page_data, page_size_);
+      return;
+    }
+  }
+  PosixDiskManager::WritePage(page_id, page_data);
+}
+
+void MmapDiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  // Only the default tablespace is mapped.
+  if (TablespaceOf(page_id) != DEFAULT_TABLESPACE) {
+    PosixDiskManager::ReadPage(page_id, page_data);
+    return;
+  }
+  {
+    std::shared_lock lock(map_latch_);
+    if (page_id >= 0 && static_cast<size_t>(page_id) < map_pages_) {
+      memcpy(page_data, map_ + PageOffset(page_id), page_size_);
+      return;
+    }
+  }
+  // The file may have grown since it was mapped.
+  std::unique_lock lock(map_latch_);
+  if (static_cast<size_t>(page_id) >= map_pages_) {
+    Remap();
+  }
+  if (page_id >= 0 && static_cast<size_t>(page_id) < map_pages_) {
+    memcpy(page_data, map_ + PageOffset(page_id), page_size_);
+    return;
+  }
+  // Past the last whole page of the file.
+  PreadPage(page_id, page_data);
+}
+
+void MmapDiskManager::Sync() {
+  {
+    std::shared_lock lock(map_latch_);
+    if (map_ != nullptr && msync(map_, map_pages_ * page_size_, MS_SYNC) != 0) {
+      LOG_DEBUG("I/O error while syncing: %s", strerror(errno));
+    }
+  }
+  PosixDiskManager::Sync();
+}
+
+void MmapDiskManager::SyncRange(page_id_t first_page_id, size_t num_pages) {
+  {
+    std::shared_lock lock(map_latch_);
+    if (first_page_id >= 0 && static_cast<size_t>(first_page_id) + num_pages <= map_pages_) {
+      num_syncs_ += 1;
+      if (msync(map_ + PageOffset(first_page_id), num_pages * page_size_, MS_SYNC) != 0) {
+        LOG_DEBUG("I/O error while syncing: %s", strerror(errno));
+      }
+      return;
+    }
+  }
+  PosixDiskManager::SyncRange(first_page_id, num_pages);
+}
+
+void MmapDiskManager::SetAccessPattern(AccessPattern access_pattern) {
+  std::unique_lock lock(map_latch_);
+  access_pattern_ = access_pattern;
+  Advise();
+}
+
+auto MmapDiskManager::GetNumMappedPages() -> size_t {
+  std::shared_lock lock(map_latch_);
+  return map_pages_;
+}
+
+void MmapDiskManager::Remap() {
+  struct stat file_stat {};
+  if (fstat(db_fd_, &file_stat) != 0) {
+    throw Exception("can't stat db file");
+  }
+  // Only whole pages are mapped; touching the mapping past the end of the file would raise SIGBUS.
+  const auto num_pages = static_cast<size_t>(file_stat.st_size) / page_size_;
+  if (num_pages == map_pages_) {
+    return;
+  }
+  Unmap();
+  if (num_pages == 0) {
+    return;
+  }
+  void *map = mmap(nullptr, num_pages * page_size_, PROT_READ | PROT_WRITE, MAP_SHARED, db_fd_, 0);
+  if (map == MAP_FAILED) {
+    throw Exception("can't map db file");
+  }
+  map_ = static_cast<char *>(map);
+  map_pages_ = num_pages;
+  Advise();
+}
+
+void MmapDiskManager::Unmap() {
+  if (map_ != nullptr) {
+    munmap(map_, map_pages_ * page_size_);
+    map_ = nullptr;
+    map_pages_ = 0;
+  }
+}
+
+void MmapDiskManager::Advise() {
+  if (map_ == nullptr) {
+    return;
+  }
+  int advice = MADV_NORMAL;
+  if (access_pattern_ == AccessPattern::SEQUENTIAL) {
+    advice = MADV_SEQUENTIAL;
+  } else if (access_pattern_ == AccessPattern::RANDOM) {
+    advice = MADV_RANDOM;
+  }
+  if (madvise(map_, map_pages_ * page_size_, advice) != 0) {
+    LOG_DEBUG("madvise failed: %s", strerror(errno));
+  }
+}
+
+}  // namespace bustub
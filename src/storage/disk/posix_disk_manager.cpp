@@ -0,0 +1,385 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posix_disk_manager.cpp
+//
+// Identification: src/storage/disk/posix_disk_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/posix_disk_manager.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+namespace {
+/**
+ * @return an aligned stand-in for buffers that can't take part in an O_DIRECT transfer themselves, one per thread,
+ * large enough for the largest page size and allocated on first use
+ */
+auto BounceBuffer() -> char * {
+  thread_local std::unique_ptr<char, decltype(&std::free)> bounce_buffer(
+      static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, BUSTUB_MAX_PAGE_SIZE)), &std::free);
+  return bounce_buffer.get();
+}
+
+/** @return true if the buffer is aligned for O_DIRECT */
+auto IsAligned(const char *data) -> bool { return reinterpret_cast<uintptr_t>(data) % BUSTUB_PAGE_SIZE == 0; }
+
+/** Most pages read by one preadv() or written by one pwritev(); well below IOV_MAX everywhere. */
+constexpr size_t MAX_PAGES_PER_IO = 256;
+}  // namespace
+
+/**
+ * Constructor: open/create the database file through DiskManager, then switch page I/O over to a file descriptor
+ */
+PosixDiskManager::PosixDiskManager(const std::string &db_file, bool direct_io, size_t page_size)
+    : DiskManager(db_file, page_size) {
+  {
+    std::scoped_lock scoped_db_io_latch(db_io_latch_);
+    db_io_.close();
+  }
+  for (auto &fd : tablespace_fds_) {
+    fd = -1;
+  }
+  open_flags_ = O_RDWR | O_CLOEXEC;
+#ifdef O_DIRECT
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), open_flags_ | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = db_fd_ >= 0;
+  }
+#endif
+  if (direct_io && !direct_io_) {
+    LOG_WARN("direct I/O is not supported for %s, using buffered I/O", db_file.c_str());
+  }
+#ifdef O_DIRECT
+  if (direct_io_) {
+    open_flags_ |= O_DIRECT;
+  }
+#endif
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), open_flags_ | O_CREAT, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+}
+
+PosixDiskManager::~PosixDiskManager() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+  for (auto &fd : tablespace_fds_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+}
+
+/**
+ * Close the database file descriptors and all file streams
+ */
+void PosixDiskManager::ShutDown() {
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+  {
+    std::scoped_lock lock(tablespace_latch_);
+    for (auto &fd : tablespace_fds_) {
+      if (fd >= 0) {
+        close(fd);
+        fd = -1;
+      }
+    }
+  }
+  DiskManager::ShutDown();
+}
+
+/**
+ * Write the contents of the specified page into disk file
+ */
+void PosixDiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  num_writes_ += 1;
+  if (!PwritePage(page_id, page_data)) {
+    throw Exception(fmt::format("I/O error while writing page {}", page_id));
+  }
+}
+
+/**
+ * Read the contents of the specified page into the given memory area
+ */
+void PosixDiskManager::ReadPage(page_id_t page_id, char *page_data) { PreadPage(page_id, page_data); }
+
+/**
+ * Write several pages, one pwritev() per run of contiguous pages
+ */
+void PosixDiskManager::WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  num_writes_ += static_cast<int>(pages.size());
+  auto sorted = pages;
+  std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  std::vector<iovec> iov;
+  size_t begin = 0;
+  while (begin < sorted.size()) {
+    const page_id_t first_page_id = sorted[begin].first;
+    size_t end = begin;
+    while (end < sorted.size() && end - begin < MAX_PAGES_PER_IO &&
+           sorted[end].first == first_page_id + static_cast<page_id_t>(end - begin) &&
+           TablespaceOf(sorted[end].first) == TablespaceOf(first_page_id) &&
+           (!direct_io_ || IsAligned(sorted[end].second))) {
+      end++;
+    }
+    if (end - begin <= 1) {
+      if (!PwritePage(first_page_id, sorted[begin].second)) {
+        throw Exception(fmt::format("I/O error while writing page {}", first_page_id));
+      }
+      begin++;
+      continue;
+    }
+    iov.clear();
+    for (size_t i = begin; i < end; i++) {
+      iov.push_back({const_cast<char *>(sorted[i].second), page_size_});  // NOLINT
+    }
+    const int fd = FileOf(first_page_id, true);
+    ssize_t n = fd < 0 ? 0 : pwritev(fd, iov.data(), static_cast<int>(iov.size()), PageOffset(first_page_id));
+    if (n < 0) {
+      n = 0;
+    }
+    // A short or failed write is finished page by page, starting in the middle of the first incomplete page.
+    const size_t complete = static_cast<size_t>(n) / page_size_;
+    for (size_t i = begin + complete; i < end; i++) {
+      const size_t written = i == begin + complete ? static_cast<size_t>(n) % page_size_ : 0;
+      if (!PwritePage(sorted[i].first, sorted[i].second, written)) {
+        throw Exception(fmt::format("I/O error while writing page {}", sorted[i].first));
+      }
+    }
+    begin = end;
+  }
+}
+
+/**
+ * Read several pages, one preadv() per run of contiguous pages
+ */
+void PosixDiskManager::ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) {
+  auto sorted = pages;
+  std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  std::vector<iovec> iov;
+  size_t begin = 0;
+  while (begin < sorted.size()) {
+    const page_id_t first_page_id = sorted[begin].first;
+    // A run continues while the pages are adjacent in the same file and, for O_DIRECT, the buffers are aligned.
+    size_t end = begin;
+    while (end < sorted.size() && end - begin < MAX_PAGES_PER_IO &&
+           sorted[end].first == first_page_id + static_cast<page_id_t>(end - begin) &&
+           TablespaceOf(sorted[end].first) == TablespaceOf(first_page_id) &&
+           (!direct_io_ || IsAligned(sorted[end].second))) {
+      end++;
+    }
+    if (end - begin <= 1) {
+      PreadPage(first_page_id, sorted[begin].second);
+      begin++;
+      continue;
+    }
+    iov.clear();
+    for (size_t i = begin; i < end; i++) {
+      iov.push_back({sorted[i].second, page_size_});
+    }
+    const int fd = FileOf(first_page_id, false);
+    const ssize_t n = fd < 0 ? 0 : preadv(fd, iov.data(), static_cast<int>(iov.size()), PageOffset(first_page_id));
+    // The pages that the read did not fill completely, because it hit the end of the file, came up short or failed,
+    // are read one by one.
+    const size_t complete = n < 0 ? 0 : static_cast<size_t>(n) / page_size_;
+    for (size_t i = begin + complete; i < end; i++) {
+      PreadPage(sorted[i].first, sorted[i].second);
+    }
+    begin = end;
+  }
+}
+
+void PosixDiskManager::Sync() {
+  num_syncs_ += 1;
+  if (fdatasync(db_fd_) != 0) {
+    throw Exception(fmt::format("I/O error while syncing: {}", strerror(errno)));
+  }
+  for (auto &fd : tablespace_fds_) {
+    const int tablespace_fd = fd;
+    if (tablespace_fd >= 0 && fdatasync(tablespace_fd) != 0) {
+      throw Exception(fmt::format("I/O error while syncing: {}", strerror(errno)));
+    }
+  }
+  SyncFreeSpaceMap();
+}
+
+void PosixDiskManager::SyncRange(page_id_t first_page_id, size_t num_pages) {
+#ifdef __linux__
+  num_syncs_ += 1;
+  const auto flags = SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER;
+  const int fd = FileOf(first_page_id, false);
+  if (fd >= 0 &&
+      sync_file_range(fd, PageOffset(first_page_id), static_cast<int64_t>(num_pages * page_size_), flags) != 0) {
+    throw Exception(fmt::format("I/O error while syncing: {}", strerror(errno)));
+  }
+#else
+  Sync();
+#endif
+}
+
+auto PosixDiskManager::CreateTablespace() -> tablespace_id_t {
+  std::scoped_lock lock(tablespace_latch_);
+  for (tablespace_id_t tablespace_id = DEFAULT_TABLESPACE + 1; tablespace_id < MAX_TABLESPACES; tablespace_id++) {
+    if (tablespace_fds_[tablespace_id] >= 0) {
+      continue;
+    }
+    const int fd = open(TablespaceFileName(tablespace_id).c_str(), open_flags_ | O_CREAT | O_EXCL, 0644);
+    if (fd >= 0) {
+      tablespace_fds_[tablespace_id] = fd;
+      return tablespace_id;
+    }
+    if (errno != EEXIST) {
+      throw Exception(fmt::format("can't create tablespace file: {}", strerror(errno)));
+    }
+  }
+  throw Exception(ExceptionType::OUT_OF_RANGE, "all tablespace ids are in use");
+}
+
+void PosixDiskManager::DropTablespace(tablespace_id_t tablespace_id) {
+  BUSTUB_ASSERT(tablespace_id != DEFAULT_TABLESPACE && tablespace_id < MAX_TABLESPACES, "invalid tablespace id");
+  std::scoped_lock lock(tablespace_latch_);
+  const int fd = tablespace_fds_[tablespace_id].exchange(-1);
+  if (fd >= 0) {
+    close(fd);
+  }
+  unlink(TablespaceFileName(tablespace_id).c_str());
+}
+
+auto PosixDiskManager::GetNumBlocks(tablespace_id_t tablespace_id) -> page_id_t {
+  const int fd = FileOf(MakePageId(tablespace_id, 0), false);
+  struct stat file_stat {};
+  if (fd < 0 || fstat(fd, &file_stat) != 0) {
+    return 0;
+  }
+  return static_cast<page_id_t>((static_cast<size_t>(file_stat.st_size) + page_size_ - 1) / page_size_);
+}
+
+void PosixDiskManager::PreallocatePages(page_id_t first_page_id, size_t num_pages) {
+  const int fd = FileOf(first_page_id, true);
+  if (fd < 0) {
+    LOG_DEBUG("can't open tablespace file: %s", strerror(errno));
+    return;
+  }
+  const int64_t length = static_cast<int64_t>(num_pages * page_size_);
+#ifdef __linux__
+  const int result = fallocate(fd, 0, PageOffset(first_page_id), length) == 0 ? 0 : errno;
+#else
+  const int result = posix_fallocate(fd, PageOffset(first_page_id), length);
+#endif
+  // Preallocation is only an optimization; the pages are allocated by the writes anyway.
+  if (result != 0) {
+    LOG_DEBUG("can't preallocate pages: %s", strerror(result));
+  }
+}
+
+auto PosixDiskManager::FileOf(page_id_t page_id, bool create) -> int {
+  const tablespace_id_t tablespace_id = TablespaceOf(page_id);
+  if (tablespace_id == DEFAULT_TABLESPACE) {
+    return db_fd_;
+  }
+  const int fd = tablespace_fds_[tablespace_id];
+  if (fd >= 0) {
+    return fd;
+  }
+  std::scoped_lock lock(tablespace_latch_);
+  if (tablespace_fds_[tablespace_id] < 0) {
+    tablespace_fds_[tablespace_id] =
+        open(TablespaceFileName(tablespace_id).c_str(), open_flags_ | (create ? O_CREAT : 0), 0644);
+  }
+  return tablespace_fds_[tablespace_id];
+}
+
+auto PosixDiskManager::TablespaceFileName(tablespace_id_t tablespace_id) const -> std::string {
+  return file_name_ + "." + std::to_string(tablespace_id);
+}
+
+auto PosixDiskManager::PwritePage(page_id_t page_id, const char *page_data, size_t written) -> bool {
+  if (direct_io_) {
+    written = 0;
+    if (!IsAligned(page_data)) {
+      memcpy(BounceBuffer(), page_data, page_size_);
+      page_data = BounceBuffer();
+    }
+  }
+  const int fd = FileOf(page_id, true);
+  if (fd < 0) {
+    LOG_DEBUG("can't open tablespace file: %s", strerror(errno));
+    return false;
+  }
+  const int64_t offset = PageOffset(page_id);
+  while (written < page_size_) {
+    const ssize_t n = pwrite(fd, page_data + written, page_size_ - written, offset + written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      LOG_DEBUG("I/O error while writing: %s", strerror(errno));
+      return false;
+    }
+    written += n;
+  }
+  return true;
+}
+
+auto PosixDiskManager::PreadPage(page_id_t page_id, char *page_data, size_t read_count) -> bool {
+  char *buffer = page_data;
+  if (direct_io_) {
+    read_count = 0;
+    if (!IsAligned(page_data)) {
+      buffer = BounceBuffer();
+    }
+  }
+  // A tablespace without a file reads as zeros, like the part of any file past its end.
+  const int fd = FileOf(page_id, false);
+  const int64_t offset = PageOffset(page_id);
+  while (read_count < page_size_) {
+    const ssize_t n = fd < 0 ? 0 : pread(fd, buffer + read_count, page_size_ - read_count, offset + read_count);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      LOG_DEBUG("I/O error while reading: %s", strerror(errno));
+      return false;
+    }
+    // The file ends before the page does. A direct read only comes up short there, and can't resume unaligned.
+    if (n == 0 || (direct_io_ && static_cast<size_t>(n) < page_size_ - read_count)) {
+      memset(buffer + read_count + n, 0, page_size_ - read_count - n);
+      break;
+    }
+    read_count += n;
+  }
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, page_size_);
+  }
+  return true;
+}
+
+}  // namespace bustub
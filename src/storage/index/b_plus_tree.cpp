@@ -1,4 +1,5 @@
 #include <string>
+#include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -9,13 +10,14 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, tablespace_id_t tablespace_id)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      extent_allocator_(buffer_pool_manager, tablespace_id) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::FindIndex(const KeyType &key, InternalPage *page_id) -> int {
@@ -144,6 +146,10 @@ void BPLUSTREE_TYPE::ClearTxPage(Transaction *transaction, LatchType type) {
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::OptimGetLeaf(const KeyType &key, LatchType type) -> Page * {
   auto last_buffer_page = buffer_pool_manager_->FetchPage(GetRootPageId());
+  if (last_buffer_page == nullptr) {
+    RootUnLock(LatchType::QUERRY);
+    return nullptr;
+  }
   Lock(last_buffer_page, LatchType::QUERRY);
   auto page = reinterpret_cast<BPlusTreePage *>(last_buffer_page->GetData());
   page->SetParentPageId(INVALID_PAGE_ID);
@@ -170,6 +176,16 @@ auto BPLUSTREE_TYPE::OptimGetLeaf(const KeyType &key, LatchType type) -> Page *
     int idx = FindIndex(key, last_page);
     page_id_t next_page_id = last_page->ValueAt(idx);
     auto next_buffer_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_buffer_page == nullptr) {
+      // all frames are pinned: let go of the parent and take the pessimistic path
+      bool is_root = last_page->IsRootPage();
+      ULock(last_buffer_page, LatchType::QUERRY);
+      buffer_pool_manager_->UnpinPage(last_buffer_page->GetPageId(), true);
+      if (is_root) {
+        RootUnLock(LatchType::QUERRY);
+      }
+      return nullptr;
+    }
     page = reinterpret_cast<BPlusTreePage *>(next_buffer_page->GetData());
     page->SetParentPageId(last_page->GetPageId());
     if (page->IsLeafPage()) {
@@ -191,6 +207,10 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetLeaf(const KeyType &key, Transaction *transaction, LatchType type)
     -> Page * {  // return the last page and the transaction has the last page
   auto last_buffer_page = buffer_pool_manager_->FetchPage(GetRootPageId());
+  if (last_buffer_page == nullptr) {
+    RootUnLock(type);
+    return nullptr;
+  }
   Lock(last_buffer_page, type);
   if (type != LatchType::QUERRY) {
     transaction->AddIntoPageSet(last_buffer_page);
@@ -205,6 +225,21 @@ auto BPLUSTREE_TYPE::GetLeaf(const KeyType &key, Transaction *transaction, Latch
     int idx = FindIndex(key, last_page);
     page_id_t next_page_id = last_page->ValueAt(idx);
     auto next_buffer_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_buffer_page == nullptr) {
+      // All frames are pinned, e.g. by other threads on their way down: release the whole path, so that they can
+      // finish, and let the caller start over.
+      if (type == LatchType::QUERRY) {
+        bool is_root = last_page->IsRootPage();
+        ULock(last_buffer_page, type);
+        buffer_pool_manager_->UnpinPage(last_buffer_page->GetPageId(), true);
+        if (is_root) {
+          RootUnLock(type);
+        }
+      } else {
+        ClearTxPage(transaction, type);
+      }
+      return nullptr;
+    }
     Lock(next_buffer_page, type);
     page = reinterpret_cast<BPlusTreePage *>(next_buffer_page->GetData());
     page->SetParentPageId(last_page->GetPageId());
@@ -242,8 +277,16 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_P
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  RootLock(LatchType::QUERRY);
-  auto buffer_page = GetLeaf(key, transaction, LatchType::QUERRY);  // buffer page
+  Page *buffer_page;
+  while (true) {
+    RootLock(LatchType::QUERRY);
+    buffer_page = GetLeaf(key, transaction, LatchType::QUERRY);  // buffer page
+    if (buffer_page != nullptr) {
+      break;
+    }
+    // every frame was pinned: the descent let go of its pages, so that the other threads can finish
+    std::this_thread::yield();
+  }
   bool flag = false;
   auto leaf_page = reinterpret_cast<LeafPage *>(buffer_page->GetData());  // data_page
   int idx = FindIndex(key, leaf_page);
@@ -272,14 +315,62 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  */
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::InsertInParent(page_id_t other_page_id, const KeyType &Key, Transaction *transaction) {
+auto BPLUSTREE_TYPE::NewSplitPages(LeafPage *leaf_page, Transaction *transaction, std::vector<Page *> *new_pages)
+    -> bool {
+  // one page for the leaf, one for every full ancestor above it, and a new root if the splits reach the root
+  size_t num_pages = 1;
+  bool splits_root = leaf_page->IsRootPage();
+  auto page_set = transaction->GetPageSet();
+  for (auto it = page_set->rbegin(); it != page_set->rend(); it++) {
+    auto page = reinterpret_cast<BPlusTreePage *>((*it)->GetData());
+    if (page->GetSize() != page->GetMaxSize()) {
+      break;
+    }
+    num_pages++;
+    splits_root = page->IsRootPage();
+  }
+  if (splits_root) {
+    num_pages++;
+  }
+  while (new_pages->size() < num_pages) {
+    page_id_t page_id;
+    auto buffer_page = extent_allocator_.NewPage(&page_id);
+    if (buffer_page == nullptr) {
+      ReleaseNewPages(new_pages);
+      return false;
+    }
+    new_pages->push_back(buffer_page);
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseNewPages(std::vector<Page *> *new_pages) {
+  for (auto new_page : *new_pages) {
+    extent_allocator_.ReleasePage(new_page->GetPageId());
+  }
+  new_pages->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TakeNewPage(std::vector<Page *> *new_pages, page_id_t *page_id) -> Page * {
+  BUSTUB_ASSERT(!new_pages->empty(), "a split needs more pages than were created for it");
+  auto buffer_page = new_pages->back();
+  new_pages->pop_back();
+  *page_id = buffer_page->GetPageId();
+  return buffer_page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertInParent(page_id_t other_page_id, const KeyType &Key, Transaction *transaction,
+                                    std::vector<Page *> *new_pages) {
   auto parent_buffer_page = transaction->GetPageSet()->back();
   transaction->GetPageSet()->pop_back();
   auto parent_page = reinterpret_cast<InternalPage *>(parent_buffer_page->GetData());
   auto parent_page_id = parent_page->GetPageId();
   if (parent_page->GetSize() == parent_page->GetMaxSize()) {
     page_id_t new_page_id;
-    auto new_buffer_page = buffer_pool_manager_->NewPage(&new_page_id);
+    auto new_buffer_page = TakeNewPage(new_pages, &new_page_id);
     auto new_page = reinterpret_cast<InternalPage *>(new_buffer_page->GetData());
     new_page->Init(new_page_id, parent_page->GetParentPageId(), internal_max_size_);
     std::vector<std::pair<KeyType, page_id_t>> tmp(parent_page->GetArray(),
@@ -311,7 +402,7 @@ void BPLUSTREE_TYPE::InsertInParent(page_id_t other_page_id, const KeyType &Key,
 
     if (parent_page->IsRootPage()) {
       page_id_t root_id;
-      auto root_buffer_page = buffer_pool_manager_->NewPage(&root_id);
+      auto root_buffer_page = TakeNewPage(new_pages, &root_id);
       Lock(root_buffer_page, LatchType::INSERT);
       auto root_page = reinterpret_cast<InternalPage *>(root_buffer_page->GetData());
       root_page->Init(root_id, INVALID_PAGE_ID, internal_max_size_);
@@ -325,7 +416,7 @@ void BPLUSTREE_TYPE::InsertInParent(page_id_t other_page_id, const KeyType &Key,
     buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
     buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
 
-    InsertInParent(new_page_id, tmp_key, transaction);
+    InsertInParent(new_page_id, tmp_key, transaction, new_pages);
     return;
   }
   int idx = FindIndex(Key, parent_page);
@@ -340,6 +431,17 @@ void BPLUSTREE_TYPE::InsertInParent(page_id_t other_page_id, const KeyType &Key,
 
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) -> bool {
+  bool inserted;
+  while (!TryInsert(key, value, transaction, &inserted)) {
+    // every frame was pinned: the insert let go of its pages, so that the other threads can finish
+    std::this_thread::yield();
+  }
+  return inserted;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TryInsert(const KeyType &key, const ValueType &value, Transaction *transaction, bool *inserted)
+    -> bool {
   // LOG_DEBUG("InsertRootLock");
   if (IsEmpty()) {
     RootLock(LatchType::INSERT);
@@ -348,7 +450,11 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   }
   if (IsEmpty()) {
     page_id_t root_id;
-    auto buffer_page = buffer_pool_manager_->NewPage(&root_id);
+    auto buffer_page = extent_allocator_.NewPage(&root_id);
+    if (buffer_page == nullptr) {
+      RootUnLock(LatchType::INSERT);
+      return false;
+    }
     auto page = reinterpret_cast<LeafPage *>(buffer_page->GetData());
     page->Init(root_id, INVALID_PAGE_ID, leaf_max_size_);
     page->SetSize(1);
@@ -360,12 +466,16 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     UpdateRootPageId(true);
     buffer_pool_manager_->UnpinPage(root_id, true);
     RootUnLock(LatchType::INSERT);
+    *inserted = true;
     return true;
   }
   auto leaf_buffer_page = OptimGetLeaf(key, LatchType::INSERT);
   if (leaf_buffer_page == nullptr) {
     RootLock(LatchType::INSERT);
     leaf_buffer_page = GetLeaf(key, transaction, LatchType::INSERT);
+    if (leaf_buffer_page == nullptr) {
+      return false;
+    }
     transaction->GetPageSet()->pop_back();
   }
   auto leaf_page = reinterpret_cast<LeafPage *>(leaf_buffer_page->GetData());  // data_page
@@ -378,6 +488,21 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     if (is_root) {
       RootUnLock(LatchType::INSERT);
     }
+    *inserted = false;
+    return true;
+  }
+
+  // create the pages of the split before changing anything, so that running out of frames can still start over
+  std::vector<Page *> new_pages;
+  if (leaf_page->GetSize() + 1 == leaf_page->GetMaxSize() &&
+      !NewSplitPages(leaf_page, transaction, &new_pages)) {
+    ClearTxPage(transaction, LatchType::INSERT);
+    bool is_root = leaf_page->IsRootPage();
+    ULock(leaf_buffer_page, LatchType::INSERT);
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+    if (is_root) {
+      RootUnLock(LatchType::INSERT);
+    }
     return false;
   }
 
@@ -385,7 +510,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   if (leaf_page->GetSize() == leaf_page->GetMaxSize()) {
     // leaf split
     page_id_t other_page_id;
-    auto other_buffer_page = buffer_pool_manager_->NewPage(&other_page_id);
+    auto other_buffer_page = TakeNewPage(&new_pages, &other_page_id);
     auto other_page = reinterpret_cast<LeafPage *>(other_buffer_page->GetData());
     other_page->Init(other_page_id, leaf_page->GetParentPageId(), leaf_max_size_);
 
@@ -405,7 +530,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     KeyType tmp_key = other_page->KeyAt(0);
     if (leaf_page->IsRootPage()) {
       page_id_t root_id;
-      auto root_buffer_page = buffer_pool_manager_->NewPage(&root_id);
+      auto root_buffer_page = TakeNewPage(&new_pages, &root_id);
       Lock(root_buffer_page, LatchType::INSERT);
       auto root_page = reinterpret_cast<InternalPage *>(root_buffer_page->GetData());
       root_page->Init(root_id, INVALID_PAGE_ID, internal_max_size_);
@@ -418,7 +543,9 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     ULock(leaf_buffer_page, LatchType::INSERT);
     buffer_pool_manager_->UnpinPage(other_page->GetPageId(), true);
     buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-    InsertInParent(other_page_id, tmp_key, transaction);
+    InsertInParent(other_page_id, tmp_key, transaction, &new_pages);
+    ReleaseNewPages(&new_pages);
+    *inserted = true;
     return true;
   }
   // ClearTxPage(transaction, LatchType::INSERT);
@@ -428,6 +555,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   if (is_root) {
     RootUnLock(LatchType::INSERT);
   }
+  *inserted = true;
   return true;
 }
 
@@ -526,12 +654,23 @@ void BPLUSTREE_TYPE::DeleteFromParent(page_id_t delete_page_id, Transaction *tra
 }
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  while (!TryRemove(key, transaction)) {
+    // every frame was pinned: the descent let go of its pages, so that the other threads can finish
+    std::this_thread::yield();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TryRemove(const KeyType &key, Transaction *transaction) -> bool {
   // LOG_DEBUG("RemoveRootLock");
   RootLock(LatchType::QUERRY);
   auto leaf_buffer_page = OptimGetLeaf(key, LatchType::DELETE);
   if (leaf_buffer_page == nullptr) {
     RootLock(LatchType::DELETE);
     leaf_buffer_page = GetLeaf(key, transaction, LatchType::DELETE);
+    if (leaf_buffer_page == nullptr) {
+      return false;
+    }
     transaction->GetPageSet()->pop_back();
   }
   auto leaf_page = reinterpret_cast<LeafPage *>(leaf_buffer_page->GetData());
@@ -543,19 +682,19 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
     if (is_root) {
       RootUnLock(LatchType::DELETE);
     }
-    return;
+    return true;
   }
   if (leaf_page->IsRootPage()) {
     ULock(leaf_buffer_page, LatchType::DELETE);
     buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
     RootUnLock(LatchType::DELETE);
-    return;
+    return true;
   }
 
   if (leaf_page->GetSize() >= leaf_page->GetMinSize()) {
     ULock(leaf_buffer_page, LatchType::DELETE);
     buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-    return;
+    return true;
   }
 
   auto parent_buffer_page = transaction->GetPageSet()->back();
@@ -611,6 +750,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
     buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
     buffer_pool_manager_->UnpinPage(other_page->GetPageId(), true);
   }
+  return true;
 }
 
 /*****************************************************************************
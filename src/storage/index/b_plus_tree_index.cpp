@@ -16,10 +16,16 @@ namespace bustub {
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
+                                     tablespace_id_t tablespace_id)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      // nodes fill the pages, whatever the page size of the database
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_,
+                 static_cast<int>((buffer_pool_manager->GetPageSize() - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType)),
+                 static_cast<int>((buffer_pool_manager->GetPageSize() - INTERNAL_PAGE_HEADER_SIZE) /
+                                  sizeof(MappingType)),
+                 tablespace_id) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
@@ -45,6 +45,7 @@ INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
   if (pos_ == page_->GetSize() - 1) {
     page_id_t next_id = page_->GetNextPageId();
+    read_ahead_.OnPageChange(buffer_pool_manager_, page_->GetPageId(), next_id);
     buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
     page_ = GetPage(next_id);
     pos_ = 0;
@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_bitmap_page.cpp
+//
+// Identification: src/storage/page/free_page_bitmap_page.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/free_page_bitmap_page.h"
+
+#include <cstring>
+
+namespace bustub {
+
+void FreePageBitmapPage::Init() {
+  high_water_mark_ = 0;
+  num_free_ = 0;
+  memset(bitmap_, 0, sizeof(bitmap_));
+}
+
+auto FreePageBitmapPage::IsFree(uint32_t slot) const -> bool { return (bitmap_[slot / 8] & (1U << (slot % 8))) != 0; }
+
+auto FreePageBitmapPage::SetFree(uint32_t slot, bool free) -> bool {
+  if (IsFree(slot) == free) {
+    return false;
+  }
+  if (free) {
+    bitmap_[slot / 8] |= static_cast<uint8_t>(1U << (slot % 8));
+    num_free_++;
+  } else {
+    bitmap_[slot / 8] &= static_cast<uint8_t>(~(1U << (slot % 8)));
+    num_free_--;
+  }
+  return true;
+}
+
+auto FreePageBitmapPage::FindFirstFree() const -> uint32_t {
+  if (num_free_ == 0) {
+    return SLOTS_PER_PAGE;
+  }
+  // Skip whole words of allocated slots before looking at single bits.
+  for (uint32_t i = 0; i < sizeof(bitmap_); i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bitmap_ + i, sizeof(word));
+    if (word != 0) {
+      return i * 8 + static_cast<uint32_t>(__builtin_ctzll(word));
+    }
+  }
+  return SLOTS_PER_PAGE;
+}
+
+}  // namespace bustub
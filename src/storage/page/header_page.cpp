@@ -16,6 +16,23 @@
 
 namespace bustub {
 
+void HeaderPage::InitData(char *data, uint32_t page_size) {
+  memcpy(data + OFFSET_MAGIC, &MAGIC, sizeof(uint32_t));
+  memcpy(data + OFFSET_PAGE_SIZE, &page_size, sizeof(uint32_t));
+  memset(data + OFFSET_RECORD_COUNT, 0, sizeof(uint32_t));
+}
+
+auto HeaderPage::ReadPageSize(const char *data) -> uint32_t {
+  uint32_t magic;
+  memcpy(&magic, data + OFFSET_MAGIC, sizeof(uint32_t));
+  if (magic != MAGIC) {
+    return 0;
+  }
+  uint32_t page_size;
+  memcpy(&page_size, data + OFFSET_PAGE_SIZE, sizeof(uint32_t));
+  return page_size;
+}
+
 /**
  * Record related
  */
@@ -24,7 +41,7 @@ auto HeaderPage::InsertRecord(const std::string &name, const page_id_t root_id)
   assert(root_id > INVALID_PAGE_ID);
 
   int record_num = GetRecordCount();
-  int offset = 4 + record_num * 36;
+  int offset = OFFSET_RECORDS + record_num * RECORD_SIZE;
   // check for duplicate name
   if (FindRecord(name) != -1) {
     return false;
@@ -46,8 +63,8 @@ auto HeaderPage::DeleteRecord(const std::string &name) -> bool {
   if (index == -1) {
     return false;
   }
-  int offset = index * 36 + 4;
-  memmove(GetData() + offset, GetData() + offset + 36, (record_num - index - 1) * 36);
+  int offset = OFFSET_RECORDS + index * RECORD_SIZE;
+  memmove(GetData() + offset, GetData() + offset + RECORD_SIZE, (record_num - index - 1) * RECORD_SIZE);
 
   SetRecordCount(record_num - 1);
   return true;
@@ -61,7 +78,7 @@ auto HeaderPage::UpdateRecord(const std::string &name, const page_id_t root_id)
   if (index == -1) {
     return false;
   }
-  int offset = index * 36 + 4;
+  int offset = OFFSET_RECORDS + index * RECORD_SIZE;
   // update record content, only root_id
   memcpy((GetData() + offset + 32), &root_id, 4);
 
@@ -76,7 +93,7 @@ auto HeaderPage::GetRootId(const std::string &name, page_id_t *root_id) -> bool
   if (index == -1) {
     return false;
   }
-  int offset = (index + 1) * 36;
+  int offset = OFFSET_RECORDS + index * RECORD_SIZE + 32;
   *root_id = *reinterpret_cast<page_id_t *>(GetData() + offset);
 
   return true;
@@ -86,15 +103,15 @@ auto HeaderPage::GetRootId(const std::string &name, page_id_t *root_id) -> bool
  * helper functions
  */
 // record count
-auto HeaderPage::GetRecordCount() -> int { return *reinterpret_cast<int *>(GetData()); }
+auto HeaderPage::GetRecordCount() -> int { return *reinterpret_cast<int *>(GetData() + OFFSET_RECORD_COUNT); }
 
-void HeaderPage::SetRecordCount(int record_count) { memcpy(GetData(), &record_count, 4); }
+void HeaderPage::SetRecordCount(int record_count) { memcpy(GetData() + OFFSET_RECORD_COUNT, &record_count, 4); }
 
 auto HeaderPage::FindRecord(const std::string &name) -> int {
   int record_num = GetRecordCount();
 
   for (int i = 0; i < record_num; i++) {
-    char *raw_name = reinterpret_cast<char *>(GetData() + (4 + i * 36));
+    char *raw_name = reinterpret_cast<char *>(GetData() + OFFSET_RECORDS + i * RECORD_SIZE);
     if (strcmp(raw_name, name.c_str()) == 0) {
       return i;
     }
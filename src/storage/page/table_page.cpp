@@ -71,21 +71,13 @@ auto TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, Lock
     SetTupleCount(GetTupleCount() + 1);
   }
 
-  /**
-   * Removed to support new lock manager API for p4 (multilevel locking); Big hack energy
-   * This clause was used in logging and recovery projects previously; not being used right now
-   */
-  //  // Write the log record.
-  //  if (enable_logging) {
-  //    BUSTUB_ASSERT(!txn->IsSharedLocked(*rid) && !txn->IsExclusiveLocked(*rid), "A new tuple should not be locked.");
-  //    // Acquire an exclusive lock on the new tuple.
-  //    bool locked = lock_manager->LockExclusive(txn, *rid);
-  //    BUSTUB_ENSURE(locked, "Locking a new tuple should always work.");
-  //    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, *rid, tuple);
-  //    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
-  //    SetLSN(lsn);
-  //    txn->SetPrevLSN(lsn);
-  //  }
+  // Write the log record. Tuple locks are taken by the executors through the multilevel lock manager API.
+  if (enable_logging) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, *rid, tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
   return true;
 }
 
@@ -109,25 +101,13 @@ auto TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_m
     return false;
   }
 
-  /**
-   * Removed to support new lock manager API for p4 (multilevel locking); Big hack energy
-   * This clause was used in logging and recovery projects previously; not being used right now
-   */
-  //  if (enable_logging) {
-  //    // Acquire an exclusive lock, upgrading from a shared lock if necessary.
-  //    if (txn->IsSharedLocked(rid)) {
-  //      if (!lock_manager->LockUpgrade(txn, rid)) {
-  //        return false;
-  //      }
-  //    } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid)) {
-  //      return false;
-  //    }
-  //    Tuple dummy_tuple;
-  //    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::MARKDELETE, rid, dummy_tuple);
-  //    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
-  //    SetLSN(lsn);
-  //    txn->SetPrevLSN(lsn);
-  //  }
+  if (enable_logging) {
+    Tuple dummy_tuple;
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::MARKDELETE, rid, dummy_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
 
   // Mark the tuple as deleted.
   if (tuple_size > 0) {
@@ -171,22 +151,13 @@ auto TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
   old_tuple->rid_ = rid;
   old_tuple->allocated_ = true;
 
-  /**
-   * Removed to support new lock manager API for p4 (multilevel locking); Big hack energy
-   * This clause was used in logging and recovery projects previously; not being used right now
-   */
-  //  if (enable_logging) {
-  //    // Acquire an exclusive lock, upgrading from shared if necessary.
-  //    if (txn->IsSharedLocked(rid)) {
-  //      if (!lock_manager->LockUpgrade(txn, rid)) {
-  //        return false;
-  //      }
-  //    } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid)) {
-  //      return false;
-  //    }
-  //    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::UPDATE, rid, *old_tuple,
-  //    new_tuple); lsn_t lsn = log_manager->AppendLogRecord(&log_record); SetLSN(lsn); txn->SetPrevLSN(lsn);
-  //  }
+  if (enable_logging) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::UPDATE, rid, *old_tuple,
+                         new_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
 
   // Perform the update.
   uint32_t free_space_pointer = GetFreeSpacePointer();
@@ -228,18 +199,12 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_ma
   delete_tuple.rid_ = rid;
   delete_tuple.allocated_ = true;
 
-  /**
-   * Removed to support new lock manager API for p4 (multilevel locking); Big hack energy
-   * This clause was used in logging and recovery projects previously; not being used right now
-   */
-  //  if (enable_logging) {
-  //    BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own the exclusive lock!");
-  //
-  //    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::APPLYDELETE, rid, delete_tuple);
-  //    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
-  //    SetLSN(lsn);
-  //    txn->SetPrevLSN(lsn);
-  //  }
+  if (enable_logging) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::APPLYDELETE, rid, delete_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
 
   uint32_t free_space_pointer = GetFreeSpacePointer();
   BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
@@ -261,16 +226,14 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_ma
 
 void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
   // Log the rollback.
-  /**
-   * Removed to support new lock manager API for p4 (multilevel locking); Big hack energy
-   * This clause was used in logging and recovery projects previously; not being used right now
-   */
-  //  if (enable_logging) {
-  //    BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own an exclusive lock on the RID.");
-  //    Tuple dummy_tuple;
-  //    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ROLLBACKDELETE, rid,
-  //    dummy_tuple); lsn_t lsn = log_manager->AppendLogRecord(&log_record); SetLSN(lsn); txn->SetPrevLSN(lsn);
-  //  }
+  if (enable_logging) {
+    Tuple dummy_tuple;
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ROLLBACKDELETE, rid,
+                         dummy_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
 
   uint32_t slot_num = rid.GetSlotNum();
   BUSTUB_ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
@@ -282,6 +245,20 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log
   }
 }
 
+auto TablePage::RestoreTuple(const Tuple &tuple, const RID &rid) -> bool {
+  BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
+  uint32_t slot_num = rid.GetSlotNum();
+  // The slot is still there, as slots are never removed, unless it is in use again.
+  if (slot_num >= GetTupleCount() || GetTupleSize(slot_num) != 0 || GetFreeSpaceRemaining() < tuple.size_) {
+    return false;
+  }
+  SetFreeSpacePointer(GetFreeSpacePointer() - tuple.size_);
+  memcpy(GetData() + GetFreeSpacePointer(), tuple.data_, tuple.size_);
+  SetTupleOffsetAtSlot(slot_num, GetFreeSpacePointer());
+  SetTupleSize(slot_num, tuple.size_);
+  return true;
+}
+
 auto TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) -> bool {
   // Get the current slot number.
   uint32_t slot_num = rid.GetSlotNum();
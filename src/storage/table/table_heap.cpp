@@ -14,6 +14,7 @@
 
 #include "common/logger.h"
 #include "fmt/format.h"
+#include "storage/disk/tablespace.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -23,26 +24,31 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      extent_allocator_(buffer_pool_manager, TablespaceOf(first_page_id)) {}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+                     Transaction *txn, tablespace_id_t tablespace_id)
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      extent_allocator_(buffer_pool_manager, tablespace_id) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  auto first_page = reinterpret_cast<TablePage *>(extent_allocator_.NewPage(&first_page_id_));
   BUSTUB_ASSERT(first_page != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
-  first_page->Init(first_page_id_, BUSTUB_PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  first_page->Init(first_page_id_, buffer_pool_manager_->GetPageSize(), INVALID_LSN, log_manager_, txn);
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  num_pages_++;
 }
 
-auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
-  if (tuple.size_ + 32 > BUSTUB_PAGE_SIZE) {  // larger than one page size
+auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy) -> bool {
+  if (tuple.size_ + 32 > buffer_pool_manager_->GetPageSize()) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(first_page_id_, strategy));
   if (cur_page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
@@ -56,7 +62,7 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
     auto next_page_id = cur_page->GetNextPageId();
     // If the next page is a valid page,
     if (next_page_id != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+      auto next_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(next_page_id, strategy));
       next_page->WLatch();
       // Unlatch and unpin the current page.
       cur_page->WUnlatch();
@@ -64,7 +70,7 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
       cur_page = next_page;
     } else {
       // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      auto new_page = static_cast<TablePage *>(extent_allocator_.NewPage(&next_page_id, strategy));
       // If we could not create a new page,
       if (new_page == nullptr) {
         // Then life sucks and we abort the transaction.
@@ -74,9 +80,10 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
         return false;
       }
       // Otherwise we were able to create a new page. We initialize it now.
+      num_pages_++;
       new_page->WLatch();
       cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, BUSTUB_PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+      new_page->Init(next_page_id, buffer_pool_manager_->GetPageSize(), cur_page->GetTablePageId(), log_manager_, txn);
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
       cur_page = new_page;
@@ -176,13 +183,13 @@ auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool ac
   return res;
 }
 
-auto TableHeap::Begin(Transaction *txn) -> TableIterator {
+auto TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) -> TableIterator {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
@@ -193,7 +200,7 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
     }
     page_id = page->GetNextPageId();
   }
-  return {this, rid, txn};
+  return {this, rid, txn, strategy};
 }
 
 auto TableHeap::End() -> TableIterator { return {this, RID(INVALID_PAGE_ID, 0), nullptr}; }
@@ -18,8 +18,8 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn), strategy_(strategy) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_)) {
       throw bustub::Exception("read non-existing tuple");
@@ -47,7 +47,12 @@ auto TableIterator::operator++() -> TableIterator & {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      // Read-ahead would load the upcoming pages into the shared pool, so a scan with its own ring does without it.
+      if (strategy_ == nullptr) {
+        read_ahead_.OnPageChange(buffer_pool_manager, cur_page->GetTablePageId(), cur_page->GetNextPageId());
+      }
+      auto next_page = static_cast<TablePage *>(
+          buffer_pool_manager->FetchPageWithStrategy(cur_page->GetNextPageId(), strategy_));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
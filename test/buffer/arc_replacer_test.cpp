@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: load pages 1 to 4 into frames 0 to 3. They all enter T1; page 1 is accessed again and moves to T2.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    arc_replacer.RecordLoad(frame_id, frame_id + 1);
+    arc_replacer.SetEvictable(frame_id, true);
+  }
+  arc_replacer.RecordAccess(0);
+  EXPECT_EQ(4, arc_replacer.Size());
+  EXPECT_EQ(0, arc_replacer.GetTargetT1Size());
+
+  // Scenario: T1 is over its target, so its least recently used page (page 2) is evicted into B1.
+  int value;
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: page 2 misses in B1, so T1 should have been larger. The page enters T2.
+  arc_replacer.RecordLoad(1, 2);
+  arc_replacer.SetEvictable(1, true);
+  EXPECT_EQ(1, arc_replacer.GetTargetT1Size());
+
+  // Scenario: T1 is evicted down to its target, then T2 gives up its least recently used page (page 1) into B2.
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: page 1 misses in B2, so T2 should have been larger.
+  arc_replacer.RecordLoad(0, 1);
+  arc_replacer.SetEvictable(0, true);
+  EXPECT_EQ(0, arc_replacer.GetTargetT1Size());
+
+  // Scenario: pinned frames are never evicted.
+  arc_replacer.SetEvictable(3, false);
+  arc_replacer.SetEvictable(0, false);
+  ASSERT_TRUE(arc_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_FALSE(arc_replacer.Evict(&value));
+  EXPECT_EQ(0, arc_replacer.Size());
+}
+
+}  // namespace bustub
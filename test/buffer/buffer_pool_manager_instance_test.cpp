@@ -12,15 +12,63 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/extent_allocator.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
+/** An in-memory disk manager whose reads of one page block until they are released by the test. */
+class BlockingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  explicit BlockingDiskManager(page_id_t blocked_page_id) : blocked_page_id_(blocked_page_id) {}
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    num_reads_++;
+    if (page_id == blocked_page_id_) {
+      blocked_reads_++;
+      read_started_.set_value();
+      release_.get_future().wait();
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  page_id_t blocked_page_id_;
+  std::atomic<int> num_reads_{0};
+  std::atomic<int> blocked_reads_{0};
+  std::promise<void> read_started_;
+  std::promise<void> release_;
+};
+
+/** An in-memory disk manager whose page writes fail while `fail_` is set. */
+class FailingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void WritePage(page_id_t page_id, const char *page_data) override {
+    num_writes_++;
+    if (fail_) {
+      throw Exception("I/O error while writing page");
+    }
+    DiskManagerUnlimitedMemory::WritePage(page_id, page_data);
+  }
+
+  std::atomic<bool> fail_{false};
+  std::atomic<int> num_writes_{0};
+};
+
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
 TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
@@ -145,4 +193,607 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, IOOutsideLatchTest) {
+  const size_t buffer_pool_size = 3;
+  const size_t k = 2;
+
+  auto *disk_manager = new BlockingDiskManager(0);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Fill the pool with pages {0, 1, 2}, then create page 3, which evicts page 0 and writes it back.
+  page_id_t page_id_temp;
+  for (int i = 0; i < 4; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: a fetch of page 0 evicts the dirty page 1 and then blocks while reading page 0 from disk.
+  Page *page0_a = nullptr;
+  std::thread reader_a([&] { page0_a = bpm->FetchPage(0); });
+  disk_manager->read_started_.get_future().wait();
+
+  // Scenario: a second fetch of page 0 waits for the first read instead of issuing another one.
+  Page *page0_b = nullptr;
+  std::thread reader_b([&] { page0_b = bpm->FetchPage(0); });
+
+  // Scenario: a hit on a cached page does not wait for the read of page 0.
+  auto hit = std::async(std::launch::async, [&] { return bpm->FetchPage(3); });
+  ASSERT_EQ(std::future_status::ready, hit.wait_for(std::chrono::seconds(10)));
+  auto *page3 = hit.get();
+  ASSERT_NE(nullptr, page3);
+  EXPECT_EQ(0, strcmp(page3->GetData(), "page 3"));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+
+  disk_manager->release_.set_value();
+  reader_a.join();
+  reader_b.join();
+
+  // Scenario: both fetchers got the same frame, holding the data read from disk, and the page was read only once.
+  ASSERT_NE(nullptr, page0_a);
+  EXPECT_EQ(page0_a, page0_b);
+  EXPECT_EQ(0, strcmp(page0_a->GetData(), "page 0"));
+  EXPECT_EQ(2, page0_a->GetPinCount());
+  EXPECT_EQ(1, disk_manager->blocked_reads_.load());
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: page 1 was written back while page 0 was being read.
+  auto *page1 = bpm->FetchPage(1);
+  ASSERT_NE(nullptr, page1);
+  EXPECT_EQ(0, strcmp(page1->GetData(), "page 1"));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Scenario: without the cleaner, every eviction of a dirty page is counted as a dirty eviction.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size + 2; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(0, bpm->GetCleanEvictions());
+  EXPECT_EQ(2, bpm->GetDirtyEvictions());
+
+  // Scenario: with a clean ratio of 1, the cleaner eventually writes back every unpinned page.
+  bpm->StartPageCleaner(1.0);
+  auto all_clean = [&] {
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      if (bpm->GetPages()[i].IsDirty()) {
+        return false;
+      }
+    }
+    return true;
+  };
+  for (int i = 0; i < 1000 && !all_clean(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_TRUE(all_clean());
+
+  // Scenario: the following evictions find clean victims.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetCleanEvictions());
+  EXPECT_EQ(2, bpm->GetDirtyEvictions());
+  bpm->StopPageCleaner();
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto *disk_manager = new BlockingDiskManager(INVALID_PAGE_ID);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Create twice as many pages as fit into the pool, so that pages {0, ..., 9} are only on disk.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(0, disk_manager->num_reads_.load());
+
+  // Scenario: prefetched pages are read in the background. Pages that were never allocated are skipped.
+  bpm->PrefetchPages({0, 1, 2, 3, 4, 100});
+  for (int i = 0; i < 1000 && disk_manager->num_reads_ < 5; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(5, disk_manager->num_reads_.load());
+
+  // Scenario: fetching the prefetched pages does not read them again, and the prefetcher left them unpinned.
+  for (page_id_t page_id = 0; page_id < 5; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(5, disk_manager->num_reads_.load());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BufferAccessStrategyTest) {
+  const size_t buffer_pool_size = 40;
+  const size_t k = 2;
+  const page_id_t num_hot_pages = 10;
+  const page_id_t num_scanned_pages = 100;
+
+  auto *disk_manager = new BlockingDiskManager(INVALID_PAGE_ID);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // The hot working set lives in the buffer pool; the table to be scanned lives on disk.
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_hot_pages; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  char data[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = num_hot_pages; page_id < num_hot_pages + num_scanned_pages; page_id++) {
+    snprintf(data, BUSTUB_PAGE_SIZE, "page %d", page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+
+  // Scenario: a scan through a ring only recycles its own frames, at most an eighth of the pool.
+  BufferAccessStrategy strategy(BufferAccessStrategy::Type::BULK_READ, BULK_READ_RING_SIZE);
+  for (page_id_t page_id = num_hot_pages; page_id < num_hot_pages + num_scanned_pages; page_id++) {
+    auto *page = bpm->FetchPageWithStrategy(page_id, &strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_scanned_pages, disk_manager->num_reads_.load());
+  EXPECT_EQ(num_scanned_pages - buffer_pool_size / 8, bpm->GetCleanEvictions());
+
+  // Scenario: the hot pages are still cached, and the rest of the pool is still free.
+  for (page_id_t page_id = 0; page_id < num_hot_pages; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_scanned_pages, disk_manager->num_reads_.load());
+  const size_t num_free = buffer_pool_size - num_hot_pages - buffer_pool_size / 8;
+  for (size_t i = 0; i < num_free; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(num_scanned_pages - buffer_pool_size / 8, bpm->GetCleanEvictions());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  auto check_page = [&](page_id_t page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), std::to_string(page_id).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  };
+
+  // Scenario: grow the pool across several chunks. Every page created afterwards stays resident.
+  std::vector<page_id_t> page_ids;
+  const size_t large_pool_size = 3 * BUFFER_POOL_CHUNK_SIZE + 10;
+  for (size_t i = 0; i < large_pool_size; i++) {
+    if (i == buffer_pool_size) {
+      ASSERT_TRUE(bpm->Resize(large_pool_size));
+      EXPECT_EQ(large_pool_size, bpm->GetPoolSize());
+    }
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    page_ids.push_back(page_id);
+  }
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(0, bpm->GetCleanEvictions() + bpm->GetDirtyEvictions());
+
+  // Scenario: shrink the pool while another thread keeps fetching pages. The dropped pages are written back first.
+  std::atomic<bool> stop = false;
+  std::thread fetcher([&] {
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+    while (!stop) {
+      check_page(page_ids[dist(gen)]);
+    }
+  });
+  ASSERT_TRUE(bpm->Resize(5));
+  stop = true;
+  fetcher.join();
+  EXPECT_EQ(5, bpm->GetPoolSize());
+  for (auto page_id : page_ids) {
+    check_page(page_id);
+  }
+
+  // Scenario: frames that stay pinned cannot be withdrawn, and the pool keeps its size.
+  const auto withdraw_timeout = buffer_pool_withdraw_timeout;
+  buffer_pool_withdraw_timeout = std::chrono::milliseconds(50);
+  for (size_t i = 0; i < 5; i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+  }
+  EXPECT_FALSE(bpm->Resize(1));
+  EXPECT_EQ(5, bpm->GetPoolSize());
+  for (size_t i = 0; i < 5; i++) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+  buffer_pool_withdraw_timeout = withdraw_timeout;
+
+  // Scenario: once unpinned, the pool shrinks to a single frame and grows back into its spare frames.
+  ASSERT_TRUE(bpm->Resize(1));
+  EXPECT_EQ(1, bpm->GetPoolSize());
+  check_page(page_ids[7]);
+  ASSERT_TRUE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  for (auto page_id : page_ids) {
+    check_page(page_id);
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FreePageReuseTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (page_id_t page_id = 0; page_id < 20; page_id++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(page_id, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: deleted pages are handed out again, lowest page id first, whether or not they were resident.
+  EXPECT_EQ(true, bpm->DeletePage(17));
+  EXPECT_EQ(true, bpm->DeletePage(2));
+  EXPECT_EQ(true, bpm->DeletePage(2));
+  for (page_id_t page_id : {2, 17, 20}) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(page_id, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: after a flush and a restart, allocation continues where it stopped and free pages are remembered.
+  EXPECT_EQ(true, bpm->DeletePage(5));
+  bpm->FlushAllPages();
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  for (page_id_t page_id : {5, 21}) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(page_id, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: without a full flush, a restart skips the page ids that may have been allocated, but never reuses one
+  // whose page reached disk.
+  EXPECT_EQ(true, bpm->FlushPage(21));
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_GT(page_id_temp, 21);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ExtentTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t k = 2;
+  const size_t extent_size = 8;
+
+  auto *disk_manager = new BlockingDiskManager(INVALID_PAGE_ID);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (page_id_t page_id = 0; page_id < 3; page_id++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: two allocators taking turns each fill runs of contiguous pages instead of interleaving.
+  ExtentAllocator first(bpm, DEFAULT_TABLESPACE, extent_size);
+  ExtentAllocator second(bpm, DEFAULT_TABLESPACE, extent_size);
+  std::vector<page_id_t> first_ids;
+  std::vector<page_id_t> second_ids;
+  for (size_t i = 0; i < extent_size + 4; i++) {
+    for (auto [allocator, ids] : {std::make_pair(&first, &first_ids), std::make_pair(&second, &second_ids)}) {
+      auto *page = allocator->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+      ids->push_back(page_id_temp);
+    }
+  }
+  for (size_t i = 0; i < extent_size; i++) {
+    EXPECT_EQ(static_cast<page_id_t>(3 + i), first_ids[i]);
+    EXPECT_EQ(static_cast<page_id_t>(3 + extent_size + i), second_ids[i]);
+  }
+  EXPECT_EQ(static_cast<page_id_t>(3 + 2 * extent_size), first_ids[extent_size]);
+  EXPECT_EQ(static_cast<page_id_t>(3 + 3 * extent_size), second_ids[extent_size]);
+
+  // Scenario: single pages are allocated past the reserved runs.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(static_cast<page_id_t>(3 + 4 * extent_size), page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: a reserved page that read-ahead loaded before it was created is reused, and comes back zeroed.
+  const page_id_t reserved_page_id = first_ids.back() + 1;
+  bpm->PrefetchPages({reserved_page_id});
+  for (int i = 0; i < 1000 && disk_manager->num_reads_ < 1; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(1, disk_manager->num_reads_.load());
+  auto *page = first.NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(reserved_page_id, page_id_temp);
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  for (const auto &ids : {first_ids, second_ids}) {
+    for (auto page_id : ids) {
+      page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+
+  // Scenario: after a restart, the unused rest of the runs is not handed out again.
+  bpm->FlushAllPages();
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  ExtentAllocator third(bpm, DEFAULT_TABLESPACE, extent_size);
+  ASSERT_NE(nullptr, third.NewPage(&page_id_temp));
+  EXPECT_GT(page_id_temp, static_cast<page_id_t>(3 + 4 * extent_size));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const size_t buffer_pool_size = 1;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Scenario: with a single frame, every access to another page evicts the resident one.
+  page_id_t page_id_temp;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->FlushPage(0));
+
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(2, stats.new_pages_);
+  EXPECT_EQ(1, stats.fetch_hits_);
+  EXPECT_EQ(1, stats.fetch_misses_);
+  EXPECT_DOUBLE_EQ(0.5, stats.HitRatio());
+  EXPECT_EQ(1, stats.clean_evictions_);
+  EXPECT_EQ(1, stats.dirty_evictions_);
+  EXPECT_EQ(1, stats.flushes_);
+  EXPECT_EQ(1, stats.disk_reads_);
+  EXPECT_EQ(2, stats.disk_writes_);
+
+  // Scenario: counts from many threads add up, no matter which counter slot each thread used.
+  const int num_threads = BUFFER_POOL_STATS_SLOTS * 2;
+  const int num_fetches = 100;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < num_fetches; j++) {
+        if (bpm->FetchPage(0) != nullptr) {
+          bpm->UnpinPage(0, false);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  stats = bpm->GetStats();
+  EXPECT_EQ(1 + num_threads * num_fetches, stats.fetch_hits_);
+  EXPECT_EQ(1, stats.fetch_misses_);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BatchedIOTest) {
+  const size_t buffer_pool_size = 64;
+  const size_t k = 2;
+  const int num_pages = 100;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+
+  auto *disk_manager = new AsyncDiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Scenario: dirty evictions, the page cleaner and FlushAllPages write through batches of the disk manager.
+  bpm->StartPageCleaner(1.0);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->StopPageCleaner();
+  EXPECT_EQ(0, disk_manager->GetNumSyncs());
+  bpm->FlushAllPages();
+  EXPECT_EQ(1, disk_manager->GetNumSyncs());
+  delete bpm;
+
+  // Scenario: read-ahead reads a window of pages as one batch, and every page comes back intact.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  bpm->PrefetchPages({0, 1, 2, 3, 4, 5, 6, 7});
+  for (int i = 0; i < 1000 && bpm->GetStats().disk_reads_ < 8; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(8, bpm->GetStats().disk_reads_);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(8, bpm->GetStats().fetch_hits_);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DirectIOTest) {
+  const size_t buffer_pool_size = 600;
+  const size_t k = 2;
+  const int num_pages = 1000;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+
+  auto *disk_manager = new AsyncDiskManager("test.db", true, true);
+  buffer_pool_huge_pages = true;
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  buffer_pool_huge_pages = false;
+
+  // Scenario: every frame, including those added by a resize, is aligned for O_DIRECT.
+  auto aligned = [](Page *page) { return reinterpret_cast<uintptr_t>(page->GetData()) % BUSTUB_PAGE_SIZE == 0; };
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_TRUE(aligned(&bpm->GetPages()[i]));
+  }
+  ASSERT_TRUE(bpm->Resize(buffer_pool_size + BUFFER_POOL_CHUNK_SIZE));
+
+  // Scenario: pages written and read back with direct I/O survive eviction.
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(aligned(page));
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(aligned(page));
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, WriteBackErrorTest) {
+  const size_t buffer_pool_size = 3;
+  const size_t k = 2;
+
+  auto *disk_manager = new FailingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  // Page 0 is on disk only, pages {1, 2, 3} are dirty in the pool.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size + 1; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: a failed write-back of the victim fails the fetch or the new page, and the victim stays in the pool.
+  disk_manager->fail_ = true;
+  EXPECT_THROW(bpm->FetchPage(0), Exception);
+  EXPECT_THROW(bpm->NewPage(&page_id_temp), Exception);
+  const int num_writes = disk_manager->num_writes_;
+  bpm->PrefetchPages({0});
+  for (int i = 0; i < 1000 && disk_manager->num_writes_ == num_writes; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  for (page_id_t page_id = 1; page_id <= static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(true, page->IsDirty());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: once the disk works again, so does the pool, and the page id of the failed new page is reused.
+  disk_manager->fail_ = false;
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page 0", std::string(page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(buffer_pool_size + 1, static_cast<size_t>(page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  for (page_id_t page_id = 1; page_id <= static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
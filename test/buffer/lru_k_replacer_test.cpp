@@ -97,4 +97,42 @@ TEST(LRUKReplacerTest, SampleTest) {
   lru_replacer.Remove(1);
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, EvictableToggleTest) {
+  LRUKReplacer lru_replacer(8, 3);
+
+  // Scenario: frames 0..3 reach k accesses in order, frames 4..7 only get one access each.
+  for (int round = 0; round < 3; round++) {
+    for (int frame_id = 0; frame_id < 4; frame_id++) {
+      lru_replacer.RecordAccess(frame_id);
+    }
+  }
+  for (int frame_id = 4; frame_id < 8; frame_id++) {
+    lru_replacer.RecordAccess(frame_id);
+  }
+  for (int frame_id = 0; frame_id < 8; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(8, lru_replacer.Size());
+
+  // Scenario: pinning and unpinning a frame does not change its position in the eviction order, and setting the same
+  // evictable state twice is a no-op.
+  lru_replacer.SetEvictable(4, false);
+  lru_replacer.SetEvictable(4, false);
+  ASSERT_EQ(7, lru_replacer.Size());
+  lru_replacer.SetEvictable(4, true);
+  lru_replacer.SetEvictable(4, true);
+  ASSERT_EQ(8, lru_replacer.Size());
+
+  // Scenario: an access on an evictable frame moves it within the order. Frame 0 now has the most recent k-th access.
+  lru_replacer.RecordAccess(0);
+
+  int value;
+  for (int expected : {4, 5, 6, 7, 1, 2, 3, 0}) {
+    ASSERT_EQ(true, lru_replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_EQ(0, lru_replacer.Size());
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+}
 }  // namespace bustub
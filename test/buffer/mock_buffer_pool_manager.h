@@ -100,10 +100,11 @@ class MockBufferPoolManager : public BufferPoolManagerInstance {
   }
 
   /** Grading function. Do not modify/call! */
-  void FlushAllPages(bufferpool_callback_fn callback = &MockBufferPoolManager::counter_callback) {
+  auto FlushAllPages(bufferpool_callback_fn callback = &MockBufferPoolManager::counter_callback) -> FlushStats {
     GradingCallback(callback, CallbackType::BEFORE, FuncType::FlushAllPages, INVALID_PAGE_ID);
-    FlushAllPgsImp();
+    auto stats = FlushAllPgsImp();
     GradingCallback(callback, CallbackType::AFTER, FuncType::FlushAllPages, INVALID_PAGE_ID);
+    return stats;
   }
 
  private:
@@ -175,9 +176,9 @@ class MockBufferPoolManager : public BufferPoolManagerInstance {
   /**
    * Flushes all the pages in the buffer pool to disk.
    */
-  void FlushAllPgsImp() {
+  auto FlushAllPgsImp() -> FlushStats {
     counter.AddCount(FuncType::FlushAllPages);
-    BufferPoolManager::FlushAllPgsImp();
+    return BufferPoolManager::FlushAllPgsImp();
   }
 
   // For grading. Do not modify!
@@ -0,0 +1,370 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/extent_allocator.h"
+#include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
+#include "storage/disk/posix_disk_manager.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 5;
+  const size_t buffer_pool_size = 2;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, k);
+  ASSERT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until we fill up the buffer pool. Every page must be handed out by
+  // the instance that owns its id.
+  std::set<page_id_t> page_ids{page_id_temp};
+  for (size_t i = 1; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    page_ids.insert(page_id_temp);
+  }
+  EXPECT_EQ(num_instances * buffer_pool_size, page_ids.size());
+
+  // Scenario: Once the buffer pool is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: After unpinning every page, we should be able to create new pages again, and fetch page 0 back from disk
+  // with the data we wrote a while ago.
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Scenario: Pages are routed to the instance owning their id.
+  for (page_id_t page_id = 0; page_id < 20; page_id++) {
+    EXPECT_EQ(bpm->GetBufferPoolManager(page_id), bpm->GetBufferPoolManager(page_id + num_instances));
+    EXPECT_NE(bpm->GetBufferPoolManager(page_id), bpm->GetBufferPoolManager(page_id + 1));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, RoundRobinTest) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Scenario: Consecutive allocations start at consecutive instances, so the first few pages land on different
+  // instances instead of filling up instance 0 first.
+  std::set<page_id_t> residues;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_instances; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    residues.insert(page_id_temp % num_instances);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(num_instances, residues.size());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 8;
+  const size_t num_threads = 4;
+  const size_t num_pages_per_thread = 50;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  std::vector<std::thread> threads;
+  std::vector<std::vector<page_id_t>> allocated(num_threads);
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      for (size_t i = 0; i < num_pages_per_thread; i++) {
+        page_id_t page_id;
+        auto *page = bpm->NewPage(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+        allocated[tid].push_back(page_id);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: every page written by any thread can be read back, whether it is still cached or not.
+  std::set<page_id_t> seen;
+  for (const auto &page_ids : allocated) {
+    for (auto page_id : page_ids) {
+      EXPECT_TRUE(seen.insert(page_id).second);
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, TablespaceTest) {
+  const size_t num_instances = 3;
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 60;
+  remove("test.db");
+  remove("test.db.1");
+
+  auto *disk_manager = new AsyncDiskManager("test.db");
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  const tablespace_id_t tablespace_id = bpm->CreateTablespace();
+  ASSERT_NE(DEFAULT_TABLESPACE, tablespace_id);
+
+  // Scenario: pages of a tablespace are spread over all instances and survive eviction.
+  std::set<page_id_t> page_ids;
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPageInTablespace(&page_id, tablespace_id, nullptr);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(tablespace_id, TablespaceOf(page_id));
+    EXPECT_TRUE(page_ids.insert(page_id).second);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  page_id_t default_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&default_page_id));
+  EXPECT_EQ(DEFAULT_TABLESPACE, TablespaceOf(default_page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(default_page_id, false));
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Scenario: after a restart, allocation in the tablespace resumes past the end of its file.
+  bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  const page_id_t num_blocks = disk_manager->GetNumBlocks(tablespace_id);
+  EXPECT_GE(num_blocks, num_pages);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPageInTablespace(&page_id, tablespace_id, nullptr));
+  EXPECT_EQ(0, page_ids.count(page_id));
+  EXPECT_GE(BlockOf(page_id), num_blocks);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  delete bpm;
+
+  disk_manager->DropTablespace(tablespace_id);
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ExtentTest) {
+  const size_t num_instances = 3;
+  const size_t buffer_pool_size = 8;
+  const size_t extent_size = 16;
+  const int num_threads = 4;
+  const int pages_per_thread = 40;
+  remove("test.db");
+
+  auto *disk_manager = new AsyncDiskManager("test.db");
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  std::set<page_id_t> page_ids;
+  page_id_t page_id_temp;
+  for (int i = 0; i < 4; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(page_ids.insert(page_id_temp).second);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: a run of contiguous page ids spans all instances, and starts right after the pages handed out so far.
+  ExtentAllocator allocator(bpm, DEFAULT_TABLESPACE, extent_size);
+  for (size_t i = 0; i < 2 * extent_size; i++) {
+    auto *page = allocator.NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(static_cast<page_id_t>(4 + i), page_id_temp);
+    EXPECT_TRUE(page_ids.insert(page_id_temp).second);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_GE(disk_manager->GetNumBlocks(DEFAULT_TABLESPACE), static_cast<page_id_t>(4 + 2 * extent_size));
+
+  // Scenario: extents and single pages allocated concurrently never share a page id.
+  std::mutex latch;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      ExtentAllocator thread_allocator(bpm, DEFAULT_TABLESPACE, extent_size);
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        auto *page = tid % 2 == 0 ? thread_allocator.NewPage(&page_id) : bpm->NewPage(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+        std::scoped_lock lock(latch);
+        EXPECT_TRUE(page_ids.insert(page_id).second);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    if (page_id >= 4) {
+      EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+    }
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllTest) {
+  const size_t num_instances = 3;
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 20;
+  remove("test.db");
+
+  auto *disk_manager = new PosixDiskManager("test.db");
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: the pages of all instances are written together, as one run of adjacent page ids, with one sync.
+  const int num_writes = disk_manager->GetNumWrites();
+  const int num_syncs = disk_manager->GetNumSyncs();
+  auto stats = bpm->FlushAllPages();
+  EXPECT_EQ(num_pages, stats.pages_written_);
+  EXPECT_EQ(1, stats.runs_);
+  EXPECT_EQ(num_writes + num_pages, disk_manager->GetNumWrites());
+  EXPECT_EQ(num_syncs + 1, disk_manager->GetNumSyncs());
+
+  // Scenario: clean pages are skipped, and the dirty ones coalesce into runs.
+  for (page_id_t page_id : {11, 3, 10, 2, 4}) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "new %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  stats = bpm->FlushAllPages();
+  EXPECT_EQ(5, stats.pages_written_);
+  EXPECT_EQ(2, stats.runs_);
+  stats = bpm->FlushAllPages();
+  EXPECT_EQ(0, stats.pages_written_);
+  EXPECT_EQ(0, stats.runs_);
+
+  // Scenario: a page in the middle of a change under its write latch is written once the change is complete.
+  auto *page = bpm->FetchPage(5);
+  ASSERT_NE(nullptr, page);
+  page->WLatch();
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "half");
+  std::thread flusher([bpm] { bpm->FlushAllPages(); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "new 5");
+  page->WUnlatch();
+  flusher.join();
+  char data[BUSTUB_PAGE_SIZE];
+  disk_manager->ReadPage(5, data);
+  EXPECT_EQ("new 5", std::string(data));
+  EXPECT_EQ(true, bpm->UnpinPage(5, true));
+  delete bpm;
+
+  bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    const bool changed = (page_id >= 2 && page_id <= 5) || page_id == 10 || page_id == 11;
+    EXPECT_EQ((changed ? "new " : "") + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
+
+}  // namespace bustub
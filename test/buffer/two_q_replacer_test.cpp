@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer_test.cpp
+//
+// Identification: test/buffer/two_q_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <vector>
+
+#include "buffer/two_q_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQReplacerTest, SampleTest) {
+  // 8 frames: A1in keeps 2 frames, A1out remembers 4 pages.
+  TwoQReplacer two_q_replacer(8);
+
+  // Scenario: load pages 100 to 105 into frames 0 to 5. They all enter A1in.
+  for (frame_id_t frame_id = 0; frame_id < 6; frame_id++) {
+    two_q_replacer.RecordLoad(frame_id, 100 + frame_id);
+    two_q_replacer.SetEvictable(frame_id, true);
+  }
+  EXPECT_EQ(6, two_q_replacer.Size());
+
+  // Scenario: A1in is over its share, so it is drained in FIFO order. Accessing frame 1 again does not reorder it.
+  two_q_replacer.RecordAccess(1);
+  int value;
+  ASSERT_TRUE(two_q_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(two_q_replacer.Evict(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: page 100 comes back while it is remembered in A1out, so it is promoted to Am.
+  two_q_replacer.RecordLoad(0, 100);
+  two_q_replacer.SetEvictable(0, true);
+  EXPECT_EQ(5, two_q_replacer.Size());
+
+  // Scenario: A1in is drained down to its share before Am is touched.
+  ASSERT_TRUE(two_q_replacer.Evict(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(two_q_replacer.Evict(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(two_q_replacer.Evict(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: a pinned frame in A1in is skipped.
+  two_q_replacer.SetEvictable(4, false);
+  ASSERT_TRUE(two_q_replacer.Evict(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(two_q_replacer.Evict(&value));
+  two_q_replacer.SetEvictable(4, true);
+  two_q_replacer.Remove(4);
+  EXPECT_EQ(0, two_q_replacer.Size());
+}
+
+TEST(TwoQReplacerTest, ScanResistanceTest) {
+  const size_t num_frames = 16;
+  TwoQReplacer two_q_replacer(num_frames);
+
+  // Scenario: frames 0 to 3 hold hot pages that were loaded twice, so they live in Am.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    two_q_replacer.RecordLoad(frame_id, frame_id);
+    two_q_replacer.SetEvictable(frame_id, true);
+  }
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    int value;
+    ASSERT_TRUE(two_q_replacer.Evict(&value));
+    EXPECT_EQ(frame_id, value);
+  }
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    two_q_replacer.RecordLoad(frame_id, frame_id);
+    two_q_replacer.SetEvictable(frame_id, true);
+  }
+
+  // Scenario: a long scan streams through the remaining frames. It only ever evicts its own pages.
+  std::vector<frame_id_t> free_frames;
+  for (frame_id_t frame_id = 4; frame_id < static_cast<frame_id_t>(num_frames); frame_id++) {
+    free_frames.push_back(frame_id);
+  }
+  for (page_id_t page_id = 1000; page_id < 1200; page_id++) {
+    frame_id_t frame_id;
+    if (!free_frames.empty()) {
+      frame_id = free_frames.back();
+      free_frames.pop_back();
+    } else {
+      ASSERT_TRUE(two_q_replacer.Evict(&frame_id));
+      ASSERT_GE(frame_id, 4);
+    }
+    two_q_replacer.RecordLoad(frame_id, page_id);
+    two_q_replacer.SetEvictable(frame_id, true);
+  }
+}
+
+}  // namespace bustub
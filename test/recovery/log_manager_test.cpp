@@ -0,0 +1,295 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/latency_disk_manager.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, AppendAndFlushTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  Schema schema({Column("a", TypeId::INTEGER)});
+  Tuple tuple({ValueFactory::GetIntegerValue(15445)}, &schema);
+
+  log_manager.RunFlushThread();
+  EXPECT_TRUE(enable_logging);
+  LogRecord begin(7, INVALID_LSN, LogRecordType::BEGIN);
+  const lsn_t begin_lsn = log_manager.AppendLogRecord(&begin);
+  LogRecord insert(7, begin_lsn, LogRecordType::INSERT, RID(3, 4), tuple);
+  const lsn_t insert_lsn = log_manager.AppendLogRecord(&insert);
+  LogRecord commit(7, insert_lsn, LogRecordType::COMMIT);
+  const lsn_t commit_lsn = log_manager.AppendLogRecord(&commit);
+  EXPECT_EQ(0, begin_lsn);
+  EXPECT_EQ(2, commit_lsn);
+
+  log_manager.Flush(commit_lsn);
+  EXPECT_EQ(commit_lsn, log_manager.GetPersistentLSN());
+  EXPECT_EQ(1, disk_manager.GetNumFlushes());
+  log_manager.StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+
+  // Scenario: the records are in the log file in LSN order, in the format of log_record.h.
+  std::vector<char> log(begin.GetSize() + insert.GetSize() + commit.GetSize());
+  ASSERT_TRUE(disk_manager.ReadLog(log.data(), static_cast<int>(log.size()), 0));
+  int32_t header[5];
+  std::memcpy(header, log.data() + begin.GetSize(), sizeof(header));
+  EXPECT_EQ(insert.GetSize(), header[0]);
+  EXPECT_EQ(insert_lsn, header[1]);
+  EXPECT_EQ(7, header[2]);
+  EXPECT_EQ(begin_lsn, header[3]);
+  EXPECT_EQ(static_cast<int32_t>(LogRecordType::INSERT), header[4]);
+  RID rid;
+  std::memcpy(&rid, log.data() + begin.GetSize() + 20, sizeof(RID));
+  EXPECT_EQ(RID(3, 4), rid);
+  Tuple logged_tuple;
+  logged_tuple.DeserializeFrom(log.data() + begin.GetSize() + 20 + sizeof(RID));
+  EXPECT_EQ(15445, logged_tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  std::memcpy(header, log.data() + begin.GetSize() + insert.GetSize(), sizeof(header));
+  EXPECT_EQ(commit_lsn, header[1]);
+  EXPECT_EQ(static_cast<int32_t>(LogRecordType::COMMIT), header[4]);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, FullBufferTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+
+  // Scenario: without a flush thread, appenders write out the full buffer themselves.
+  size_t total_size = 0;
+  lsn_t lsn = INVALID_LSN;
+  while (total_size < 3 * log_manager.GetLogBufferSize()) {
+    LogRecord record(1, lsn, LogRecordType::NEWPAGE, 5, 6);
+    lsn = log_manager.AppendLogRecord(&record);
+    total_size += record.GetSize();
+  }
+  EXPECT_GE(disk_manager.GetNumFlushes(), 2);
+  EXPECT_LT(log_manager.GetPersistentLSN(), lsn);
+  log_manager.Flush(lsn);
+  EXPECT_EQ(lsn, log_manager.GetPersistentLSN());
+
+  std::vector<char> log(total_size);
+  ASSERT_TRUE(disk_manager.ReadLog(log.data(), static_cast<int>(log.size()), 0));
+  int32_t last_lsn;
+  std::memcpy(&last_lsn, log.data() + total_size - 28 + 4, sizeof(int32_t));
+  EXPECT_EQ(lsn, last_lsn);
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  DiskManagerMemory memory(16);
+  LatencyProfile profile;
+  profile.sync_ = {std::chrono::milliseconds(2), std::chrono::milliseconds(2)};
+  profile.queue_depth_ = 1;
+  LatencyDiskManager disk_manager(&memory, profile);
+  LogManager log_manager(&disk_manager);
+  log_manager.RunFlushThread();
+
+  // Scenario: committers that wait for a sync at the same time share it.
+  const int num_threads = 8;
+  const int commits_per_thread = 20;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&log_manager, t] {
+      lsn_t prev_lsn = INVALID_LSN;
+      for (int i = 0; i < commits_per_thread; i++) {
+        LogRecord commit(t, prev_lsn, LogRecordType::COMMIT);
+        prev_lsn = log_manager.AppendLogRecord(&commit);
+        log_manager.Flush(prev_lsn);
+        EXPECT_GE(log_manager.GetPersistentLSN(), prev_lsn);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(log_manager.GetNextLSN() - 1, log_manager.GetPersistentLSN());
+  EXPECT_LT(disk_manager.GetNumFlushes(), num_threads * commits_per_thread / 2);
+  log_manager.StopFlushThread();
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, ConcurrentAppendTest) {
+  DiskManager disk_manager("test.db");
+  LogManager log_manager(&disk_manager);
+  log_manager.RunFlushThread();
+
+  // Scenario: appenders that run in parallel get every LSN once, and the log holds the records in LSN order with no
+  // gaps, also where records wrap around the end of the ring.
+  const int num_threads = 8;
+  const int records_per_thread = 2000;
+  std::vector<std::vector<lsn_t>> lsns(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&log_manager, &lsns, t] {
+      for (int i = 0; i < records_per_thread; i++) {
+        LogRecord record(t, INVALID_LSN, LogRecordType::NEWPAGE, t, i);
+        lsns[t].push_back(log_manager.AppendLogRecord(&record));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  const lsn_t last_lsn = log_manager.GetNextLSN() - 1;
+  EXPECT_EQ(num_threads * records_per_thread - 1, last_lsn);
+  log_manager.Flush(last_lsn);
+  EXPECT_EQ(last_lsn, log_manager.GetPersistentLSN());
+  log_manager.StopFlushThread();
+
+  std::vector<int> owner(num_threads * records_per_thread, -1);
+  for (int t = 0; t < num_threads; t++) {
+    for (auto lsn : lsns[t]) {
+      ASSERT_EQ(-1, owner[lsn]);
+      owner[lsn] = t;
+    }
+  }
+  std::vector<char> log(owner.size() * 28);
+  ASSERT_TRUE(disk_manager.ReadLog(log.data(), static_cast<int>(log.size()), 0));
+  std::vector<int> next_page_id(num_threads, 0);
+  for (size_t lsn = 0; lsn < owner.size(); lsn++) {
+    int32_t record[7];
+    std::memcpy(record, log.data() + lsn * 28, sizeof(record));
+    ASSERT_EQ(28, record[0]);
+    ASSERT_EQ(static_cast<int32_t>(lsn), record[1]);
+    ASSERT_EQ(owner[lsn], record[2]);
+    ASSERT_EQ(static_cast<int32_t>(LogRecordType::NEWPAGE), record[4]);
+    // every thread's records are in the order it appended them
+    ASSERT_EQ(next_page_id[owner[lsn]]++, record[6]);
+  }
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, AsyncCommitTest) {
+  DiskManagerMemory memory(16);
+  LatencyProfile profile;
+  const auto sync_latency = std::chrono::milliseconds(5);
+  profile.sync_ = {sync_latency, sync_latency};
+  LatencyDiskManager disk_manager(&memory, profile);
+  LogManager log_manager(&disk_manager);
+  LockManager lock_manager;
+  TransactionManager txn_manager(&lock_manager, &log_manager);
+  log_manager.RunFlushThread();
+
+  // Scenario: asynchronous commits return without waiting for a sync each.
+  const int num_txns = 50;
+  auto start = std::chrono::steady_clock::now();
+  lsn_t commit_lsn = INVALID_LSN;
+  for (int i = 0; i < num_txns; i++) {
+    auto *txn = txn_manager.Begin();
+    txn->SetSynchronousCommit(false);
+    txn_manager.Commit(txn);
+    commit_lsn = txn->GetPrevLSN();
+    delete txn;
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, num_txns * sync_latency / 2);
+  EXPECT_LT(disk_manager.GetNumFlushes(), num_txns / 2);
+  txn_manager.WaitForLSN(commit_lsn);
+  EXPECT_GE(log_manager.GetPersistentLSN(), commit_lsn);
+
+  // Scenario: the flush thread makes an asynchronous commit durable within the lag, long before log_timeout.
+  auto *txn = txn_manager.Begin();
+  txn->SetSynchronousCommit(false);
+  txn_manager.Commit(txn);
+  commit_lsn = txn->GetPrevLSN();
+  delete txn;
+  EXPECT_LT(log_manager.GetPersistentLSN(), commit_lsn);
+  std::this_thread::sleep_for(async_commit_lag + 10 * sync_latency);
+  EXPECT_GE(log_manager.GetPersistentLSN(), commit_lsn);
+
+  // Scenario: a synchronous commit is durable when it returns.
+  txn = txn_manager.Begin();
+  txn_manager.Commit(txn);
+  EXPECT_EQ(txn->GetPrevLSN(), log_manager.GetPersistentLSN());
+  delete txn;
+  log_manager.StopFlushThread();
+  disk_manager.ShutDown();
+}
+
+/** A disk manager whose log writes fail while fail_ is set. */
+class FailingLogDiskManager : public DiskManagerMemory {
+ public:
+  FailingLogDiskManager() : DiskManagerMemory(16) {}
+  void WriteLog(char *log_data, int size) override {
+    if (fail_) {
+      throw Exception("I/O error while writing log");
+    }
+    DiskManagerMemory::WriteLog(log_data, size);
+  }
+  std::atomic<bool> fail_{false};
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, WriteErrorTest) {
+  for (const bool flush_thread : {false, true}) {
+    FailingLogDiskManager disk_manager;
+    LogManager log_manager(&disk_manager);
+    if (flush_thread) {
+      log_manager.RunFlushThread();
+    }
+    LogRecord begin(7, INVALID_LSN, LogRecordType::BEGIN);
+    const lsn_t begin_lsn = log_manager.AppendLogRecord(&begin);
+    log_manager.Flush(begin_lsn);
+    EXPECT_EQ(begin_lsn, log_manager.GetPersistentLSN());
+
+    // Scenario: a failed write leaves the persistent LSN alone, and so does every flush after it.
+    disk_manager.fail_ = true;
+    LogRecord commit(7, begin_lsn, LogRecordType::COMMIT);
+    const lsn_t commit_lsn = log_manager.AppendLogRecord(&commit);
+    EXPECT_THROW(log_manager.Flush(commit_lsn), Exception);
+    EXPECT_EQ(begin_lsn, log_manager.GetPersistentLSN());
+    disk_manager.fail_ = false;
+    EXPECT_THROW(log_manager.Flush(commit_lsn), Exception);
+    EXPECT_THROW(log_manager.WaitForLSN(commit_lsn), Exception);
+    EXPECT_EQ(begin_lsn, log_manager.GetPersistentLSN());
+    log_manager.StopFlushThread();
+  }
+}
+
+}  // namespace bustub
@@ -10,12 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "common/bustub_instance.h"
 #include "common/config.h"
+#include "common/exception.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction_manager.h"
 #include "execution/execution_engine.h"
@@ -26,9 +29,11 @@
 #include "recovery/log_manager.h"
 #include "recovery/log_recovery.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/page/header_page.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -38,6 +43,8 @@ class RecoveryTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.ckpt");
   }
 
   // This function is called after every test.
@@ -45,11 +52,13 @@ class RecoveryTest : public ::testing::Test {
     LOG_INFO("Tearing down the system..");
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.ckpt");
   };
 };
 
 // NOLINTNEXTLINE
-TEST_F(RecoveryTest, DISABLED_RedoTest) {
+TEST_F(RecoveryTest, RedoTest) {
   auto *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -107,7 +116,8 @@ TEST_F(RecoveryTest, DISABLED_RedoTest) {
   delete txn;
 
   LOG_INFO("Begin recovery");
-  auto *log_recovery = new LogRecovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  auto *log_recovery = new LogRecovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                                       bustub_instance->log_manager_);
 
   ASSERT_FALSE(enable_logging);
 
@@ -138,7 +148,7 @@ TEST_F(RecoveryTest, DISABLED_RedoTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(RecoveryTest, DISABLED_UndoTest) {
+TEST_F(RecoveryTest, UndoTest) {
   auto *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -191,7 +201,8 @@ TEST_F(RecoveryTest, DISABLED_UndoTest) {
   delete txn;
 
   LOG_INFO("Recovery started..");
-  auto *log_recovery = new LogRecovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_);
+  auto *log_recovery = new LogRecovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                                       bustub_instance->log_manager_);
 
   ASSERT_FALSE(enable_logging);
 
@@ -217,7 +228,419 @@ TEST_F(RecoveryTest, DISABLED_UndoTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
+TEST_F(RecoveryTest, ParallelRedoUndoTest) {
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  auto *txn_manager = bustub_instance->txn_manager_;
+
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}}};
+  auto make_tuple = [&](int a, int b) {
+    return Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(a), ValueFactory::GetIntegerValue(b)}, &schema};
+  };
+
+  // A committed transaction fills a table over many pages.
+  Transaction *txn = txn_manager->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  const int num_tuples = 3000;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(i, 0), &rids[i], txn));
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+
+  // A loser inserts and deletes; some of its changes reach the disk before the crash.
+  Transaction *loser = txn_manager->Begin();
+  std::vector<RID> loser_rids(200);
+  for (auto &rid : loser_rids) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(-1, -1), &rid, loser));
+  }
+  for (int i = 0; i < num_tuples; i += 10) {
+    ASSERT_TRUE(test_table->MarkDelete(rids[i], loser));
+  }
+  bustub_instance->buffer_pool_manager_->FlushAllPages();
+
+  // A winner updates tuples after that; its changes are only in the log.
+  txn = txn_manager->Begin();
+  for (int i = 1; i < num_tuples; i += 10) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(i, 1), rids[i], txn));
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+  delete loser;
+  delete test_table;
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                           bustub_instance->log_manager_, 4);
+  log_recovery.Redo();
+  EXPECT_EQ(1, log_recovery.GetActiveTransactions().size());
+  log_recovery.Undo();
+
+  // Scenario: the winners' changes are there, the loser's are not.
+  txn = bustub_instance->txn_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->GetTuple(rids[i], &tuple, txn)) << i;
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(i % 10 == 1 ? 1 : 0, tuple.GetValue(&schema, 1).GetAs<int32_t>());
+  }
+  size_t count = 0;
+  for (auto it = test_table->Begin(txn); it != test_table->End(); ++it) {
+    EXPECT_GE(it->GetValue(&schema, 0).GetAs<int32_t>(), 0);
+    count++;
+  }
+  EXPECT_EQ(num_tuples, count);
+  bustub_instance->txn_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, FuzzyCheckpointTest) {
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  auto *txn_manager = bustub_instance->txn_manager_;
+  auto *checkpoint_manager = bustub_instance->checkpoint_manager_;
+
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}}};
+  auto make_tuple = [&](int a, int b) {
+    return Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(a), ValueFactory::GetIntegerValue(b)}, &schema};
+  };
+
+  Transaction *txn = txn_manager->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  const int num_tuples = 2000;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(i, 0), &rids[i], txn));
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+
+  // A loser begins before the checkpoint and keeps writing while it runs.
+  Transaction *loser = txn_manager->Begin();
+  std::vector<RID> loser_rids(100);
+  for (int i = 0; i < 50; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(-1, -1), &loser_rids[i], loser));
+  }
+
+  // Scenario: transactions begin, write and commit between the start and the end of the checkpoint.
+  checkpoint_manager->BeginCheckpoint();
+  const lsn_t checkpoint_lsn = checkpoint_manager->GetCheckpointLSN();
+  txn = txn_manager->Begin();
+  for (int i = 0; i < num_tuples; i += 10) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(i, 1), rids[i], txn));
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+  for (int i = 50; i < 100; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(-1, -1), &loser_rids[i], loser));
+  }
+  checkpoint_manager->EndCheckpoint();
+  EXPECT_EQ(checkpoint_lsn, bustub_instance->disk_manager_->ReadMasterRecord().checkpoint_lsn_);
+
+  // A winner after the checkpoint; its changes are only in the log.
+  txn = txn_manager->Begin();
+  for (int i = 1; i < num_tuples; i += 10) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(i, 2), rids[i], txn));
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+  const lsn_t num_records = bustub_instance->log_manager_->GetNextLSN();
+  delete loser;
+  delete test_table;
+  delete bustub_instance;
+
+  // Scenario: recovery starts at the checkpoint, except for the records of the loser that began before it.
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                           bustub_instance->log_manager_, 4);
+  log_recovery.Redo();
+  EXPECT_EQ(checkpoint_lsn, log_recovery.GetRedoLSN());
+  EXPECT_LT(log_recovery.GetNumRecords(), static_cast<size_t>(num_records - num_tuples));
+  EXPECT_EQ(num_records, log_recovery.GetNextLSN());
+  ASSERT_EQ(1, log_recovery.GetActiveTransactions().size());
+  log_recovery.Undo();
+
+  txn = bustub_instance->txn_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->GetTuple(rids[i], &tuple, txn)) << i;
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(i % 10 == 0 ? 1 : i % 10 == 1 ? 2 : 0, tuple.GetValue(&schema, 1).GetAs<int32_t>()) << i;
+  }
+  size_t count = 0;
+  for (auto it = test_table->Begin(txn); it != test_table->End(); ++it) {
+    EXPECT_GE(it->GetValue(&schema, 0).GetAs<int32_t>(), 0);
+    count++;
+  }
+  EXPECT_EQ(num_tuples, count);
+  bustub_instance->txn_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, RepeatedCrashTest) {
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}}};
+  auto make_tuple = [&](int a, int b) {
+    return Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(a), ValueFactory::GetIntegerValue(b)}, &schema};
+  };
+
+  Transaction *txn = bustub_instance->txn_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  const int num_tuples = 500;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(i, 0), &rids[i], txn));
+  }
+  bustub_instance->txn_manager_->Commit(txn);
+  delete txn;
+  const lsn_t num_records = bustub_instance->log_manager_->GetNextLSN();
+  delete test_table;
+  delete bustub_instance;
+
+  // Scenario: after the first crash, recovery writes the pages back with their page LSNs, and the log goes on.
+  bustub_instance = new BustubInstance("test.db");
+  {
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    log_recovery.Undo();
+  }
+  EXPECT_EQ(num_records, bustub_instance->log_manager_->GetNextLSN());
+  bustub_instance->buffer_pool_manager_->FlushAllPages();
+  bustub_instance->log_manager_->RunFlushThread();
+  txn = bustub_instance->txn_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  for (int i = 0; i < num_tuples; i += 2) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(i, 1), rids[i], txn));
+  }
+  bustub_instance->txn_manager_->Commit(txn);
+  delete txn;
+  EXPECT_LT(num_records, bustub_instance->log_manager_->GetNextLSN());
+  delete test_table;
+  delete bustub_instance;
+
+  // Scenario: the second recovery redoes the updates, which are newer than the page LSNs of the first run.
+  bustub_instance = new BustubInstance("test.db");
+  {
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    log_recovery.Undo();
+  }
+  txn = bustub_instance->txn_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->GetTuple(rids[i], &tuple, txn)) << i;
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(i % 2 == 0 ? 1 : 0, tuple.GetValue(&schema, 1).GetAs<int32_t>()) << i;
+  }
+  bustub_instance->txn_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, CompensationTest) {
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  auto *txn_manager = bustub_instance->txn_manager_;
+
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}}};
+  auto make_tuple = [&](int a, int b) {
+    return Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(a), ValueFactory::GetIntegerValue(b)}, &schema};
+  };
+
+  Transaction *txn = txn_manager->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  const int num_tuples = 600;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(i, 0), &rids[i], txn));
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+
+  // A loser updates tuples, applies deletes of others, then inserts into the slots the deletes freed.
+  Transaction *loser = txn_manager->Begin();
+  for (int i = 0; i < num_tuples; i += 3) {
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(i, 1), rids[i], loser));
+  }
+  for (int i = 1; i < num_tuples; i += 3) {
+    ASSERT_TRUE(test_table->MarkDelete(rids[i], loser));
+    test_table->ApplyDelete(rids[i], loser);
+  }
+  for (int i = 0; i < 50; i++) {
+    RID rid;
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(-1, -1), &rid, loser));
+  }
+  bustub_instance->buffer_pool_manager_->FlushAllPages();
+  delete loser;
+  delete test_table;
+  delete bustub_instance;
+
+  auto check_table = [&](BustubInstance *instance) {
+    Transaction *txn = instance->txn_manager_->Begin();
+    TableHeap table(instance->buffer_pool_manager_, instance->lock_manager_, instance->log_manager_, first_page_id);
+    Tuple tuple;
+    for (int i = 0; i < num_tuples; i++) {
+      ASSERT_TRUE(table.GetTuple(rids[i], &tuple, txn)) << i;
+      EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      EXPECT_EQ(0, tuple.GetValue(&schema, 1).GetAs<int32_t>()) << i;
+    }
+    size_t count = 0;
+    for (auto it = table.Begin(txn); it != table.End(); ++it) {
+      count++;
+    }
+    EXPECT_EQ(num_tuples, count);
+    instance->txn_manager_->Commit(txn);
+    delete txn;
+  };
+
+  // Scenario: undo puts the deleted tuples back into their slots, and logs every undo.
+  bustub_instance = new BustubInstance("test.db");
+  lsn_t next_lsn;
+  {
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    ASSERT_EQ(1, log_recovery.GetActiveTransactions().size());
+    next_lsn = log_recovery.GetNextLSN();
+    log_recovery.Undo();
+  }
+  const lsn_t num_undone = num_tuples / 3 + 2 * num_tuples / 3 + 50;
+  EXPECT_EQ(next_lsn + num_undone + 1, bustub_instance->log_manager_->GetNextLSN());
+  EXPECT_EQ(bustub_instance->log_manager_->GetNextLSN() - 1, bustub_instance->log_manager_->GetPersistentLSN());
+  check_table(bustub_instance);
+  // crash before the pages of the undo are written
+  delete bustub_instance;
+
+  // Scenario: the next recovery redoes the CLRs and finds no loser left.
+  bustub_instance = new BustubInstance("test.db");
+  {
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    EXPECT_TRUE(log_recovery.GetActiveTransactions().empty());
+    log_recovery.Undo();
+  }
+  check_table(bustub_instance);
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, UndoMovedTupleTest) {
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  auto *txn_manager = bustub_instance->txn_manager_;
+
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  auto make_tuple = [&](int a) { return Tuple{std::vector<Value>{ValueFactory::GetIntegerValue(a)}, &schema}; };
+
+  Transaction *txn = txn_manager->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  const int num_tuples = 10;
+  std::vector<RID> rids(num_tuples);
+  for (int i = 0; i < num_tuples; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(i), &rids[i], txn));
+  }
+  txn_manager->Commit(txn);
+  delete txn;
+
+  // A loser rolls back an insert of its own and applies a delete; a winner takes both slots.
+  Transaction *loser = txn_manager->Begin();
+  RID inserted_rid;
+  ASSERT_TRUE(test_table->InsertTuple(make_tuple(100), &inserted_rid, loser));
+  test_table->ApplyDelete(inserted_rid, loser);
+  ASSERT_TRUE(test_table->MarkDelete(rids[3], loser));
+  test_table->ApplyDelete(rids[3], loser);
+  Transaction *winner = txn_manager->Begin();
+  std::vector<RID> winner_rids(2);
+  ASSERT_TRUE(test_table->InsertTuple(make_tuple(200), &winner_rids[0], winner));
+  ASSERT_TRUE(test_table->InsertTuple(make_tuple(201), &winner_rids[1], winner));
+  ASSERT_EQ(rids[3], winner_rids[0]);
+  ASSERT_EQ(inserted_rid, winner_rids[1]);
+  txn_manager->Commit(winner);
+  bustub_instance->buffer_pool_manager_->FlushAllPages();
+  delete winner;
+  delete loser;
+  delete test_table;
+  delete bustub_instance;
+
+  auto check_table = [&](BustubInstance *instance) {
+    Transaction *txn = instance->txn_manager_->Begin();
+    TableHeap table(instance->buffer_pool_manager_, instance->lock_manager_, instance->log_manager_, first_page_id);
+    Tuple tuple;
+    ASSERT_TRUE(table.GetTuple(winner_rids[0], &tuple, txn));
+    EXPECT_EQ(200, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    ASSERT_TRUE(table.GetTuple(winner_rids[1], &tuple, txn));
+    EXPECT_EQ(201, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    std::vector<int32_t> values;
+    for (auto it = table.Begin(txn); it != table.End(); ++it) {
+      values.push_back(it->GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    std::sort(values.begin(), values.end());
+    std::vector<int32_t> expected{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 200, 201};
+    EXPECT_EQ(expected, values);
+    instance->txn_manager_->Commit(txn);
+    delete txn;
+  };
+
+  // Scenario: undo puts the deleted tuple into another slot, and removes the rolled back insert from there as well.
+  bustub_instance = new BustubInstance("test.db");
+  {
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    ASSERT_EQ(1, log_recovery.GetActiveTransactions().size());
+    log_recovery.Undo();
+  }
+  check_table(bustub_instance);
+  // crash before the pages of the undo are written
+  delete bustub_instance;
+
+  // Scenario: the redo of the CLRs puts the tuple into the same slot again.
+  bustub_instance = new BustubInstance("test.db");
+  {
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    EXPECT_TRUE(log_recovery.GetActiveTransactions().empty());
+    log_recovery.Undo();
+  }
+  check_table(bustub_instance);
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, CheckpointTest) {
   auto *bustub_instance = new BustubInstance("test.db");
 
   EXPECT_FALSE(enable_logging);
@@ -320,4 +743,88 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
   LOG_INFO("Shutdown System");
   delete bustub_instance;
 }
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, OldHeaderPageTest) {
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->buffer_pool_manager_->FlushAllPages();
+  delete bustub_instance;
+
+  // Scenario: page 0 as older versions wrote it, the record count first and no page size, is not taken for a header
+  // page.
+  std::vector<char> page(BUSTUB_PAGE_SIZE, 0);
+  const int32_t record_count = 1;
+  std::memcpy(page.data(), &record_count, sizeof(record_count));
+  std::strncpy(page.data() + sizeof(record_count), "foo_pk", 32);
+  {
+    DiskManager disk_manager("test.db");
+    disk_manager.WritePage(HEADER_PAGE_ID, page.data());
+    disk_manager.ShutDown();
+  }
+  EXPECT_THROW(BustubInstance("test.db"), Exception);
+
+  // Scenario: a header page that did not reach the disk is formatted again.
+  std::fill(page.begin(), page.end(), 0);
+  {
+    DiskManager disk_manager("test.db");
+    disk_manager.WritePage(HEADER_PAGE_ID, page.data());
+    disk_manager.ShutDown();
+  }
+  bustub_instance = new BustubInstance("test.db");
+  auto *header_page = bustub_instance->buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
+  EXPECT_EQ(BUSTUB_PAGE_SIZE, HeaderPage::ReadPageSize(header_page->GetData()));
+  bustub_instance->buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, MissingFreeSpaceMapTest) {
+  // Scenario: a database of an older version, written without a free space map, is rejected and left as it is.
+  std::vector<char> page(BUSTUB_PAGE_SIZE, 0);
+  const int32_t record_count = 1;
+  std::memcpy(page.data(), &record_count, sizeof(record_count));
+  {
+    DiskManager disk_manager("test.db");
+    disk_manager.WritePage(HEADER_PAGE_ID, page.data());
+    disk_manager.WritePage(1, page.data());
+    disk_manager.ShutDown();
+  }
+  remove("test.fsm");
+  EXPECT_THROW(BustubInstance("test.db"), Exception);
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  {
+    DiskManager disk_manager("test.db");
+    disk_manager.ReadPage(HEADER_PAGE_ID, data.data());
+    disk_manager.ShutDown();
+  }
+  EXPECT_EQ(page, data);
+
+  // Scenario: a database that lost its free space map keeps its header page, and no page id in the file is handed out
+  // again.
+  remove("test.db");
+  remove("test.fsm");
+  auto *bustub_instance = new BustubInstance("test.db");
+  auto *bpm = bustub_instance->buffer_pool_manager_;
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  std::strncpy(bpm->FetchPage(page_id)->GetData(), "data", BUSTUB_PAGE_SIZE);
+  bpm->UnpinPage(page_id, true);
+  bpm->UnpinPage(page_id, true);
+  bpm->FlushAllPages();
+  delete bustub_instance;
+  remove("test.fsm");
+
+  bustub_instance = new BustubInstance("test.db");
+  bpm = bustub_instance->buffer_pool_manager_;
+  auto *header_page = bpm->FetchPage(HEADER_PAGE_ID);
+  EXPECT_EQ(BUSTUB_PAGE_SIZE, HeaderPage::ReadPageSize(header_page->GetData()));
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  page_id_t new_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&new_page_id));
+  EXPECT_GT(new_page_id, page_id);
+  bpm->UnpinPage(new_page_id, false);
+  EXPECT_EQ("data", std::string(bpm->FetchPage(page_id)->GetData()));
+  bpm->UnpinPage(page_id, false);
+  delete bustub_instance;
+}
 }  // namespace bustub
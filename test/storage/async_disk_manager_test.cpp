@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager_test.cpp
+//
+// Identification: test/storage/async_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstring>
+#include <future>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
+
+namespace bustub {
+
+/** Runs every test once with io_uring, where the kernel offers it, and once with the thread pool. */
+class AsyncDiskManagerTest : public ::testing::TestWithParam<bool> {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, ReadWritePageAsyncTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  AsyncDiskManager dm("test.db", GetParam());
+  if (!GetParam()) {
+    EXPECT_FALSE(dm.UsesIoUring());
+  }
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  std::memset(buf, 1, sizeof(buf));
+  EXPECT_TRUE(dm.ReadPageAsync(3, buf).get());  // reading past the end of the file returns zeros
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[BUSTUB_PAGE_SIZE - 1]);
+
+  EXPECT_TRUE(dm.WritePageAsync(3, data).get());
+  EXPECT_TRUE(dm.ReadPageAsync(3, buf).get());
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // Scenario: synchronous reads see asynchronous writes and the other way round.
+  std::memset(buf, 0, sizeof(buf));
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  dm.WritePage(4, data);
+  std::memset(buf, 0, sizeof(buf));
+  EXPECT_TRUE(dm.ReadPageAsync(4, buf).get());
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(2, dm.GetNumWrites());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(AsyncDiskManagerTest, BatchTest) {
+  AsyncDiskManager dm("test.db", GetParam());
+  // More pages than the queue holds, so that the batch has to wait for free slots.
+  const int num_pages = ASYNC_IO_QUEUE_DEPTH * 3 + 5;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+
+  std::atomic<int> completed{0};
+  std::vector<AsyncDiskManager::Request> requests;
+  for (int i = 0; i < num_pages; i++) {
+    std::memset(pages[i].data(), i % 128, BUSTUB_PAGE_SIZE);
+    requests.push_back({true, i, pages[i].data(), [&completed](bool success) {
+                          EXPECT_TRUE(success);
+                          completed++;
+                        }});
+  }
+  dm.SubmitBatch(std::move(requests));
+
+  // WritePages()/ReadPages() return only once the whole batch is done.
+  std::vector<std::vector<char>> buffers(num_pages, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::pair<page_id_t, char *>> reads;
+  for (int i = num_pages - 1; i >= 0; i--) {
+    reads.emplace_back(i, buffers[i].data());
+  }
+  while (completed < num_pages) {
+    std::this_thread::yield();
+  }
+  dm.ReadPages(reads);
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_EQ(i % 128, buffers[i][0]);
+    EXPECT_EQ(i % 128, buffers[i][BUSTUB_PAGE_SIZE - 1]);
+  }
+
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  for (int i = 0; i < num_pages; i++) {
+    std::memset(pages[i].data(), (i + 1) % 128, BUSTUB_PAGE_SIZE);
+    writes.emplace_back(i, pages[i].data());
+  }
+  dm.WritePages(writes);
+  dm.ReadPages(reads);
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_EQ((i + 1) % 128, buffers[i][0]);
+  }
+  EXPECT_EQ(num_pages * 2, dm.GetNumWrites());
+
+  dm.ShutDown();
+}
+
+INSTANTIATE_TEST_SUITE_P(AsyncDiskManagerTest, AsyncDiskManagerTest, ::testing::Bool());
+
+}  // namespace bustub
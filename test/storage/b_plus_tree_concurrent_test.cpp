@@ -173,8 +173,8 @@ void InsertTest1Call() {
 
     bpm->UnpinPage(HEADER_PAGE_ID, true);
 
-    delete disk_manager;
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -228,8 +228,8 @@ void InsertTest2Call() {
 
     bpm->UnpinPage(HEADER_PAGE_ID, true);
 
-    delete disk_manager;
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -272,8 +272,8 @@ void DeleteTest1Call() {
 
     bpm->UnpinPage(HEADER_PAGE_ID, true);
 
-    delete disk_manager;
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -317,8 +317,8 @@ void DeleteTest2Call() {
 
     bpm->UnpinPage(HEADER_PAGE_ID, true);
 
-    delete disk_manager;
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -379,8 +379,8 @@ void MixTest1Call() {
 
     bpm->UnpinPage(HEADER_PAGE_ID, true);
 
-    delete disk_manager;
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -449,8 +449,8 @@ void MixTest2Call() {
 
     bpm->UnpinPage(HEADER_PAGE_ID, true);
 
-    delete disk_manager;
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -511,8 +511,8 @@ void MixTest3Call() {
 
     bpm->UnpinPage(HEADER_PAGE_ID, true);
 
-    delete disk_manager;
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -581,8 +581,8 @@ void MixTest4Call() {
 
     bpm->UnpinPage(HEADER_PAGE_ID, true);
 
-    delete disk_manager;
     delete bpm;
+    delete disk_manager;
     remove("test.db");
     remove("test.log");
   }
@@ -68,8 +68,8 @@ bool BPlusTreeLockBenchmarkCall(size_t num_threads, int leaf_node_size, bool wit
   }
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
 
   return success;
 }
@@ -16,6 +16,7 @@
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/page/header_page.h"
 #include "test_util.h"  // NOLINT
 
 namespace bustub {
@@ -58,8 +59,8 @@ TEST(BPlusTreeTests, InsertTest1) {
   bpm->UnpinPage(root_page_id, false);
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -121,8 +122,8 @@ TEST(BPlusTreeTests, InsertTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -190,9 +191,78 @@ TEST(BPlusTreeTests, InsertTest3) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, LargePageInsertTest) {
+  using LeafMapping = std::pair<GenericKey<8>, RID>;
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  const size_t page_size = 32768;
+  const int leaf_max_size = (page_size - LEAF_PAGE_HEADER_SIZE) / sizeof(LeafMapping);
+  const int internal_max_size = (page_size - INTERNAL_PAGE_HEADER_SIZE) / sizeof(LeafMapping);
+
+  auto *disk_manager = new DiskManager("test.db", page_size);
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  EXPECT_EQ(page_size, bpm->GetPageSize());
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                           internal_max_size);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  ASSERT_EQ(page_id, HEADER_PAGE_ID);
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+
+  // Scenario: 10000 keys fill a handful of 32 KB leaves under a single root.
+  const int64_t num_keys = 10000;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    rid.Set(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key & 0xFFFFFFFF));
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, &rids);
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  const page_id_t root_page_id = tree.GetRootPageId();
+  auto *root_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id)->GetData());
+  EXPECT_FALSE(root_page->IsLeafPage());
+  EXPECT_LE(root_page->GetSize(), 10);
+  bpm->UnpinPage(root_page_id, false);
+  bpm->FlushAllPages();
   delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: reopened without a page size, the database still has 32 KB pages and its header page.
+  disk_manager = new DiskManager("test.db");
+  EXPECT_EQ(page_size, disk_manager->GetPageSize());
+  bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto *header_page = reinterpret_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  EXPECT_EQ(page_size, HeaderPage::ReadPageSize(header_page->GetData()));
+  page_id_t stored_root_page_id;
+  EXPECT_TRUE(header_page->GetRootId("foo_pk", &stored_root_page_id));
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  root_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id)->GetData());
+  EXPECT_FALSE(root_page->IsLeafPage());
+  bpm->UnpinPage(root_page_id, false);
+
+  delete transaction;
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
+  remove("test.fsm");
 }
 }  // namespace bustub
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstring>
+#include <fstream>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -24,12 +25,14 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   };
 };
 
@@ -55,6 +58,34 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SyncTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: writes are only buffered, but reads see them before any sync.
+  dm.WritePage(3, data);
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(4, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, dm.GetNumSyncs());
+
+  // Scenario: each barrier is counted, and after Sync() the page is in the file.
+  dm.Sync();
+  EXPECT_EQ(1, dm.GetNumSyncs());
+  EXPECT_EQ(4 * BUSTUB_PAGE_SIZE, std::ifstream(db_file, std::ios::binary | std::ios::ate).tellg());
+  dm.SyncRange(3, 1);
+  EXPECT_EQ(2, dm.GetNumSyncs());
+  EXPECT_EQ(1, dm.GetNumWrites());
+
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,6 +103,65 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LargeLogOffsetTest) {
+  char buf[16] = {0};
+  char data[16] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+  // a sparse log past 4 GB
+  const int64_t log_size = (int64_t{5} << 30) + 7;
+  {
+    std::ofstream log("test.log", std::ios::binary | std::ios::out);
+    log.seekp(log_size - 1);
+    log.put('\0');
+  }
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  EXPECT_EQ(log_size, dm.GetLogSize());
+
+  dm.WriteLog(data, sizeof(data));
+  EXPECT_EQ(log_size + static_cast<int64_t>(sizeof(data)), dm.GetLogSize());
+  ASSERT_TRUE(dm.ReadLog(buf, sizeof(buf), log_size));
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_FALSE(dm.ReadLog(buf, sizeof(buf), log_size + static_cast<int64_t>(sizeof(data))));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadWriteFreeSpaceMapTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  std::strncpy(data, "A test string.", sizeof(data));
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_FALSE(dm.ReadFreeSpaceMapPage(0, buf));
+    dm.WriteFreeSpaceMapPage(2, data);
+    EXPECT_TRUE(dm.ReadFreeSpaceMapPage(2, buf));
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    dm.ShutDown();
+  }
+
+  // The free space map survives a reopen of the database file.
+  {
+    auto dm = DiskManager(db_file);
+    std::memset(buf, 0, sizeof(buf));
+    EXPECT_TRUE(dm.ReadFreeSpaceMapPage(2, buf));
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    EXPECT_FALSE(dm.ReadFreeSpaceMapPage(3, buf));
+    dm.ShutDown();
+  }
+
+  // A new database file starts with an empty free space map.
+  remove("test.db");
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_FALSE(dm.ReadFreeSpaceMapPage(2, buf));
+    dm.ShutDown();
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
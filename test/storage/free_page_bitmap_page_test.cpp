@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_bitmap_page_test.cpp
+//
+// Identification: test/storage/free_page_bitmap_page_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "storage/page/free_page_bitmap_page.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FreePageBitmapPageTest, BasicTest) {
+  FreePageBitmapPage page{};
+  page.Init();
+  EXPECT_EQ(0, page.GetHighWaterMark());
+  EXPECT_EQ(0, page.GetNumFree());
+  EXPECT_EQ(FreePageBitmapPage::SLOTS_PER_PAGE, page.FindFirstFree());
+
+  // The lowest free slot is found first, wherever it is in the page.
+  const uint32_t last_slot = FreePageBitmapPage::SLOTS_PER_PAGE - 1;
+  EXPECT_TRUE(page.SetFree(last_slot, true));
+  EXPECT_EQ(last_slot, page.FindFirstFree());
+  EXPECT_TRUE(page.SetFree(70, true));
+  EXPECT_TRUE(page.SetFree(3, true));
+  EXPECT_FALSE(page.SetFree(3, true));
+  EXPECT_EQ(3, page.GetNumFree());
+  EXPECT_EQ(3, page.FindFirstFree());
+
+  EXPECT_TRUE(page.SetFree(3, false));
+  EXPECT_FALSE(page.IsFree(3));
+  EXPECT_EQ(70, page.FindFirstFree());
+  EXPECT_TRUE(page.SetFree(70, false));
+  EXPECT_EQ(last_slot, page.FindFirstFree());
+  EXPECT_EQ(1, page.GetNumFree());
+
+  // An all-zero page is an empty bitmap.
+  FreePageBitmapPage zero_page{};
+  memset(reinterpret_cast<char *>(&zero_page), 0, sizeof(zero_page));
+  EXPECT_EQ(0, zero_page.GetHighWaterMark());
+  EXPECT_EQ(FreePageBitmapPage::SLOTS_PER_PAGE, zero_page.FindFirstFree());
+}
+
+}  // namespace bustub
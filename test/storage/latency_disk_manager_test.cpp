@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_disk_manager_test.cpp
+//
+// Identification: test/storage/latency_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/latency_disk_manager.h"
+
+namespace bustub {
+
+/** A profile where every I/O takes exactly the given time. */
+static auto FixedProfile(std::chrono::microseconds latency, size_t queue_depth) -> LatencyProfile {
+  LatencyProfile profile;
+  profile.read_ = {latency, latency};
+  profile.write_ = {latency, latency};
+  profile.sequential_ = {latency, latency};
+  profile.sync_ = {latency, latency};
+  profile.queue_depth_ = queue_depth;
+  return profile;
+}
+
+// NOLINTNEXTLINE
+TEST(LatencyDiskManagerTest, ForwardAndCountTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  DiskManagerMemory memory(16);
+  LatencyDiskManager dm(&memory, LatencyProfile::None());
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  dm.WritePage(3, data);
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  dm.ReadPage(3, buf);
+  dm.ReadPage(5, buf);
+
+  // Scenario: batches are counted page by page.
+  std::vector<char> buffers(2 * BUSTUB_PAGE_SIZE);
+  dm.WritePages({{4, data}, {5, data}});
+  dm.ReadPages({{4, buffers.data()}, {5, buffers.data() + BUSTUB_PAGE_SIZE}});
+  EXPECT_EQ(std::memcmp(buffers.data() + BUSTUB_PAGE_SIZE, data, sizeof(data)), 0);
+
+  EXPECT_EQ(2, dm.GetPageIoCounts(3).reads_);
+  EXPECT_EQ(1, dm.GetPageIoCounts(3).writes_);
+  EXPECT_EQ(2, dm.GetPageIoCounts(5).reads_);
+  EXPECT_EQ(0, dm.GetPageIoCounts(7).reads_);
+  EXPECT_EQ(3, dm.GetAllPageIoCounts().size());
+  EXPECT_EQ(5, dm.GetNumReads());
+  EXPECT_EQ(3, dm.GetNumWrites());
+  EXPECT_EQ(3, memory.GetNumWrites());
+
+  dm.Sync();
+  EXPECT_EQ(1, dm.GetNumSyncs());
+  dm.ResetPageIoCounts();
+  EXPECT_EQ(0, dm.GetPageIoCounts(3).reads_);
+  EXPECT_TRUE(dm.GetAllPageIoCounts().empty());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(LatencyDiskManagerTest, LatencyTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  DiskManagerMemory memory(64);
+  const auto latency = std::chrono::milliseconds(2);
+  LatencyDiskManager dm(&memory, FixedProfile(latency, 4));
+
+  auto start = std::chrono::steady_clock::now();
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    dm.ReadPage(page_id * 2, buf);
+  }
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 4 * latency);
+
+  // Scenario: a batch goes out queue-depth pages at a time, so 8 pages take two rounds.
+  std::vector<std::vector<char>> buffers(8, std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<std::pair<page_id_t, char *>> pages;
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    pages.emplace_back(page_id, buffers[page_id].data());
+  }
+  start = std::chrono::steady_clock::now();
+  dm.ReadPages(pages);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 2 * latency);
+  EXPECT_EQ(4, dm.GetMaxInFlight());
+  EXPECT_GE(dm.GetTotalDelay(), 6 * latency);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(LatencyDiskManagerTest, QueueDepthTest) {
+  DiskManagerMemory memory(64);
+  const auto latency = std::chrono::milliseconds(2);
+  LatencyDiskManager dm(&memory, FixedProfile(latency, 2));
+  const int num_threads = 8;
+
+  // Scenario: with two slots, eight concurrent readers take at least four rounds.
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&dm, t] {
+      char buf[BUSTUB_PAGE_SIZE];
+      dm.ReadPage(t * 4, buf);
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 4 * latency);
+  EXPECT_LE(dm.GetMaxInFlight(), 2);
+  EXPECT_EQ(num_threads, dm.GetNumReads());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(LatencyDiskManagerTest, ProfileTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  DiskManagerMemory memory(64);
+  LatencyProfile profile = LatencyProfile::Hdd();
+  profile.read_ = {std::chrono::milliseconds(20), std::chrono::milliseconds(40)};
+  profile.sequential_ = {};
+  LatencyDiskManager dm(&memory, profile);
+
+  // Scenario: on a disk, reading the following pages costs no seek, jumping around does.
+  dm.ReadPage(10, buf);
+  auto start = std::chrono::steady_clock::now();
+  for (page_id_t page_id = 11; page_id < 20; page_id++) {
+    dm.ReadPage(page_id, buf);
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+  start = std::chrono::steady_clock::now();
+  dm.ReadPage(40, buf);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1));
+
+  // Scenario: an SSD delays every read, but by far less than a seek.
+  DiskManagerMemory memory2(64);
+  LatencyDiskManager ssd(&memory2, LatencyProfile::Ssd());
+  start = std::chrono::steady_clock::now();
+  for (page_id_t page_id = 0; page_id < 20; page_id += 2) {
+    ssd.ReadPage(page_id, buf);
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+  EXPECT_GT(ssd.GetTotalDelay(), std::chrono::microseconds(0));
+  EXPECT_EQ(32, LatencyProfile::Ssd().queue_depth_);
+  ssd.ShutDown();
+  dm.ShutDown();
+}
+
+}  // namespace bustub
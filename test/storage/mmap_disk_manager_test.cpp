@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_disk_manager_test.cpp
+//
+// Identification: test/storage/mmap_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/mmap_disk_manager.h"
+
+namespace bustub {
+
+class MmapDiskManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(MmapDiskManagerTest, ReadWritePageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  MmapDiskManager dm("test.db");
+  std::strncpy(data, "A test string.", sizeof(data));
+  EXPECT_EQ(0, dm.GetNumMappedPages());
+
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(0, buf);  // reading past the end of the file returns zeros
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[BUSTUB_PAGE_SIZE - 1]);
+
+  // Scenario: a write past the mapping grows the file, and the next read maps it.
+  dm.WritePage(5, data);
+  EXPECT_EQ(0, dm.GetNumMappedPages());
+  dm.ReadPage(5, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(6, dm.GetNumMappedPages());
+  dm.ReadPage(2, buf);
+  EXPECT_EQ(0, buf[0]);
+
+  // Scenario: writes inside the mapping go into it.
+  std::strncpy(data, "Another test string.", sizeof(data));
+  dm.WritePage(2, data);
+  dm.ReadPage(2, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(2, dm.GetNumWrites());
+
+  dm.SyncRange(2, 1);
+  dm.Sync();
+  EXPECT_EQ(2, dm.GetNumSyncs());
+  dm.ShutDown();
+
+  // Scenario: the pages survive reopening the file, and a plain reader sees what went through the mapping.
+  PosixDiskManager posix_dm("test.db");
+  std::memset(buf, 0, sizeof(buf));
+  posix_dm.ReadPage(2, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  posix_dm.ShutDown();
+
+  MmapDiskManager dm2("test.db", AccessPattern::SEQUENTIAL);
+  EXPECT_EQ(6, dm2.GetNumMappedPages());
+  std::memset(buf, 0, sizeof(buf));
+  dm2.ReadPage(2, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  dm2.SetAccessPattern(AccessPattern::RANDOM);
+  dm2.ReadPage(5, buf);
+  EXPECT_EQ(0, std::strcmp(buf, "A test string."));
+  dm2.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(MmapDiskManagerTest, ConcurrentReadWriteTest) {
+  MmapDiskManager dm("test.db");
+  const int num_threads = 8;
+  const int pages_per_thread = 64;
+
+  // Scenario: threads extend the file while others read, so the mapping is replaced under concurrent readers.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&dm, t] {
+      char data[BUSTUB_PAGE_SIZE];
+      char buf[BUSTUB_PAGE_SIZE];
+      for (int i = 0; i < pages_per_thread; i++) {
+        const page_id_t page_id = i * num_threads + t;
+        std::memset(data, page_id % 128, sizeof(data));
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+
+  char buf[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_threads * pages_per_thread; page_id++) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(page_id % 128, buf[0]);
+    EXPECT_EQ(page_id % 128, buf[BUSTUB_PAGE_SIZE - 1]);
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumMappedPages());
+
+  dm.ShutDown();
+}
+
+}  // namespace bustub
@@ -0,0 +1,352 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posix_disk_manager_test.cpp
+//
+// Identification: test/storage/posix_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sys/resource.h>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/posix_disk_manager.h"
+
+namespace bustub {
+
+class PosixDiskManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+    remove("test.db.1");
+    remove("test.db.2");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+    remove("test.db.1");
+    remove("test.db.2");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(PosixDiskManagerTest, ReadWritePageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  PosixDiskManager dm("test.db");
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(0, buf);  // reading past the end of the file returns zeros
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[BUSTUB_PAGE_SIZE - 1]);
+
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  std::memset(buf, 0, sizeof(buf));
+  dm.WritePage(5, data);
+  dm.ReadPage(5, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_EQ(2, dm.GetNumWrites());
+
+  dm.ShutDown();
+
+  // Scenario: the pages survive reopening the file.
+  PosixDiskManager dm2("test.db");
+  std::memset(buf, 0, sizeof(buf));
+  dm2.ReadPage(5, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  dm2.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PosixDiskManagerTest, SyncTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  PosixDiskManager dm("test.db");
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    dm.WritePage(page_id, data);
+  }
+  EXPECT_EQ(0, dm.GetNumSyncs());
+  dm.SyncRange(2, 4);
+  dm.Sync();
+  EXPECT_EQ(2, dm.GetNumSyncs());
+  EXPECT_EQ(8, dm.GetNumWrites());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PosixDiskManagerTest, DirectIoTest) {
+  alignas(BUSTUB_PAGE_SIZE) char aligned[BUSTUB_PAGE_SIZE] = {0};
+  char unaligned_storage[BUSTUB_PAGE_SIZE + 1] = {0};
+  char *unaligned = unaligned_storage + 1;
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  PosixDiskManager dm("test.db", true);
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  std::memset(aligned, 1, sizeof(aligned));
+  dm.ReadPage(3, aligned);  // reading past the end of the file returns zeros
+  EXPECT_EQ(0, aligned[0]);
+  EXPECT_EQ(0, aligned[BUSTUB_PAGE_SIZE - 1]);
+
+  // Scenario: aligned buffers go to the kernel as they are, unaligned ones through the bounce buffer.
+  std::memcpy(aligned, data, sizeof(data));
+  dm.WritePage(0, aligned);
+  dm.WritePage(1, data);
+  std::memset(unaligned, 0, BUSTUB_PAGE_SIZE);
+  dm.ReadPage(0, unaligned);
+  EXPECT_EQ(std::memcmp(unaligned, data, sizeof(data)), 0);
+  std::memset(aligned, 0, sizeof(aligned));
+  dm.ReadPage(1, aligned);
+  EXPECT_EQ(std::memcmp(aligned, data, sizeof(data)), 0);
+  dm.Sync();
+  dm.ShutDown();
+
+  // Scenario: buffered I/O sees what direct I/O wrote.
+  PosixDiskManager dm2("test.db");
+  EXPECT_FALSE(dm2.UsesDirectIo());
+  dm2.ReadPage(1, unaligned);
+  EXPECT_EQ(std::memcmp(unaligned, data, sizeof(data)), 0);
+  dm2.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PosixDiskManagerTest, TablespaceTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  auto file_size = [](const std::string &file_name) {
+    return std::ifstream(file_name, std::ios::binary | std::ios::ate).tellg();
+  };
+  auto dm = std::make_unique<PosixDiskManager>("test.db");
+
+  const tablespace_id_t first = dm->CreateTablespace();
+  const tablespace_id_t second = dm->CreateTablespace();
+  EXPECT_EQ(1, first);
+  EXPECT_EQ(2, second);
+  EXPECT_EQ(0, dm->GetNumBlocks(first));
+
+  // Scenario: the same block number in different tablespaces is a different page in a different file.
+  for (page_id_t block = 0; block < 4; block++) {
+    std::memset(data, 'a' + block, sizeof(data));
+    dm->WritePage(MakePageId(first, block), data);
+    std::memset(data, 'A' + block, sizeof(data));
+    dm->WritePage(MakePageId(second, block), data);
+  }
+  dm->WritePage(0, data);
+  dm->Sync();
+  EXPECT_EQ(4, dm->GetNumBlocks(first));
+  EXPECT_EQ(4 * BUSTUB_PAGE_SIZE, file_size("test.db.1"));
+  EXPECT_EQ(BUSTUB_PAGE_SIZE, file_size("test.db"));
+  dm->ReadPage(MakePageId(first, 2), buf);
+  EXPECT_EQ('c', buf[0]);
+  dm->ReadPage(MakePageId(second, 2), buf);
+  EXPECT_EQ('C', buf[BUSTUB_PAGE_SIZE - 1]);
+  dm->ShutDown();
+
+  // Scenario: tablespace files are found again after a restart, and dropping one deletes its file.
+  dm = std::make_unique<PosixDiskManager>("test.db");
+  dm->ReadPage(MakePageId(second, 3), buf);
+  EXPECT_EQ('D', buf[0]);
+  dm->DropTablespace(first);
+  EXPECT_EQ(-1, file_size("test.db.1"));
+  std::memset(buf, 1, sizeof(buf));
+  dm->ReadPage(MakePageId(first, 2), buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(first, dm->CreateTablespace());
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PosixDiskManagerTest, PreallocateTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  auto file_size = [](const std::string &file_name) {
+    return std::ifstream(file_name, std::ios::binary | std::ios::ate).tellg();
+  };
+  PosixDiskManager dm("test.db");
+
+  // Scenario: preallocated pages extend the file and read as zeros until they are written.
+  dm.PreallocatePages(0, 16);
+  EXPECT_EQ(16 * BUSTUB_PAGE_SIZE, file_size("test.db"));
+  const tablespace_id_t tablespace_id = dm.CreateTablespace();
+  dm.PreallocatePages(MakePageId(tablespace_id, 8), 8);
+  EXPECT_EQ(16, dm.GetNumBlocks(tablespace_id));
+  for (page_id_t page_id = 0; page_id < 12; page_id++) {
+    std::memset(data, 'a' + page_id, sizeof(data));
+    dm.WritePage(page_id, data);
+  }
+  EXPECT_EQ(16 * BUSTUB_PAGE_SIZE, file_size("test.db"));
+
+  // Scenario: a batch read with runs of adjacent pages, gaps, unsorted ids and pages past the end of the file.
+  const std::vector<page_id_t> page_ids = {7, 3, 4, 5, 6, 0, 10, 11, 14, 20, MakePageId(tablespace_id, 9)};
+  std::vector<std::vector<char>> buffers(page_ids.size(), std::vector<char>(BUSTUB_PAGE_SIZE, 1));
+  std::vector<std::pair<page_id_t, char *>> pages;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    pages.emplace_back(page_ids[i], buffers[i].data());
+  }
+  dm.ReadPages(pages);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    const char expected = page_ids[i] < 12 ? static_cast<char>('a' + page_ids[i]) : 0;
+    EXPECT_EQ(expected, buffers[i][0]) << "page " << page_ids[i];
+    EXPECT_EQ(expected, buffers[i][BUSTUB_PAGE_SIZE - 1]) << "page " << page_ids[i];
+  }
+
+  dm.DropTablespace(tablespace_id);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PosixDiskManagerTest, VectoredWriteTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  PosixDiskManager dm("test.db");
+  const tablespace_id_t tablespace_id = dm.CreateTablespace();
+
+  // Scenario: a batch with runs of adjacent pages, gaps, unsorted ids and a page of another tablespace.
+  const std::vector<page_id_t> page_ids = {7, 3, 4, 5, 6, 0, 10, 11, MakePageId(tablespace_id, 8)};
+  std::vector<std::vector<char>> buffers;
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (auto page_id : page_ids) {
+    buffers.emplace_back(BUSTUB_PAGE_SIZE, static_cast<char>('a' + BlockOf(page_id)));
+  }
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    pages.emplace_back(page_ids[i], buffers[i].data());
+  }
+  dm.WritePages(pages);
+  EXPECT_EQ(static_cast<int>(page_ids.size()), dm.GetNumWrites());
+  for (auto page_id : page_ids) {
+    std::memset(buf, 0, sizeof(buf));
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ('a' + BlockOf(page_id), buf[0]) << "page " << page_id;
+    EXPECT_EQ('a' + BlockOf(page_id), buf[BUSTUB_PAGE_SIZE - 1]) << "page " << page_id;
+  }
+  dm.ReadPage(1, buf);
+  EXPECT_EQ(0, buf[0]);
+
+  dm.DropTablespace(tablespace_id);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PosixDiskManagerTest, PageSizeTest) {
+  const size_t page_size = 16384;
+  std::vector<char> data(page_size, 'x');
+  std::vector<char> buf(page_size);
+  EXPECT_THROW(PosixDiskManager("test.db", false, 12288), Exception);
+  EXPECT_THROW(PosixDiskManager("test.db", false, 2 * BUSTUB_MAX_PAGE_SIZE), Exception);
+
+  {
+    PosixDiskManager dm("test.db", false, page_size);
+    EXPECT_EQ(page_size, dm.GetPageSize());
+    dm.WritePage(3, data.data());
+    dm.ShutDown();
+  }
+  EXPECT_EQ(4 * page_size, std::ifstream("test.db", std::ios::binary | std::ios::ate).tellg());
+
+  // Scenario: the page size comes from the header page, not from the argument.
+  PosixDiskManager dm("test.db");
+  EXPECT_EQ(page_size, dm.GetPageSize());
+  dm.ReadPage(3, buf.data());
+  EXPECT_EQ(data, buf);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PosixDiskManagerTest, LargeOffsetTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  PosixDiskManager dm("test.db");
+  std::strncpy(data, "Past the 2 GB mark.", sizeof(data));
+
+  // The page starts beyond INT32_MAX bytes; the file is sparse, so this does not use 2 GB of disk.
+  const page_id_t page_id = (1 << 19) + 7;
+  dm.WritePage(page_id, data);
+  dm.ReadPage(page_id, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, buf[0]);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PosixDiskManagerTest, ConcurrentReadWriteTest) {
+  PosixDiskManager dm("test.db");
+  const int num_threads = 8;
+  const int pages_per_thread = 64;
+
+  // Scenario: threads write and read back disjoint pages at the same time.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&dm, t] {
+      char data[BUSTUB_PAGE_SIZE];
+      char buf[BUSTUB_PAGE_SIZE];
+      for (int i = 0; i < pages_per_thread; i++) {
+        const page_id_t page_id = i * num_threads + t;
+        std::memset(data, page_id % 128, sizeof(data));
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+
+  char buf[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_threads * pages_per_thread; page_id++) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ(page_id % 128, buf[0]);
+    EXPECT_EQ(page_id % 128, buf[BUSTUB_PAGE_SIZE - 1]);
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(PosixDiskManagerTest, WriteErrorTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  PosixDiskManager dm("test.db");
+  dm.WritePage(0, data);
+
+  // Writes past the file size limit fail with EFBIG instead of raising SIGXFSZ.
+  auto *old_handler = signal(SIGXFSZ, SIG_IGN);
+  rlimit old_limit{};
+  getrlimit(RLIMIT_FSIZE, &old_limit);
+  rlimit limit = old_limit;
+  limit.rlim_cur = 4 * BUSTUB_PAGE_SIZE;
+  ASSERT_EQ(0, setrlimit(RLIMIT_FSIZE, &limit));
+  EXPECT_THROW(dm.WritePage(8, data), Exception);
+  EXPECT_THROW(dm.WritePages({{8, data}, {9, data}}), Exception);
+  dm.WritePage(1, data);
+  setrlimit(RLIMIT_FSIZE, &old_limit);
+  signal(SIGXFSZ, old_handler);
+
+  dm.WritePages({{8, data}, {9, data}});
+  dm.ShutDown();
+}
+
+}  // namespace bustub
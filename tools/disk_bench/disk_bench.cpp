@@ -0,0 +1,147 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/latency_disk_manager.h"
+#include "storage/disk/mmap_disk_manager.h"
+
+/** Asks the OS to drop the cached pages of the file, so that the next scan reads from the device. Best effort. */
+void DropFileCache(const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  fdatasync(fd);
+#ifdef POSIX_FADV_DONTNEED
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+  close(fd);
+}
+
+/**
+ * Reads every page of the table once, sequentially or in a random order, and returns the cost per page in ns.
+ * A byte of every page is summed up so that the reads cannot be optimized away.
+ */
+auto Scan(bustub::DiskManager *disk_manager, const std::vector<bustub::page_id_t> &order, uint64_t *checksum)
+    -> double {
+  char buf[bustub::BUSTUB_PAGE_SIZE];
+  auto start = std::chrono::steady_clock::now();
+  for (auto page_id : order) {
+    disk_manager->ReadPage(page_id, buf);
+    *checksum += static_cast<unsigned char>(buf[page_id % bustub::BUSTUB_PAGE_SIZE]);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(order.size());
+}
+
+/**
+ * Benchmark for the read path of the disk managers: a cold and a warm scan of a large table through the fstream
+ * DiskManager, the MmapDiskManager and the in-memory DiskManagerMemory. Before a cold scan the OS page cache of the
+ * table is dropped (where the OS allows it) and the disk manager is opened afresh; the warm scan follows right after.
+ * DiskManagerMemory has no cold state, so both of its numbers show the cost of the copy alone. With --latency, a
+ * LatencyDiskManager over DiskManagerMemory shows what the scan would cost on an SSD or a hard disk.
+ */
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-disk-bench");
+  program.add_argument("--pages").help("size of the table in pages").default_value(std::string("65536"));
+  program.add_argument("--file").help("database file to create").default_value(std::string("disk_bench.db"));
+  program.add_argument("--random").help("read the pages in a random order").default_value(false).implicit_value(true);
+  program.add_argument("--latency").help("also scan a simulated device: ssd or hdd").default_value(std::string(""));
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  const auto num_pages = std::stoul(program.get("--pages"));
+  const auto file_name = program.get("--file");
+  const bool random = program.get<bool>("--random");
+  const auto latency = program.get("--latency");
+  if (!latency.empty() && latency != "ssd" && latency != "hdd") {
+    std::cerr << "unknown --latency profile " << latency << std::endl;
+    return 1;
+  }
+
+  std::vector<bustub::page_id_t> order(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    order[i] = static_cast<bustub::page_id_t>(i);
+  }
+  if (random) {
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(num_pages));
+  }
+
+  // Create the table.
+  remove(file_name.c_str());
+  {
+    char data[bustub::BUSTUB_PAGE_SIZE];
+    bustub::DiskManager disk_manager(file_name);
+    for (size_t i = 0; i < num_pages; i++) {
+      std::memset(data, static_cast<int>(i % 128), sizeof(data));
+      disk_manager.WritePage(static_cast<bustub::page_id_t>(i), data);
+    }
+    disk_manager.Sync();
+    disk_manager.ShutDown();
+  }
+  auto memory_manager = std::make_unique<bustub::DiskManagerMemory>(num_pages);
+  {
+    bustub::MmapDiskManager disk_manager(file_name);
+    char data[bustub::BUSTUB_PAGE_SIZE];
+    for (size_t i = 0; i < num_pages; i++) {
+      disk_manager.ReadPage(static_cast<bustub::page_id_t>(i), data);
+      memory_manager->WritePage(static_cast<bustub::page_id_t>(i), data);
+    }
+    disk_manager.ShutDown();
+  }
+
+  const auto access_pattern = random ? bustub::AccessPattern::RANDOM : bustub::AccessPattern::SEQUENTIAL;
+  std::vector<std::pair<std::string, std::function<std::unique_ptr<bustub::DiskManager>()>>> managers = {
+      {"fstream", [&] { return std::make_unique<bustub::DiskManager>(file_name); }},
+      {"mmap", [&] { return std::make_unique<bustub::MmapDiskManager>(file_name, access_pattern); }},
+  };
+
+  fmt::print("{} pages ({} MB), {} scan\n", num_pages, num_pages * bustub::BUSTUB_PAGE_SIZE >> 20,
+             random ? "random" : "sequential");
+  fmt::print("{:>8} {:>14} {:>14} {:>12}\n", "manager", "cold ns/page", "warm ns/page", "warm MB/s");
+  uint64_t checksum = 0;
+  for (const auto &[name, make_manager] : managers) {
+    DropFileCache(file_name);
+    auto disk_manager = make_manager();
+    auto cold = Scan(disk_manager.get(), order, &checksum);
+    auto warm = Scan(disk_manager.get(), order, &checksum);
+    fmt::print("{:>8} {:>14.1f} {:>14.1f} {:>12.0f}\n", name, cold, warm, bustub::BUSTUB_PAGE_SIZE * 1e3 / warm);
+    disk_manager->ShutDown();
+  }
+  auto cold = Scan(memory_manager.get(), order, &checksum);
+  auto warm = Scan(memory_manager.get(), order, &checksum);
+  fmt::print("{:>8} {:>14.1f} {:>14.1f} {:>12.0f}\n", "memory", cold, warm, bustub::BUSTUB_PAGE_SIZE * 1e3 / warm);
+  if (!latency.empty()) {
+    bustub::LatencyDiskManager disk_manager(memory_manager.get(), latency == "ssd" ? bustub::LatencyProfile::Ssd()
+                                                                                      : bustub::LatencyProfile::Hdd());
+    auto cost = Scan(&disk_manager, order, &checksum);
+    fmt::print("{:>8} {:>14.1f} {:>14} {:>12.0f}\n", latency, cost, "-", bustub::BUSTUB_PAGE_SIZE * 1e3 / cost);
+  }
+  fmt::print("checksum {}\n", checksum);
+
+  remove(file_name.c_str());
+  remove((file_name.substr(0, file_name.find_last_of('.')) + ".log").c_str());
+  remove((file_name.substr(0, file_name.find_last_of('.')) + ".fsm").c_str());
+  return 0;
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "catalog/schema.h"
+#include "fmt/core.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/latency_disk_manager.h"
+#include "type/value_factory.h"
+
+/**
+ * Benchmark for the append path of the log manager: 1, 2, 4, ... threads append insert records of a given tuple size
+ * as fast as they can while the flush thread writes the log out, and the throughput is printed for every thread
+ * count. With --commit-every=N, every thread waits for the log to be durable after each N records, like a
+ * transaction that commits. The log goes to a DiskManagerMemory, which keeps no log, so that only the log manager is
+ * measured; with --latency, every log write takes as long as a sync on an SSD or a hard disk.
+ */
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-log-bench");
+  program.add_argument("--threads").help("largest number of appending threads").default_value(std::string("16"));
+  program.add_argument("--records").help("records every thread appends").default_value(std::string("200000"));
+  program.add_argument("--tuple-size").help("size of the logged tuples in bytes").default_value(std::string("100"));
+  program.add_argument("--commit-every").help("wait for the log after this many records, 0 never").default_value(
+      std::string("0"));
+  program.add_argument("--latency").help("simulate the log device: ssd or hdd").default_value(std::string(""));
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  const auto max_threads = std::stoul(program.get("--threads"));
+  const auto num_records = std::stoul(program.get("--records"));
+  const auto tuple_size = std::stoul(program.get("--tuple-size"));
+  const auto commit_every = std::stoul(program.get("--commit-every"));
+  const auto latency = program.get("--latency");
+  if (!latency.empty() && latency != "ssd" && latency != "hdd") {
+    std::cerr << "unknown --latency profile " << latency << std::endl;
+    return 1;
+  }
+
+  bustub::Schema schema({bustub::Column("payload", bustub::TypeId::VARCHAR, static_cast<uint32_t>(tuple_size))});
+  const bustub::Tuple tuple({bustub::ValueFactory::GetVarcharValue(std::string(tuple_size, 'x'))}, &schema);
+
+  fmt::print("{:>8} {:>14} {:>10} {:>10} {:>12}\n", "threads", "records/s", "MB/s", "writes", "records/write");
+  for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    bustub::DiskManagerMemory memory(1);
+    std::unique_ptr<bustub::DiskManager> latency_manager;
+    bustub::DiskManager *disk_manager = &memory;
+    if (!latency.empty()) {
+      latency_manager = std::make_unique<bustub::LatencyDiskManager>(
+          &memory, latency == "ssd" ? bustub::LatencyProfile::Ssd() : bustub::LatencyProfile::Hdd());
+      disk_manager = latency_manager.get();
+    }
+    bustub::LogManager log_manager(disk_manager);
+    log_manager.RunFlushThread();
+
+    size_t record_size = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        const auto txn_id = static_cast<bustub::txn_id_t>(t);
+        bustub::lsn_t prev_lsn = bustub::INVALID_LSN;
+        for (size_t i = 0; i < num_records; i++) {
+          bustub::LogRecord record(txn_id, prev_lsn, bustub::LogRecordType::INSERT,
+                                   bustub::RID(static_cast<bustub::page_id_t>(t), static_cast<uint32_t>(i)), tuple);
+          prev_lsn = log_manager.AppendLogRecord(&record);
+          if (commit_every != 0 && (i + 1) % commit_every == 0) {
+            log_manager.Flush(prev_lsn);
+          }
+          if (t == 0 && i == 0) {
+            record_size = record.GetSize();
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    log_manager.Flush(log_manager.GetNextLSN() - 1);
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    log_manager.StopFlushThread();
+
+    const auto total_records = static_cast<double>(num_threads * num_records);
+    const auto writes = disk_manager->GetNumFlushes();
+    fmt::print("{:>8} {:>14.0f} {:>10.1f} {:>10} {:>12.1f}\n", num_threads, total_records / seconds,
+               total_records * static_cast<double>(record_size) / seconds / (1 << 20), writes,
+               total_records / std::max(writes, 1));
+    disk_manager->ShutDown();
+  }
+  return 0;
+}
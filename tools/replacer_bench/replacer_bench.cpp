@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/replacer.h"
+#include "fmt/core.h"
+
+/** Replacement policies by their command line name. */
+static const std::vector<std::pair<std::string, bustub::ReplacerType>> POLICIES = {
+    {"lru-k", bustub::ReplacerType::LRU_K}, {"lru", bustub::ReplacerType::LRU},
+    {"clock", bustub::ReplacerType::CLOCK}, {"2q", bustub::ReplacerType::TWO_Q},
+    {"arc", bustub::ReplacerType::ARC},
+};
+
+/**
+ * Microbenchmark for a replacer. For every pool size, all frames are filled and made evictable, then the benchmark
+ * alternates between the two things a buffer pool does with its replacer:
+ *
+ * - a hit: pin a random frame (record access, set non-evictable) and unpin it again;
+ * - a miss: evict a victim, record the access of the new page and unpin it.
+ *
+ * The reported cost per operation should stay flat as the number of frames grows.
+ */
+auto RunReplacerBench(bustub::ReplacerType policy, size_t num_frames, size_t k, size_t num_ops, double miss_ratio)
+    -> double {
+  auto replacer = bustub::MakeReplacer(policy, num_frames, k);
+  std::mt19937_64 gen(num_frames);
+  std::uniform_int_distribution<bustub::frame_id_t> frame_dist(0, static_cast<bustub::frame_id_t>(num_frames) - 1);
+  std::bernoulli_distribution miss_dist(miss_ratio);
+
+  // Warm up: give every frame a mix of short and full access histories.
+  for (size_t i = 0; i < num_frames; i++) {
+    auto frame_id = static_cast<bustub::frame_id_t>(i);
+    for (size_t j = 0; j <= i % (k + 1); j++) {
+      replacer->RecordAccess(frame_id);
+    }
+    replacer->SetEvictable(frame_id, true);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_ops; i++) {
+    bustub::frame_id_t frame_id;
+    if (miss_dist(gen)) {
+      if (!replacer->Evict(&frame_id)) {
+        std::cerr << "replacer unexpectedly empty" << std::endl;
+        exit(1);
+      }
+    } else {
+      frame_id = frame_dist(gen);
+    }
+    replacer->RecordAccess(frame_id);
+    replacer->SetEvictable(frame_id, false);
+    replacer->SetEvictable(frame_id, true);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(num_ops);
+}
+
+/** Reads a page access trace: whitespace separated page ids, in access order. */
+auto ReadTrace(const std::string &file_name) -> std::vector<bustub::page_id_t> {
+  std::ifstream in(file_name);
+  if (!in) {
+    std::cerr << "cannot open trace " << file_name << std::endl;
+    exit(1);
+  }
+  std::vector<bustub::page_id_t> trace;
+  bustub::page_id_t page_id;
+  while (in >> page_id) {
+    trace.push_back(page_id);
+  }
+  return trace;
+}
+
+/**
+ * Generates a mixed OLTP and scan trace: uniform accesses to a hot set of half the pool, interrupted every 10 pool
+ * sizes worth of accesses by a sequential scan over a table four times the size of the pool.
+ */
+auto MakeSyntheticTrace(size_t num_frames, size_t length) -> std::vector<bustub::page_id_t> {
+  const auto hot_pages = static_cast<bustub::page_id_t>(std::max<size_t>(1, num_frames / 2));
+  const auto scan_pages = static_cast<bustub::page_id_t>(num_frames * 4);
+  const bustub::page_id_t scan_start = hot_pages;
+  std::mt19937_64 gen(length);
+  std::uniform_int_distribution<bustub::page_id_t> hot_dist(0, hot_pages - 1);
+
+  std::vector<bustub::page_id_t> trace;
+  trace.reserve(length);
+  while (trace.size() < length) {
+    for (size_t i = 0; i < num_frames * 10 && trace.size() < length; i++) {
+      trace.push_back(hot_dist(gen));
+    }
+    for (bustub::page_id_t page_id = scan_start; page_id < scan_start + scan_pages && trace.size() < length; page_id++) {
+      trace.push_back(page_id);
+    }
+  }
+  return trace;
+}
+
+/**
+ * Replays a page access trace through a simulated buffer pool of num_frames frames, driving the replacer exactly as
+ * BufferPoolManagerInstance does: a hit pins and unpins the frame, a miss takes a free frame or evicts one, records
+ * the load of the page and unpins it.
+ * @return the hit ratio and the cost per access in ns
+ */
+auto ReplayTrace(bustub::ReplacerType policy, size_t num_frames, size_t k,
+                 const std::vector<bustub::page_id_t> &trace) -> std::pair<double, double> {
+  auto replacer = bustub::MakeReplacer(policy, num_frames, k);
+  std::unordered_map<bustub::page_id_t, bustub::frame_id_t> page_table;
+  std::vector<bustub::page_id_t> frame_pages(num_frames, bustub::INVALID_PAGE_ID);
+  size_t num_used_frames = 0;
+  size_t hits = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto page_id : trace) {
+    bustub::frame_id_t frame_id;
+    auto it = page_table.find(page_id);
+    if (it != page_table.end()) {
+      hits++;
+      frame_id = it->second;
+      replacer->SetEvictable(frame_id, false);
+      replacer->RecordAccess(frame_id);
+    } else {
+      if (num_used_frames < num_frames) {
+        frame_id = static_cast<bustub::frame_id_t>(num_used_frames++);
+      } else {
+        if (!replacer->Evict(&frame_id)) {
+          std::cerr << "replacer unexpectedly empty" << std::endl;
+          exit(1);
+        }
+        page_table.erase(frame_pages[frame_id]);
+      }
+      frame_pages[frame_id] = page_id;
+      page_table[page_id] = frame_id;
+      replacer->RecordLoad(frame_id, page_id);
+    }
+    replacer->SetEvictable(frame_id, true);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return {static_cast<double>(hits) / static_cast<double>(trace.size()),
+          std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(trace.size())};
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-replacer-bench");
+  program.add_argument("--policy")
+      .help("replacement policy for the scaling benchmark: lru-k, lru, clock, 2q or arc")
+      .default_value(std::string("lru-k"));
+  program.add_argument("--k").help("lookback constant of the LRU-K replacer").default_value(std::string("10"));
+  program.add_argument("--ops").help("operations per pool size").default_value(std::string("1000000"));
+  program.add_argument("--miss-ratio").help("fraction of operations that evict").default_value(std::string("0.5"));
+  program.add_argument("--max-frames").help("largest pool size to test").default_value(std::string("1048576"));
+  program.add_argument("--trace")
+      .help("replay a page access trace (whitespace separated page ids) through every policy")
+      .default_value(std::string(""));
+  program.add_argument("--synthetic-trace")
+      .help("replay a generated OLTP and scan trace of this many accesses through every policy")
+      .default_value(std::string("0"));
+  program.add_argument("--frames").help("pool size for trace replay").default_value(std::string("1024"));
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  auto k = std::stoul(program.get("--k"));
+  auto trace_file = program.get("--trace");
+  auto synthetic_length = std::stoul(program.get("--synthetic-trace"));
+
+  if (!trace_file.empty() || synthetic_length > 0) {
+    auto num_frames = std::stoul(program.get("--frames"));
+    auto trace = trace_file.empty() ? MakeSyntheticTrace(num_frames, synthetic_length) : ReadTrace(trace_file);
+    if (trace.empty()) {
+      std::cerr << "empty trace" << std::endl;
+      return 1;
+    }
+    fmt::print("{} accesses, {} frames\n", trace.size(), num_frames);
+    fmt::print("{:>8} {:>12} {:>12}\n", "policy", "hit ratio", "ns/op");
+    for (const auto &[name, policy] : POLICIES) {
+      auto [hit_ratio, ns_per_op] = ReplayTrace(policy, num_frames, k, trace);
+      fmt::print("{:>8} {:>12.4f} {:>12.1f}\n", name, hit_ratio, ns_per_op);
+    }
+    return 0;
+  }
+
+  auto policy_name = program.get("--policy");
+  auto policy = POLICIES.end();
+  for (auto it = POLICIES.begin(); it != POLICIES.end(); it++) {
+    if (it->first == policy_name) {
+      policy = it;
+    }
+  }
+  if (policy == POLICIES.end()) {
+    std::cerr << "unknown policy " << policy_name << std::endl;
+    return 1;
+  }
+  auto num_ops = std::stoul(program.get("--ops"));
+  auto miss_ratio = std::stod(program.get("--miss-ratio"));
+  auto max_frames = std::stoul(program.get("--max-frames"));
+
+  fmt::print("{:>12} {:>12}\n", "num_frames", "ns/op");
+  for (size_t num_frames = 1024; num_frames <= max_frames; num_frames *= 4) {
+    fmt::print("{:>12} {:>12.1f}\n", num_frames, RunReplacerBench(policy->second, num_frames, k, num_ops, miss_ratio));
+  }
+  return 0;
+}
@@ -27,14 +27,18 @@ auto GetWidthOfUtf8(const void *beg, const void *end, size_t *width) -> int {
 auto main(int argc, char **argv) -> int {
   ft_set_u8strwid_func(&GetWidthOfUtf8);
 
-  auto bustub = std::make_unique<bustub::BustubInstance>("test.db");
-
   auto default_prompt = "bustub> ";
   auto emoji_prompt = "\U0001f6c1> ";  // the bathtub emoji
   bool use_emoji_prompt = false;
   bool disable_tty = false;
+  size_t page_size = bustub::BUSTUB_PAGE_SIZE;
 
   for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--page-size=", 12) == 0) {
+      // only used when test.db is created; an existing database keeps its page size
+      page_size = std::stoul(argv[i] + 12);
+      continue;
+    }
     if (strcmp(argv[i], "--emoji-prompt") == 0) {
       use_emoji_prompt = true;
       break;
@@ -45,6 +49,8 @@ auto main(int argc, char **argv) -> int {
     }
   }
 
+  auto bustub = std::make_unique<bustub::BustubInstance>("test.db", bustub::ReplacerType::LRU_K, page_size);
+
   bustub->GenerateMockTable();
 
   if (bustub->buffer_pool_manager_ != nullptr) {